@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "TungstenCore/Application.hpp"
+
+// Every allocation in the process goes through these, so each benchmark can report allocations and bytes per operation.
+namespace
+{
+    std::atomic<uint64_t> s_allocationCount = 0;
+    std::atomic<uint64_t> s_allocatedBytes = 0;
+
+    void* CountedAllocate(std::size_t size)
+    {
+        s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+        s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        if (void* memory = std::malloc(size ? size : 1))
+        {
+            return memory;
+        }
+        throw std::bad_alloc();
+    }
+
+    void* CountedAllocate(std::size_t size, std::align_val_t alignment)
+    {
+        s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+        s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        const std::size_t alignmentValue = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+        if (void* memory = std::aligned_alloc(alignmentValue, (std::max<std::size_t>(size, 1) + alignmentValue - 1) / alignmentValue * alignmentValue))
+        {
+            return memory;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size) { return CountedAllocate(size); }
+void* operator new[](std::size_t size) { return CountedAllocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return CountedAllocate(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return CountedAllocate(size, alignment); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using namespace wCore;
+
+    constexpr uint32_t Seed = 0x5EEDu;
+    constexpr wIndex ComponentCount = 1 << 16;
+    constexpr wIndex IterationCount = 1 << 20;
+    constexpr wIndex LookupCount = 1 << 20;
+    constexpr wIndex ChurnCount = 1 << 18;
+    constexpr wIndex SceneCount = 4096;
+
+    struct Position
+    {
+        float x, y, z;
+    };
+
+    struct Velocity
+    {
+        float x, y, z;
+    };
+
+    template<wIndex PageSize>
+    struct PagedPosition
+    {
+        float x, y, z;
+    };
+
+    template<typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* s_sink;
+        s_sink = &value;
+#endif
+    }
+
+    class Runner
+    {
+    public:
+        Runner(std::string_view filter, wIndex repetitions) noexcept
+            : m_filter(filter), m_repetitions(repetitions) {}
+
+        // Runs body repetitions times between setup and teardown, reporting the fastest run and the allocations of the last one.
+        void Measure(std::string_view name, wIndex operationCount, const std::function<void()>& setup, const std::function<void()>& body, const std::function<void()>& teardown, wIndex repetitions = 0)
+        {
+            if (!m_filter.empty() && name.find(m_filter) == std::string_view::npos)
+            {
+                return;
+            }
+
+            Clock::duration best = Clock::duration::max();
+            uint64_t allocationCount = 0;
+            uint64_t allocatedBytes = 0;
+            for (wIndex repetition = 0; repetition < (repetitions ? repetitions : m_repetitions); ++repetition)
+            {
+                setup();
+                const uint64_t allocationCountBefore = s_allocationCount.load(std::memory_order_relaxed);
+                const uint64_t allocatedBytesBefore = s_allocatedBytes.load(std::memory_order_relaxed);
+                const Clock::time_point start = Clock::now();
+                body();
+                const Clock::duration duration = Clock::now() - start;
+                allocationCount = s_allocationCount.load(std::memory_order_relaxed) - allocationCountBefore;
+                allocatedBytes = s_allocatedBytes.load(std::memory_order_relaxed) - allocatedBytesBefore;
+                best = std::min(best, duration);
+                teardown();
+            }
+
+            const double nanoseconds = std::chrono::duration<double, std::nano>(best).count();
+            std::printf("%-44s %12.2f ns/op %12u ops %12.4f allocs/op %12.2f B/op\n", std::string(name).c_str(), nanoseconds / operationCount, static_cast<unsigned>(operationCount),
+                static_cast<double>(allocationCount) / operationCount, static_cast<double>(allocatedBytes) / operationCount);
+        }
+
+    private:
+        std::string_view m_filter;
+        wIndex m_repetitions;
+    };
+
+    void Nothing() {}
+
+    void BenchmarkScenes(Runner& runner, ComponentSystem& componentSystem)
+    {
+        std::vector<SceneHandle> scenes(SceneCount);
+
+        // Only the first run starts from an empty ComponentSystem, so this one is not repeated.
+        runner.Measure("CreateScene/Grow (ReallocateScenes)", SceneCount, Nothing, [&]
+        {
+            for (SceneHandle& scene : scenes)
+            {
+                scene = componentSystem.CreateScene();
+            }
+        }, [&]
+        {
+            for (const SceneHandle scene : scenes)
+            {
+                componentSystem.DestroyScene(scene);
+            }
+        }, 1);
+
+        runner.Measure("CreateScene/FreeList", SceneCount, Nothing, [&]
+        {
+            for (SceneHandle& scene : scenes)
+            {
+                scene = componentSystem.CreateScene();
+            }
+        }, [&]
+        {
+            for (const SceneHandle scene : scenes)
+            {
+                componentSystem.DestroyScene(scene);
+            }
+        });
+
+        runner.Measure("DestroyScene/Empty", SceneCount, [&]
+        {
+            for (SceneHandle& scene : scenes)
+            {
+                scene = componentSystem.CreateScene();
+            }
+        }, [&]
+        {
+            for (const SceneHandle scene : scenes)
+            {
+                componentSystem.DestroyScene(scene);
+            }
+        }, Nothing);
+    }
+
+    template<typename T>
+    void BenchmarkCreate(Runner& runner, ComponentSystem& componentSystem, std::string_view name)
+    {
+        SceneHandle scene;
+        std::vector<ComponentHandle<T>> handles(ComponentCount);
+        const auto setup = [&] { scene = componentSystem.CreateScene(); };
+        const auto teardown = [&] { componentSystem.DestroyScene(scene); };
+
+        runner.Measure(std::string("CreateComponent/") + std::string(name), ComponentCount, setup, [&]
+        {
+            for (ComponentHandle<T>& handle : handles)
+            {
+                handle = componentSystem.CreateComponent<T>(scene);
+            }
+        }, teardown);
+
+        runner.Measure(std::string("CreateComponents/") + std::string(name), ComponentCount, setup, [&]
+        {
+            componentSystem.CreateComponents<T>(scene, ComponentCount, handles.data());
+        }, teardown);
+
+        runner.Measure(std::string("DestroyComponents/") + std::string(name), ComponentCount, [&]
+        {
+            setup();
+            componentSystem.CreateComponents<T>(scene, ComponentCount, handles.data());
+        }, [&]
+        {
+            componentSystem.DestroyComponents<T>(std::span<const ComponentHandle<T>>(handles));
+        }, teardown);
+    }
+
+    void BenchmarkIteration(Runner& runner, ComponentSystem& componentSystem)
+    {
+        const SceneHandle scene = componentSystem.CreateScene();
+        componentSystem.CreateComponents<Position>(scene, IterationCount, nullptr);
+        componentSystem.CreateComponents<Velocity>(scene, IterationCount, nullptr);
+
+        runner.Measure("Each/Dense/Position", IterationCount, Nothing, [&]
+        {
+            float sum = 0.0f;
+            componentSystem.Each<Position>(scene, [&sum](const Position& position) { sum += position.x; });
+            DoNotOptimize(sum);
+        }, Nothing);
+
+        runner.Measure("Each/Dense/Position+Velocity", IterationCount, Nothing, [&]
+        {
+            componentSystem.Each<Position, Velocity>(scene, [](Position& position, const Velocity& velocity)
+            {
+                position.x += velocity.x;
+                position.y += velocity.y;
+                position.z += velocity.z;
+            });
+        }, Nothing);
+
+        runner.Measure("DenseSpan/Position", IterationCount, Nothing, [&]
+        {
+            float sum = 0.0f;
+            for (const Position& position : componentSystem.GetDenseSpan<Position>(scene))
+            {
+                sum += position.x;
+            }
+            DoNotOptimize(sum);
+        }, Nothing);
+
+        componentSystem.DestroyScene(scene);
+    }
+
+    // Looks up shuffled handles where every eighth one is stale, so both generation check outcomes are measured.
+    template<typename T>
+    void BenchmarkLookup(Runner& runner, ComponentSystem& componentSystem, std::string_view name)
+    {
+        const SceneHandle scene = componentSystem.CreateScene();
+        std::vector<ComponentHandle<T>> handles(ComponentCount);
+        componentSystem.CreateComponents<T>(scene, ComponentCount, handles.data());
+        for (wIndex handleIndex = 0; handleIndex < ComponentCount; handleIndex += 8)
+        {
+            componentSystem.DestroyComponent(handles[handleIndex]);
+        }
+        componentSystem.CreateComponents<T>(scene, ComponentCount / 8, nullptr);
+
+        std::mt19937 random(Seed);
+        std::vector<ComponentHandle<T>> lookups(LookupCount);
+        std::uniform_int_distribution<wIndex> distribution(0, ComponentCount - 1);
+        for (ComponentHandle<T>& lookup : lookups)
+        {
+            lookup = handles[distribution(random)];
+        }
+
+        runner.Measure(std::string("GetComponent/Random/") + std::string(name), LookupCount, Nothing, [&]
+        {
+            wIndex found = 0;
+            float sum = 0.0f;
+            for (const ComponentHandle<T>& lookup : lookups)
+            {
+                if (T* component = componentSystem.GetComponent(lookup))
+                {
+                    sum += component->x;
+                    ++found;
+                }
+            }
+            DoNotOptimize(sum);
+            DoNotOptimize(found);
+        }, Nothing);
+
+        componentSystem.DestroyScene(scene);
+    }
+
+    // Destroys a random live component and creates a new one, cycling slots through the free list.
+    template<typename T>
+    void BenchmarkChurn(Runner& runner, ComponentSystem& componentSystem, std::string_view name)
+    {
+        SceneHandle scene;
+        std::vector<ComponentHandle<T>> handles(ComponentCount);
+        std::vector<wIndex> victims(ChurnCount);
+        std::mt19937 random(Seed);
+        std::uniform_int_distribution<wIndex> distribution(0, ComponentCount - 1);
+        for (wIndex& victim : victims)
+        {
+            victim = distribution(random);
+        }
+
+        runner.Measure(std::string("FreeList/Churn/") + std::string(name), ChurnCount, [&]
+        {
+            scene = componentSystem.CreateScene();
+            componentSystem.CreateComponents<T>(scene, ComponentCount, handles.data());
+        }, [&]
+        {
+            for (const wIndex victim : victims)
+            {
+                componentSystem.DestroyComponent(handles[victim]);
+                handles[victim] = componentSystem.CreateComponent<T>(scene);
+            }
+        }, [&] { componentSystem.DestroyScene(scene); });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::string_view filter = argc > 1 ? argv[1] : "";
+    const wIndex repetitions = argc > 2 ? std::max(1ul, std::strtoul(argv[2], nullptr, 10)) : 5;
+
+    Application::Config config;
+    config.jobSystem.workerCount = 0;
+    Application app(config);
+    ComponentSystem& componentSystem = app.GetComponentSystem();
+    ComponentSetup& componentSetup = componentSystem.GetComponentSetup();
+    componentSetup.Add<Position>("Position");
+    componentSetup.Add<Velocity>("Velocity");
+    componentSetup.Add<PagedPosition<16>, 16>("PagedPosition<16>");
+    componentSetup.Add<PagedPosition<64>, 64>("PagedPosition<64>");
+    componentSetup.Add<PagedPosition<256>, 256>("PagedPosition<256>");
+    componentSetup.Add<PagedPosition<1024>, 1024>("PagedPosition<1024>");
+    componentSetup.Add<PagedPosition<4096>, 4096>("PagedPosition<4096>");
+
+    Runner runner(filter, repetitions);
+    std::printf("TungstenCore benchmarks, %u repetitions, seed 0x%X\n", static_cast<unsigned>(repetitions), Seed);
+
+    BenchmarkScenes(runner, componentSystem);
+
+    BenchmarkCreate<Position>(runner, componentSystem, "Dense");
+    BenchmarkCreate<PagedPosition<16>>(runner, componentSystem, "Paged/16");
+    BenchmarkCreate<PagedPosition<64>>(runner, componentSystem, "Paged/64");
+    BenchmarkCreate<PagedPosition<256>>(runner, componentSystem, "Paged/256");
+    BenchmarkCreate<PagedPosition<1024>>(runner, componentSystem, "Paged/1024");
+    BenchmarkCreate<PagedPosition<4096>>(runner, componentSystem, "Paged/4096");
+
+    BenchmarkIteration(runner, componentSystem);
+
+    BenchmarkLookup<Position>(runner, componentSystem, "Dense");
+    BenchmarkLookup<PagedPosition<256>>(runner, componentSystem, "Paged/256");
+
+    BenchmarkChurn<Position>(runner, componentSystem, "Dense");
+    BenchmarkChurn<PagedPosition<256>>(runner, componentSystem, "Paged/256");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "TungstenCore/JobSystem.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr wIndex JobCount = 1 << 20;
+    constexpr wIndex BatchSize = 1024;
+
+    double NanosecondsPer(Clock::duration duration, wIndex count)
+    {
+        return std::chrono::duration<double, std::nano>(duration).count() / count;
+    }
+
+    // Spawns and waits in batches so the owner queue is the main source of work, workers only steal.
+    double BenchmarkSpawnWait(wCore::JobSystem& jobSystem)
+    {
+        std::atomic<wIndex> executed = 0;
+        const Clock::time_point start = Clock::now();
+        for (wIndex batch = 0; batch < JobCount / BatchSize; ++batch)
+        {
+            wCore::JobCounter counter;
+            for (wIndex job = 0; job < BatchSize; ++job)
+            {
+                jobSystem.Spawn(counter, [&executed] { executed.fetch_add(1, std::memory_order_relaxed); });
+            }
+            jobSystem.Wait(counter);
+        }
+        return NanosecondsPer(Clock::now() - start, executed.load());
+    }
+
+    // Every job forks children from whichever thread runs it, exercising push/pop on worker queues and stealing between them.
+    double BenchmarkForkJoin(wCore::JobSystem& jobSystem)
+    {
+        std::atomic<wIndex> executed = 0;
+        const Clock::time_point start = Clock::now();
+        wCore::JobCounter root;
+        for (wIndex parent = 0; parent < JobCount / BatchSize; ++parent)
+        {
+            jobSystem.Spawn(root, [&jobSystem, &executed]
+            {
+                wCore::JobCounter children;
+                for (wIndex child = 0; child < BatchSize - 1; ++child)
+                {
+                    jobSystem.Spawn(children, [&executed] { executed.fetch_add(1, std::memory_order_relaxed); });
+                }
+                jobSystem.Wait(children);
+                executed.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        jobSystem.Wait(root);
+        return NanosecondsPer(Clock::now() - start, executed.load());
+    }
+
+    double BenchmarkParallelFor(wCore::JobSystem& jobSystem, wIndex grainSize)
+    {
+        constexpr wIndex IndexCount = 1 << 24;
+        std::atomic<uint64_t> total = 0;
+        const Clock::time_point start = Clock::now();
+        jobSystem.ParallelFor(0, IndexCount, grainSize, [&total](wIndex begin, wIndex end)
+        {
+            uint64_t sum = 0;
+            for (wIndex index = begin; index < end; ++index)
+            {
+                sum += index;
+            }
+            total.fetch_add(sum, std::memory_order_relaxed);
+        });
+        const Clock::duration duration = Clock::now() - start;
+        if (total.load() != uint64_t(IndexCount) * (IndexCount - 1) / 2)
+        {
+            std::printf("ParallelFor produced a wrong result\n");
+        }
+        return NanosecondsPer(duration, IndexCount);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    wCore::JobSystem::Config config;
+    if (argc > 1)
+    {
+        config.workerCount = std::strtoul(argv[1], nullptr, 10);
+    }
+    config.pinWorkers = argc > 2 && std::atoi(argv[2]);
+
+    wCore::JobSystem jobSystem(config);
+    std::printf("JobSystem: %u workers, pinned: %s\n", static_cast<unsigned>(jobSystem.GetWorkerCount()), config.pinWorkers ? "yes" : "no");
+    std::printf("%-32s %10.2f ns/job\n", "Spawn + Wait (steal)", BenchmarkSpawnWait(jobSystem));
+    std::printf("%-32s %10.2f ns/job\n", "Nested fork-join", BenchmarkForkJoin(jobSystem));
+    for (const wIndex grainSize : { 256u, 4096u, 65536u })
+    {
+        std::printf("ParallelFor grain %-14u %10.4f ns/index\n", static_cast<unsigned>(grainSize), BenchmarkParallelFor(jobSystem, grainSize));
+    }
+    return 0;
+}
\ No newline at end of file
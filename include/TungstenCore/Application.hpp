@@ -1,7 +1,13 @@
 #ifndef TUNGSTEN_CORE_APPLICATION_HPP
 #define TUNGSTEN_CORE_APPLICATION_HPP
 
+#include "TungstenCore/CommandBuffer.hpp"
 #include "TungstenCore/ComponentSystem.hpp"
+#include "TungstenCore/EventBus.hpp"
+#include "TungstenCore/FrameLoop.hpp"
+#include "TungstenCore/JobSystem.hpp"
+#include "TungstenCore/SceneStreamer.hpp"
+#include "TungstenCore/SystemScheduler.hpp"
 
 namespace wCore {
     class Application
@@ -17,13 +23,59 @@ namespace wCore {
             int exitCode;
         };
 
+        struct Config
+        {
+            JobSystem::Config jobSystem;
+            ComponentSystem::Config componentSystem;
+            SceneStreamer::Config sceneStreamer;
+            FrameLoop::Config frameLoop;
+        };
+
+        // Called once per presented frame with FrameLoop::GetInterpolation, never in headless mode.
+        using PresentFn = std::function<void(Application& app, double interpolation)>;
+
         Application();
+        explicit Application(const Config& config);
+
+        // Runs frames until RequestExit or FrameLoop::Config::maxFrames. Every tick advances the ChangeVersion, runs the
+        // systems, plays back the command buffers, updates the SceneStreamer and swaps the EventBus.
         RunOutput Run();
+        // Safe from systems and jobs, Run returns after the current frame.
+        inline void RequestExit(int exitCode = 0) noexcept { m_exitCode.store(exitCode, std::memory_order_relaxed); m_exitRequested.store(true, std::memory_order_release); }
+        inline void SetPresentFn(PresentFn fn) { m_presentFn = std::move(fn); }
 
+        // Fixed time step for systems
+        [[nodiscard]] inline double GetTickSeconds() const noexcept { return m_frameLoop.GetTickSeconds(); }
+        [[nodiscard]] inline uint64_t GetTickCount() const noexcept { return m_frameLoop.GetStats().tickCount; }
+
+        inline JobSystem& GetJobSystem() { return m_jobSystem; }
+        inline EventBus& GetEventBus() { return m_eventBus; }
         inline ComponentSystem& GetComponentSystem() { return m_componentSystem; }
+        inline SystemScheduler& GetSystemScheduler() { return m_systemScheduler; }
+        inline CommandBufferSet& GetCommandBuffers() { return m_commandBuffers; }
+        inline SceneStreamer& GetSceneStreamer() { return m_sceneStreamer; }
+        inline FrameLoop& GetFrameLoop() { return m_frameLoop; }
+
+        // Buffer of the calling JobSystem thread, played back after the current frame.
+        inline CommandBuffer& GetCommandBuffer() { return m_commandBuffers.GetLocal(); }
+
+        // Systems
+        [[nodiscard]] inline SystemAccess Access() const { return SystemAccess(m_componentSystem.GetComponentSetup()); }
+        inline SystemIndex AddSystem(std::string_view name, const SystemAccess& access, SystemFn fn) { return m_systemScheduler.AddSystem(name, access, std::move(fn)); }
 
     private:
+        void Tick();
+
+        JobSystem m_jobSystem;
+        EventBus m_eventBus;
         ComponentSystem m_componentSystem;
+        CommandBufferSet m_commandBuffers;
+        SystemScheduler m_systemScheduler;
+        SceneStreamer m_sceneStreamer;
+        FrameLoop m_frameLoop;
+        PresentFn m_presentFn;
+        std::atomic<bool> m_exitRequested;
+        std::atomic<int> m_exitCode;
     };
 }
 
@@ -0,0 +1,144 @@
+#ifndef TUNGSTEN_CORE_ARCHETYPE_STORAGE_HPP
+#define TUNGSTEN_CORE_ARCHETYPE_STORAGE_HPP
+
+#include <array>
+#include <bit>
+#include <span>
+#include <tuple>
+#include <unordered_map>
+#include "TungstenCore/ComponentSetup.hpp"
+
+namespace wCore
+{
+    inline constexpr std::size_t ArchetypeChunkSize = 16 * 1024;
+    inline constexpr std::size_t ArchetypeChunkAlignment = 64;
+
+    using ArchetypeIndex = wIndex;
+    inline constexpr ArchetypeIndex InvalidArchetype = 0;
+    inline constexpr ArchetypeIndex ArchetypeIndexStart = 1;
+
+    // Entities with the same set of chunked components share an archetype.
+    // Each archetype stores its rows in fixed size chunks laid out as structure of arrays:
+    // [ArchetypeEntityIndex x rowsPerChunk][column 0 x rowsPerChunk][column 1 x rowsPerChunk]...
+    // Every column starts on an ArchetypeChunkAlignment boundary, so a column of a float component is an aligned stream.
+    class ArchetypeStorage
+    {
+    public:
+        struct Column
+        {
+            const ComponentSetup::ChunkedComponentOps* ops;
+            std::size_t size;
+            std::size_t offset;
+        };
+
+        struct Archetype
+        {
+            [[nodiscard]] inline wIndex GetChunkCount() const noexcept { return chunks.size(); }
+            [[nodiscard]] inline wIndex GetChunkRowCount(wIndex chunkIndex) const noexcept { return std::min(rowCount - chunkIndex * rowsPerChunk, rowsPerChunk); }
+            [[nodiscard]] inline wIndex GetUsedChunkCount() const noexcept { return wUtils::IntDivCeil(rowCount, rowsPerChunk); }
+            [[nodiscard]] inline wIndex GetColumnIndex(wIndex chunkedListIndex) const noexcept { return std::popcount(signature & ((ArchetypeSignature(1) << chunkedListIndex) - 1)); }
+
+            [[nodiscard]] inline ArchetypeEntityIndex* GetEntities(wIndex chunkIndex) const noexcept { return reinterpret_cast<ArchetypeEntityIndex*>(chunks[chunkIndex]); }
+            [[nodiscard]] inline std::byte* GetColumn(wIndex chunkIndex, wIndex columnIndex) const noexcept { return chunks[chunkIndex] + columns[columnIndex].offset; }
+            [[nodiscard]] inline std::byte* GetElement(wIndex row, wIndex columnIndex) const noexcept { return GetColumn(row / rowsPerChunk, columnIndex) + (row % rowsPerChunk) * columns[columnIndex].size; }
+
+            ArchetypeSignature signature;
+            std::vector<Column> columns;
+            std::vector<std::byte*> chunks;
+            wIndex rowsPerChunk;
+            wIndex rowCount;
+        };
+
+        explicit ArchetypeStorage(MemoryResource& chunkMemory) noexcept;
+        ~ArchetypeStorage() noexcept;
+
+        ArchetypeStorage(const ArchetypeStorage&) = delete;
+        ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+
+        [[nodiscard]] std::pair<ArchetypeEntityIndex, ComponentGeneration> Create(ArchetypeSignature signature, const ComponentSetup& componentSetup, Application& app);
+        void Destroy(ArchetypeEntityIndex entityIndex) noexcept;
+
+        // Moves an entity to the archetype for newSignature, constructing added components and destroying removed ones.
+        void ChangeSignature(ArchetypeEntityIndex entityIndex, ArchetypeSignature newSignature, const ComponentSetup& componentSetup, Application& app);
+
+        [[nodiscard]] inline bool EntityExists(ArchetypeEntityIndex entityIndex, ComponentGeneration generation) const noexcept { return entityIndex != InvalidArchetypeEntity && entityIndex <= m_entities.size() && m_entities[entityIndex - 1].archetypeIndex != InvalidArchetype && m_entities[entityIndex - 1].generation == generation; }
+        [[nodiscard]] inline ArchetypeSignature GetSignature(ArchetypeEntityIndex entityIndex) const noexcept { return m_archetypes[m_entities[entityIndex - 1].archetypeIndex - 1].signature; }
+        [[nodiscard]] void* GetComponent(ArchetypeEntityIndex entityIndex, wIndex chunkedListIndex) const noexcept;
+
+        [[nodiscard]] inline std::span<const Archetype> GetArchetypes() const noexcept { return m_archetypes; }
+        [[nodiscard]] inline wIndex GetEntityCount() const noexcept { return m_entities.size() - m_entityFreeList.Count(); }
+
+        [[nodiscard]] wIndex GetComponentCount(wIndex chunkedListIndex) const noexcept;
+        [[nodiscard]] wIndex GetComponentCapacity(wIndex chunkedListIndex) const noexcept;
+
+    private:
+        struct EntityRecord
+        {
+            ArchetypeIndex archetypeIndex;
+            wIndex row;
+            ComponentGeneration generation;
+        };
+
+        [[nodiscard]] ArchetypeIndex GetOrCreateArchetype(ArchetypeSignature signature, const ComponentSetup& componentSetup);
+        [[nodiscard]] wIndex PushRow(Archetype& archetype, ArchetypeEntityIndex entityIndex);
+        void PopRow(Archetype& archetype, wIndex row) noexcept;
+
+        MemoryResource& m_chunkMemory;
+        std::vector<Archetype> m_archetypes;
+        std::unordered_map<ArchetypeSignature, ArchetypeIndex> m_archetypeLookup;
+        std::vector<EntityRecord> m_entities;
+        wUtils::FreeList<ArchetypeEntityIndex> m_entityFreeList;
+    };
+
+    // Typed view of one chunk, safe to hand to another thread as long as no structural change happens meanwhile.
+    template<typename... Ts>
+    class ArchetypeChunk
+    {
+    public:
+        template<typename T>
+        [[nodiscard]] inline std::span<T> GetSpan() const noexcept { return { reinterpret_cast<T*>(m_columns[IndexOf<T>()]), m_rowCount }; }
+        [[nodiscard]] inline std::span<const ArchetypeEntityIndex> GetEntities() const noexcept { return { m_entities, m_rowCount }; }
+        [[nodiscard]] inline wIndex GetRowCount() const noexcept { return m_rowCount; }
+
+        template<typename Fn>
+        void Each(Fn&& fn) const
+        {
+            EachImpl(fn, std::index_sequence_for<Ts...>());
+        }
+
+    private:
+        ArchetypeChunk(const ArchetypeEntityIndex* entities, const std::array<std::byte*, sizeof...(Ts)>& columns, wIndex rowCount) noexcept
+            : m_entities(entities), m_columns(columns), m_rowCount(rowCount) {}
+
+        template<typename T, wIndex I = 0>
+        [[nodiscard]] static constexpr wIndex IndexOf() noexcept
+        {
+            static_assert(I < sizeof...(Ts), "Type is not part of this ArchetypeChunk");
+            if constexpr (std::is_same_v<T, std::tuple_element_t<I, std::tuple<Ts...>>>)
+            {
+                return I;
+            }
+            else
+            {
+                return IndexOf<T, I + 1>();
+            }
+        }
+
+        template<typename Fn, std::size_t... Is>
+        inline void EachImpl(Fn& fn, std::index_sequence<Is...>) const
+        {
+            for (wIndex row = 0; row < m_rowCount; ++row)
+            {
+                fn(reinterpret_cast<Ts*>(m_columns[Is])[row]...);
+            }
+        }
+
+        const ArchetypeEntityIndex* m_entities;
+        std::array<std::byte*, sizeof...(Ts)> m_columns;
+        wIndex m_rowCount;
+
+        friend class ComponentSystem;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,139 @@
+#ifndef TUNGSTEN_CORE_COMMAND_BUFFER_HPP
+#define TUNGSTEN_CORE_COMMAND_BUFFER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "TungstenCore/ComponentSystem.hpp"
+#include "TungstenCore/JobSystem.hpp"
+
+namespace wCore
+{
+    // Scenes and components created by a CommandBuffer only get real handles at playback.
+    using DeferredSceneIndex = wIndex;
+    inline constexpr DeferredSceneIndex InvalidDeferredScene = 0;
+    inline constexpr DeferredSceneIndex DeferredSceneIndexStart = 1;
+
+    using DeferredComponentIndex = wIndex;
+    inline constexpr DeferredComponentIndex InvalidDeferredComponent = 0;
+    inline constexpr DeferredComponentIndex DeferredComponentIndexStart = 1;
+
+    // Records structural changes so they can be applied at a sync point instead of while views are alive.
+    // A single CommandBuffer is not thread safe, use one per thread through CommandBufferSet.
+    class CommandBuffer
+    {
+    public:
+        explicit CommandBuffer(const ComponentSetup& componentSetup) noexcept;
+
+        // Scenes
+        [[nodiscard]] inline DeferredSceneIndex CreateScene() { return CreateScene(""); }
+        [[nodiscard]] DeferredSceneIndex CreateScene(std::string_view name);
+        void DestroyScene(SceneHandle sceneHandle);
+
+        // Components
+        template<typename T>
+        inline DeferredComponentIndex CreateComponent(SceneHandle sceneHandle) { return CreateComponent(m_componentSetup->GetComponentTypeIndex<T>(), sceneHandle); }
+
+        template<typename T>
+        inline DeferredComponentIndex CreateComponent(DeferredSceneIndex deferredSceneIndex) { return CreateComponent(m_componentSetup->GetComponentTypeIndex<T>(), deferredSceneIndex); }
+
+        template<typename T>
+        inline void DestroyComponent(ComponentHandle<T> componentHandle) { DestroyComponent(ComponentHandleAny(m_componentSetup->GetComponentTypeIndex<T>(), componentHandle.sceneHandle, componentHandle.componentIndex, componentHandle.generation)); }
+
+        DeferredComponentIndex CreateComponent(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle);
+        DeferredComponentIndex CreateComponent(ComponentTypeIndex componentTypeIndex, DeferredSceneIndex deferredSceneIndex);
+        void DestroyComponent(ComponentHandleAny componentHandle);
+
+        // Applies every command in recording order. Component storage is reserved once per scene and type before the first create.
+        // Destroys of scenes or components that no longer exist are skipped, so several threads may destroy the same thing.
+        // Creates in a scene that no longer exists are skipped too, their result is a handle with InvalidComponent.
+        void Playback(ComponentSystem& componentSystem);
+
+        // Drops the recorded commands but keeps the allocations. Results stay readable until the next Playback.
+        void Clear() noexcept;
+
+        // Results of the last Playback
+        [[nodiscard]] inline SceneHandle GetCreatedScene(DeferredSceneIndex deferredSceneIndex) const noexcept { W_ASSERT(deferredSceneIndex != InvalidDeferredScene && deferredSceneIndex <= m_createdScenes.size(), "DeferredSceneIndex: {} out of Range! Created Scene Count: {}", deferredSceneIndex, m_createdScenes.size()); return m_createdScenes[deferredSceneIndex - 1]; }
+        [[nodiscard]] inline ComponentHandleAny GetCreatedComponent(DeferredComponentIndex deferredComponentIndex) const noexcept { W_ASSERT(deferredComponentIndex != InvalidDeferredComponent && deferredComponentIndex <= m_createdComponents.size(), "DeferredComponentIndex: {} out of Range! Created Component Count: {}", deferredComponentIndex, m_createdComponents.size()); return m_createdComponents[deferredComponentIndex - 1]; }
+
+        template<typename T>
+        [[nodiscard]] inline ComponentHandle<T> GetCreatedComponent(DeferredComponentIndex deferredComponentIndex) const noexcept
+        {
+            const ComponentHandleAny handle = GetCreatedComponent(deferredComponentIndex);
+            W_ASSERT(handle.componentTypeIndex == m_componentSetup->GetComponentTypeIndex<T>(), "DeferredComponent: {} is not a {}", deferredComponentIndex, m_componentSetup->GetComponentTypeName<T>());
+            return ComponentHandle<T>(handle.sceneHandle, handle.componentIndex, handle.generation);
+        }
+
+        [[nodiscard]] inline bool Empty() const noexcept { return m_commands.empty(); }
+        [[nodiscard]] inline wIndex GetCommandCount() const noexcept { return m_commands.size(); }
+
+    private:
+        enum class CommandType : uint8_t
+        {
+            CreateScene,
+            DestroyScene,
+            CreateComponent,
+            DestroyComponent
+        };
+
+        struct Command
+        {
+            CommandType type;
+            ComponentTypeIndex componentTypeIndex;
+            SceneHandle sceneHandle;
+            DeferredSceneIndex deferredSceneIndex; // Used instead of sceneHandle when set
+            ComponentIndex componentIndex;
+            ComponentGeneration generation;
+            wIndex reservationIndex;
+        };
+
+        // Pending creates of one type in one scene, so playback can reserve before the first one runs.
+        struct Reservation
+        {
+            ComponentTypeIndex componentTypeIndex;
+            SceneIndex sceneIndex;
+            DeferredSceneIndex deferredSceneIndex;
+            wIndex count;
+        };
+
+        [[nodiscard]] wIndex AddReservation(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex, DeferredSceneIndex deferredSceneIndex);
+
+        const ComponentSetup* m_componentSetup;
+        std::vector<Command> m_commands;
+        std::vector<std::string> m_sceneNames; // Indexed by DeferredSceneIndex
+        std::vector<Reservation> m_reservations;
+        wIndex m_createComponentCount;
+
+        std::vector<SceneHandle> m_createdScenes;
+        std::vector<ComponentHandleAny> m_createdComponents;
+    };
+
+    // One CommandBuffer per JobSystem thread, so jobs can record without locking.
+    // Threads outside the JobSystem share index 0 with the owner thread and must record into their own CommandBuffer instead.
+    class CommandBufferSet
+    {
+    public:
+        CommandBufferSet(const ComponentSetup& componentSetup, const JobSystem& jobSystem);
+
+        [[nodiscard]] inline CommandBuffer& GetLocal() noexcept { return GetBuffer(JobSystem::GetCurrentWorkerIndex()); }
+        [[nodiscard]] inline CommandBuffer& GetBuffer(wIndex threadIndex) noexcept { W_ASSERT(threadIndex < m_bufferCount, "Thread index: {} out of Range! Buffer Count: {}", threadIndex, m_bufferCount); return m_buffers[threadIndex].buffer; }
+        [[nodiscard]] inline wIndex GetBufferCount() const noexcept { return m_bufferCount; }
+
+        // Plays back and clears every buffer in thread index order. Must not run while jobs are recording.
+        void Playback(ComponentSystem& componentSystem);
+
+    private:
+        struct alignas(64) PaddedBuffer
+        {
+            explicit PaddedBuffer(const ComponentSetup& componentSetup) noexcept
+                : buffer(componentSetup) {}
+
+            CommandBuffer buffer;
+        };
+
+        std::vector<PaddedBuffer> m_buffers;
+        wIndex m_bufferCount;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,201 @@
+#ifndef TUNGSTEN_CORE_COMPONENT_REGISTRY_HPP
+#define TUNGSTEN_CORE_COMPONENT_REGISTRY_HPP
+
+#include <array>
+#include <string_view>
+#include <tuple>
+#include "TungstenCore/ComponentSystem.hpp"
+
+namespace wCore
+{
+    // One type of a ComponentRegistry, with the parameters of ComponentSetup::Add.
+    template<typename T, wIndex PageSize = 0, typename GrowthPolicy = ComponentSetup::DefaultGrowthPolicy>
+    struct ComponentDesc
+    {
+        using Type = T;
+        using Growth = GrowthPolicy;
+        static constexpr wIndex pageSize = PageSize;
+    };
+
+    // A list of component types known when the engine is built. Registering them first fixes their type and list
+    // indices, so the typed paths below resolve storage, list index and growth policy at compile time and call the
+    // list code directly instead of through the function pointers of the ComponentSetup. Types of plugins are still
+    // added to the same ComponentSetup at runtime, after the registry, and use the regular ComponentSystem calls.
+    //
+    //     using Registry = ComponentRegistry<ComponentDesc<Transform>, ComponentDesc<Velocity>, ComponentDesc<Light, 64>>;
+    //     Registry::Register(componentSetup, { "Transform", "Velocity", "Light" });
+    //     Registry::Each<Transform, const Velocity>(componentSystem, scene, fn);
+    template<typename... Descs>
+    class ComponentRegistry
+    {
+    public:
+        static constexpr wIndex TypeCount = sizeof...(Descs);
+
+        // Adds every type in order, before any other type.
+        static void Register(ComponentSetup& componentSetup, const std::array<std::string_view, TypeCount>& names)
+        {
+            W_ASSERT(componentSetup.GetComponentTypeCount() == 0, "ComponentRegistry must be registered before any other component type");
+            RegisterImpl(componentSetup, names, std::index_sequence_for<Descs...>());
+        }
+
+        template<typename T>
+        [[nodiscard]] static constexpr ComponentTypeIndex GetComponentTypeIndex() noexcept { return IndexOf<T>() + ComponentTypeIndexStart; }
+        template<typename T>
+        [[nodiscard]] static constexpr wIndex GetPageSize() noexcept { return DescOf<T>::pageSize; }
+        // Index among the lists of the same storage, as ComponentSetup counts them.
+        template<typename T>
+        [[nodiscard]] static constexpr wIndex GetListIndex() noexcept
+        {
+            constexpr wIndex index = IndexOf<T>();
+            constexpr std::array<wIndex, TypeCount> pageSizes = { Descs::pageSize... };
+            wIndex listIndex = 0;
+            for (wIndex i = 0; i < index; ++i)
+            {
+                listIndex += GetStorage(pageSizes[i]) == GetStorage(pageSizes[index]);
+            }
+            return listIndex;
+        }
+
+        template<typename T>
+        [[nodiscard]] static ComponentHandle<T> Create(ComponentSystem& componentSystem, SceneHandle sceneHandle)
+        {
+            using Desc = DescOf<T>;
+            static_assert(Desc::pageSize != ComponentSetup::ChunkedStorage, "ChunkedStorage components are created through archetype entities");
+            W_ASSERT(componentSystem.SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+            const ComponentSystem::WriteScope writeScope(componentSystem);
+            ComponentSetup::CreateCtx& createCtx = componentSystem.m_createCtx;
+            const ComponentSetup::ComponentAllocator allocator = componentSystem.GetComponentAllocator(sceneHandle.sceneIndex);
+            constexpr wIndex listIndex = GetListIndex<T>();
+            std::pair<ComponentIndex, ComponentGeneration> created;
+            if constexpr (Desc::pageSize)
+            {
+                created = ComponentSetup::EmplacePages<T, Desc::pageSize, typename Desc::Growth>(createCtx.GetPageListHot(sceneHandle.sceneIndex, listIndex), createCtx.GetPageListCold(sceneHandle.sceneIndex, listIndex), allocator, componentSystem.m_app);
+            }
+            else
+            {
+                created = ComponentSetup::EmplaceComponents<T, typename Desc::Growth>(createCtx.GetComponentListHot(sceneHandle.sceneIndex, listIndex), createCtx.GetComponentListCold(sceneHandle.sceneIndex, listIndex), createCtx.changeVersion, allocator, componentSystem.m_app);
+            }
+            return ComponentHandle<T>(sceneHandle, created.first, created.second);
+        }
+
+        template<typename T>
+        static void Reserve(ComponentSystem& componentSystem, SceneIndex sceneIndex, wIndex minCapacity)
+        {
+            using Desc = DescOf<T>;
+            static_assert(Desc::pageSize != ComponentSetup::ChunkedStorage, "ChunkedStorage components are reserved through their archetype");
+            const ComponentSystem::WriteScope writeScope(componentSystem);
+            ComponentSetup::CreateCtx& createCtx = componentSystem.m_createCtx;
+            constexpr wIndex listIndex = GetListIndex<T>();
+            if constexpr (Desc::pageSize)
+            {
+                ComponentSetup::PageListHeaderCold& headerCold = createCtx.GetPageListCold(sceneIndex, listIndex);
+                if (minCapacity > headerCold.pageCount * Desc::pageSize)
+                {
+                    ComponentSetup::ReallocatePages<T, Desc::pageSize>(createCtx.GetPageListHot(sceneIndex, listIndex), headerCold, wUtils::IntDivCeil(minCapacity, Desc::pageSize), componentSystem.GetComponentAllocator(sceneIndex));
+                }
+            }
+            else
+            {
+                ComponentSetup::ComponentListHeaderCold& headerCold = createCtx.GetComponentListCold(sceneIndex, listIndex);
+                if (minCapacity > headerCold.capacity)
+                {
+                    ComponentSetup::ReallocateComponents<T>(createCtx.GetComponentListHot(sceneIndex, listIndex), headerCold, minCapacity, componentSystem.GetComponentAllocator(sceneIndex));
+                }
+            }
+        }
+
+        // Returns nullptr if the handle is stale, like ComponentSystem::GetComponent.
+        template<typename T>
+        [[nodiscard]] static T* Get(ComponentSystem& componentSystem, ComponentHandle<T> componentHandle) noexcept
+        {
+            using Desc = DescOf<T>;
+            static_assert(Desc::pageSize != ComponentSetup::ChunkedStorage, "ChunkedStorage components are found through archetype entities");
+            if (!componentSystem.SceneExists(componentHandle.sceneHandle) || componentHandle.componentIndex == InvalidComponent)
+            {
+                return nullptr;
+            }
+            const ComponentSetup::CreateCtx& createCtx = componentSystem.m_createCtx;
+            const SceneIndex sceneIndex = componentHandle.sceneHandle.sceneIndex;
+            const wIndex slotIndex = componentHandle.componentIndex - 1;
+            constexpr wIndex listIndex = GetListIndex<T>();
+            if constexpr (Desc::pageSize)
+            {
+                const ComponentSetup::PageListHeaderHot& headerHot = createCtx.GetPageListHot(sceneIndex, listIndex);
+                if (componentHandle.componentIndex > createCtx.GetPageListCold(sceneIndex, listIndex).slotCount || !(headerHot.generations[slotIndex] == componentHandle.generation))
+                {
+                    return nullptr;
+                }
+                return static_cast<T* const*>(headerHot.data)[slotIndex / Desc::pageSize] + slotIndex % Desc::pageSize;
+            }
+            else
+            {
+                const ComponentSetup::ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(sceneIndex, listIndex);
+                if (componentHandle.componentIndex > createCtx.GetComponentListCold(sceneIndex, listIndex).slotCount || !(headerHot.generations[slotIndex] == componentHandle.generation))
+                {
+                    return nullptr;
+                }
+                return static_cast<T*>(headerHot.dense) + headerHot.slotToDense[slotIndex] - 1;
+            }
+        }
+
+        template<typename... Ts>
+        [[nodiscard]] static ComponentView<Ts...> View(ComponentSystem& componentSystem, SceneHandle sceneHandle) noexcept
+        {
+            W_ASSERT(componentSystem.SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+            return ComponentView<Ts...>({ GetDenseListView<std::remove_const_t<Ts>>(componentSystem.m_createCtx, sceneHandle.sceneIndex)... }, componentSystem.m_createCtx.changeVersion);
+        }
+
+        template<typename... Ts, typename Fn>
+        static inline void Each(ComponentSystem& componentSystem, SceneHandle sceneHandle, Fn&& fn) { View<Ts...>(componentSystem, sceneHandle).Each(std::forward<Fn>(fn)); }
+
+        template<typename T>
+        [[nodiscard]] static inline std::span<T> GetDenseSpan(ComponentSystem& componentSystem, SceneHandle sceneHandle) noexcept { return View<T>(componentSystem, sceneHandle).template GetSpan<T>(); }
+
+    private:
+        enum class Storage : uint8_t
+        {
+            Dense,
+            Paged,
+            Chunked
+        };
+
+        [[nodiscard]] static constexpr Storage GetStorage(wIndex pageSize) noexcept
+        {
+            return pageSize == ComponentSetup::ChunkedStorage ? Storage::Chunked : pageSize ? Storage::Paged : Storage::Dense;
+        }
+
+        template<typename T>
+        [[nodiscard]] static constexpr wIndex IndexOf() noexcept
+        {
+            static_assert((std::is_same_v<T, typename Descs::Type> || ...), "Type is not part of this ComponentRegistry");
+            constexpr std::array<bool, TypeCount> matches = { std::is_same_v<T, typename Descs::Type>... };
+            wIndex index = 0;
+            while (index < TypeCount && !matches[index])
+            {
+                ++index;
+            }
+            return index;
+        }
+
+        template<typename T>
+        using DescOf = std::tuple_element_t<IndexOf<T>(), std::tuple<Descs...>>;
+
+        template<std::size_t... Is>
+        static void RegisterImpl(ComponentSetup& componentSetup, const std::array<std::string_view, TypeCount>& names, std::index_sequence<Is...>)
+        {
+            (componentSetup.Add<typename Descs::Type, Descs::pageSize, typename Descs::Growth>(names[Is]), ...);
+        }
+
+        template<typename T>
+        [[nodiscard]] static DenseListView GetDenseListView(const ComponentSetup::CreateCtx& createCtx, SceneIndex sceneIndex) noexcept
+        {
+            static_assert(DescOf<T>::pageSize == 0, "Only dense lists can be viewed");
+            constexpr wIndex listIndex = GetListIndex<T>();
+            const ComponentSetup::ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(sceneIndex, listIndex);
+            const ComponentSetup::ComponentListHeaderCold& headerCold = createCtx.GetComponentListCold(sceneIndex, listIndex);
+            return { headerHot.dense, headerHot.slotToDense, headerHot.denseToSlot, headerHot.versions, headerCold.denseCount, headerCold.slotCount };
+        }
+    };
+}
+
+#endif
\ No newline at end of file
@@ -1,14 +1,25 @@
 #ifndef TUNGSTEN_CORE_COMPONENT_SETUP_HPP
 #define TUNGSTEN_CORE_COMPONENT_SETUP_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
 #include "TungstenUtils/TungstenUtils.hpp"
+#include "TungstenCore/MemoryResource.hpp"
+#include "TungstenCore/Profiler.hpp"
 
 namespace wCore
 {
     class Application;
+    template<typename... Descs>
+    class ComponentRegistry;
 
     using ComponentTypeIndex = wIndex;
     inline constexpr ComponentTypeIndex InvalidComponentType = 0;
@@ -22,10 +33,97 @@ namespace wCore
     inline constexpr ComponentIndex InvalidComponent = 0;
     inline constexpr ComponentIndex ComponentIndexStart = 1;
 
+    using ArchetypeEntityIndex = wIndex;
+    inline constexpr ArchetypeEntityIndex InvalidArchetypeEntity = 0;
+    inline constexpr ArchetypeEntityIndex ArchetypeEntityIndexStart = 1;
+
+    // Dense lists stamp the version of their last write on every block of ChangeBlockSize positions. 0 is never written.
+    using ChangeVersion = uint32_t;
+    inline constexpr ChangeVersion ChangeVersionStart = 1;
+    inline constexpr wIndex ChangeBlockSize = 64;
+
+    [[nodiscard]] inline constexpr wIndex GetChangeBlockCount(wIndex denseCount) noexcept { return (denseCount + ChangeBlockSize - 1) / ChangeBlockSize; }
+
+    // Dense arrays start on a cache line, which is also the width of the widest SIMD loads, see SimdKernels.
+    inline constexpr std::size_t DenseAlignment = 64;
+
+    // One bit per chunked component type, indexed by its list index.
+    using ArchetypeSignature = uint64_t;
+    inline constexpr wIndex MaxChunkedComponentTypes = 64;
+
     class ComponentGeneration
     {
+    public:
+        constexpr ComponentGeneration() noexcept
+            : generation(0) {}
+
+        friend constexpr bool operator==(const ComponentGeneration&, const ComponentGeneration&) = default;
+
+    private:
         uint32_t generation;
+        friend class ComponentSetup;
         friend class ComponentSystem;
+        friend class ArchetypeStorage;
+        friend class EntityTable;
+    };
+
+    // Counts list reallocations per component type by the power of two of the new slot capacity. Thread safe, staged
+    // scenes record from their build threads.
+    class ReallocationHistogram
+    {
+    public:
+        // Bucket b counts new capacities in [2^b, 2^(b + 1)), the last bucket also everything larger.
+        static constexpr wIndex BucketCount = 32;
+        using Buckets = std::array<uint32_t, BucketCount>;
+
+        explicit ReallocationHistogram(wIndex componentTypeCount)
+            : m_componentTypeCount(componentTypeCount), m_counts(std::make_unique<std::atomic<uint32_t>[]>(componentTypeCount * BucketCount)) {}
+
+        inline void Record(ComponentTypeIndex componentTypeIndex, wIndex newCapacity) noexcept
+        {
+            if (componentTypeIndex == InvalidComponentType || componentTypeIndex > m_componentTypeCount)
+            {
+                return;
+            }
+            const wIndex bucket = std::min<wIndex>(newCapacity ? std::bit_width(newCapacity) - 1 : 0, BucketCount - 1);
+            m_counts[(componentTypeIndex - 1) * BucketCount + bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] Buckets Get(ComponentTypeIndex componentTypeIndex) const noexcept
+        {
+            Buckets buckets;
+            for (wIndex bucket = 0; bucket < BucketCount; ++bucket)
+            {
+                buckets[bucket] = m_counts[(componentTypeIndex - 1) * BucketCount + bucket].load(std::memory_order_relaxed);
+            }
+            return buckets;
+        }
+
+        void Reset() noexcept
+        {
+            for (wIndex index = 0; index < m_componentTypeCount * BucketCount; ++index)
+            {
+                m_counts[index].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        // Makes room for types added after the first scene and keeps the counts so far. Nothing may record meanwhile.
+        void Resize(wIndex componentTypeCount)
+        {
+            std::unique_ptr<std::atomic<uint32_t>[]> counts = std::make_unique<std::atomic<uint32_t>[]>(componentTypeCount * BucketCount);
+            for (wIndex index = 0; index < std::min(componentTypeCount, m_componentTypeCount) * BucketCount; ++index)
+            {
+                counts[index].store(m_counts[index].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            m_counts = std::move(counts);
+            m_componentTypeCount = componentTypeCount;
+        }
+
+        [[nodiscard]] inline wIndex GetComponentTypeCount() const noexcept { return m_componentTypeCount; }
+
+    private:
+        wIndex m_componentTypeCount;
+        std::unique_ptr<std::atomic<uint32_t>[]> m_counts;
     };
 
     class ComponentSetup
@@ -40,11 +138,11 @@ namespace wCore
             {
                 if constexpr (PageSize)
                 {
-                    return NextCapacity(requested, current);
+                    return NextPageCount(requested, current);
                 }
                 else
                 {
-                    return NextPageCount(requested, current);
+                    return NextCapacity(requested, current);
                 }
             }
 
@@ -60,6 +158,9 @@ namespace wCore
             [[nodiscard]] static inline constexpr wIndex NextPageCount(wIndex requestedPageCount, wIndex currentPageCount) noexcept { return requestedPageCount; }
         };
 
+        // Passed as PageSize to store a type in archetype chunks instead of its own list.
+        static constexpr wIndex ChunkedStorage = std::numeric_limits<wIndex>::max();
+
         ComponentSetup() noexcept;
 
         static_assert(std::is_nothrow_default_constructible_v<std::string>);
@@ -67,6 +168,9 @@ namespace wCore
         ComponentSetup(const ComponentSetup&) = delete;
         ComponentSetup& operator=(const ComponentSetup&) = delete;
 
+        // Types can also be added while scenes exist, for example by a plugin, on the thread that owns the ComponentSystem.
+        // Their lists start empty in every scene. Not while TryGet runs on other threads or a StagedScene is pending,
+        // the type table may move.
         template<typename T,
                  wIndex PageSize = 0,
                  typename GrowthPolicy = DefaultGrowthPolicy>
@@ -75,36 +179,91 @@ namespace wCore
             static_assert(std::is_nothrow_destructible_v<T>, "Components must be nothrow-destructible");
             W_ASSERT(!StaticComponentID<T>::GetID(), "Component: {} Already added to ComponentSetup!", typeName);
             m_names.emplace_back(typeName);
-            if constexpr (PageSize)
+            if constexpr (PageSize == ChunkedStorage)
+            {
+                static_assert(std::is_nothrow_move_constructible_v<T>, "Chunked components must be nothrow-move-constructible");
+                W_ASSERT(m_chunkedTypes.size() < MaxChunkedComponentTypes, "Component: {} exceeds the limit of {} chunked component types", typeName, MaxChunkedComponentTypes);
+                const wIndex listIndex = m_chunkedTypes.size();
+                m_types.emplace_back(sizeof(T), alignof(T), std::is_trivially_copyable_v<T>, &ChunkedOps<T>, listIndex);
+                m_chunkedTypes.emplace_back(m_types.size());
+                StaticComponentID<T>::Set(m_types.size(), listIndex, PageSize);
+            }
+            else if constexpr (PageSize)
             {
-                const wIndex listIndex = m_types.size() - m_componentListCount;
-                m_types.emplace_back(sizeof(T), alignof(T), &ReallocatePages<T, PageSize>, &CreateComponent<T, PageSize, GrowthPolicy>, /*&DestroyKnownListUnchecked<T>*/ nullptr, PageSize, listIndex);
-                StaticComponentID<T>::Set(m_types.size(), listIndex);
+                const wIndex listIndex = m_pageListCount++;
+                m_types.emplace_back(sizeof(T), alignof(T), std::is_trivially_copyable_v<T>, &ReallocatePages<T, PageSize>, &CreateComponent<T, PageSize, GrowthPolicy>, &CreateComponents<T, PageSize, GrowthPolicy>, &RemoveComponent<T, PageSize>, &RemoveComponents<T, PageSize>, &InstantiateComponents<T, PageSize, GrowthPolicy>, &DestroyPageList<T, PageSize>, listIndex, PageSize);
+                StaticComponentID<T>::Set(m_types.size(), listIndex, PageSize);
             }
             else
             {
                 const wIndex listIndex = m_componentListCount++;
-                m_types.emplace_back(sizeof(T), alignof(T), &ReallocateComponents<T>, &CreateComponent<T, PageSize, GrowthPolicy>, /*&DestroyKnownListUnchecked<T>*/ nullptr, listIndex);
-                StaticComponentID<T>::Set(m_types.size(), listIndex);
+                m_types.emplace_back(sizeof(T), alignof(T), std::is_trivially_copyable_v<T>, &ReallocateComponents<T>, &CreateComponent<T, PageSize, GrowthPolicy>, &CreateComponents<T, PageSize, GrowthPolicy>, &RemoveComponent<T, PageSize>, &RemoveComponents<T, PageSize>, &InstantiateComponents<T, PageSize, GrowthPolicy>, &DestroyComponentList<T>, listIndex);
+                StaticComponentID<T>::Set(m_types.size(), listIndex, 0);
+            }
+            if (m_typeAdded)
+            {
+                m_typeAdded(m_types.size());
             }
         }
 
+        // Keeps the dense list of T ordered by KeyFn, a function or captureless lambda that maps a const T& to an unsigned
+        // integer, for example a material, mesh or depth bucket. Components with equal keys keep their relative order.
+        // Removing shifts the rest of the list down instead of swapping the last component into the hole. New components
+        // are appended, see ComponentSystem::SortComponent and SortComponents. Only for dense lists.
+        template<typename T, auto KeyFn>
+        void SetSortKey() noexcept
+        {
+            static_assert(std::is_nothrow_invocable_r_v<uint64_t, decltype(KeyFn), const T&>, "Sort keys must be nothrow-invocable with const T& and return an unsigned integer");
+            W_ASSERT(StaticComponentID<T>::GetID() && !StaticComponentID<T>::GetPageSize(), "Type: {} must be added to ComponentSetup as a dense list to be sorted", wUtils::DebugGetTypeName<T>());
+            ComponentType& type = m_types[StaticComponentID<T>::GetID() - 1];
+            type.remove = &RemoveComponentOrdered<T>;
+            type.removeBatch = &RemoveComponentsOrdered<T>;
+            type.sortKey = &GetSortKey<T, KeyFn>;
+            type.sortList = &SortComponentList<T, KeyFn>;
+            type.sortComponent = &SortComponentSlot<T, KeyFn>;
+        }
+
+        template<typename T>
+        [[nodiscard]] inline bool IsSorted() const noexcept { return m_types[GetComponentTypeIndex<T>() - 1].sortKey != nullptr; }
+
         // internal
         template<typename T>
-        inline ComponentTypeIndex GetComponentTypeIndex() const noexcept { W_ASSERT(StaticComponentID<T>::Get(), "Type: {} not added to ComponentSetup", wUtils::DebugGetTypeName<T>()); return StaticComponentID<T>::Get(); }
+        inline ComponentTypeIndex GetComponentTypeIndex() const noexcept { W_ASSERT(StaticComponentID<T>::GetID(), "Type: {} not added to ComponentSetup", wUtils::DebugGetTypeName<T>()); return StaticComponentID<T>::GetID(); }
 
         template<typename T>
-        inline std::string_view GetComponentTypeName() const noexcept { W_ASSERT(GetComponentTypeIndex<T>(), "Type: {} not added to ComponentSetup", wUtils::DebugGetTypeName<T>()); return GetComponentTypeNameFromTypeIndex(StaticComponentID<T>::Get()); }
+        inline std::string_view GetComponentTypeName() const noexcept { W_ASSERT(GetComponentTypeIndex<T>(), "Type: {} not added to ComponentSetup", wUtils::DebugGetTypeName<T>()); return GetComponentTypeNameFromTypeIndex(StaticComponentID<T>::GetID()); }
 
         inline std::string_view GetComponentTypeNameFromTypeIndex(ComponentTypeIndex componentTypeIndex) const noexcept { W_ASSERT(componentTypeIndex != InvalidComponentType, "ComponentTypeIndex {} is Invalid", InvalidComponentType); W_ASSERT(componentTypeIndex <= m_names.size(), "ComponentTypeIndex: {} out of Range! Component Type Count: {}", componentTypeIndex, m_names.size()); return m_names[componentTypeIndex - 1]; }
         inline wIndex GetComponentTypeCount() const noexcept { return m_types.size(); }
 
+        template<typename T>
+        [[nodiscard]] inline bool IsPaged() const noexcept { W_ASSERT(StaticComponentID<T>::GetID(), "Type: {} not added to ComponentSetup", wUtils::DebugGetTypeName<T>()); return StaticComponentID<T>::GetPageSize() && !IsChunked<T>(); }
+
+        template<typename T>
+        [[nodiscard]] inline bool IsChunked() const noexcept { W_ASSERT(StaticComponentID<T>::GetID(), "Type: {} not added to ComponentSetup", wUtils::DebugGetTypeName<T>()); return StaticComponentID<T>::GetPageSize() == ChunkedStorage; }
+
+        [[nodiscard]] inline bool IsChunkedFromTypeIndex(ComponentTypeIndex componentTypeIndex) const noexcept { W_ASSERT(componentTypeIndex != InvalidComponentType && componentTypeIndex <= m_types.size(), "ComponentTypeIndex: {} out of Range! Component Type Count: {}", componentTypeIndex, m_types.size()); return m_types[componentTypeIndex - 1].IsChunked(); }
+
+        template<typename... Ts>
+        [[nodiscard]] inline ArchetypeSignature GetArchetypeSignature() const noexcept
+        {
+            W_ASSERT((IsChunked<Ts>() && ...), "All types in an archetype signature must use ChunkedStorage");
+            return (ArchetypeSignature(0) | ... | (ArchetypeSignature(1) << StaticComponentID<Ts>::GetListIndex()));
+        }
+
+        [[nodiscard]] inline wIndex GetChunkedComponentTypeCount() const noexcept { return m_chunkedTypes.size(); }
+
     private:
+        // slotToDense[slot - 1] holds the 1 based dense position of a live slot and 0 for a free one.
+        // denseToSlot[densePosition] holds the ComponentIndex stored at that position.
+        // versions[densePosition / ChangeBlockSize] holds the ChangeVersion of the last write to that block.
         struct ComponentListHeaderHot
         {
             void* dense;
-            ComponentIndex* slotToDense; // scene 0
+            ComponentIndex* slotToDense;
+            ComponentIndex* denseToSlot;
             ComponentGeneration* generations;
+            ChangeVersion* versions;
         };
 
         struct ComponentListHeaderCold
@@ -115,6 +274,7 @@ namespace wCore
             wUtils::RelocatableFreeListHeader<ComponentIndex> freeList;
         };
 
+        // A paged slot is live while its generation is odd, destroying a component bumps it back to even.
         struct PageListHeaderHot
         {
             void* data;
@@ -130,42 +290,142 @@ namespace wCore
 
         struct CreateCtx
         {
-            [[nodiscard]] inline wIndex GetCurrentComponentTypeCount() noexcept { return currentComponentTypeCount; }
-            [[nodiscard]] inline wIndex GetCurrentComponentListCount() noexcept { return currentComponentListCount; }
-            [[nodiscard]] inline wIndex GetCurrentPageListCount() noexcept { return currentComponentTypeCount - currentComponentListCount; }
+            [[nodiscard]] inline wIndex GetCurrentComponentTypeCount() const noexcept { return currentComponentTypeCount; }
+            [[nodiscard]] inline wIndex GetCurrentComponentListCount() const noexcept { return currentComponentListCount; }
+            [[nodiscard]] inline wIndex GetCurrentPageListCount() const noexcept { return currentPageListCount; }
+
+            // Including the late lists.
+            [[nodiscard]] inline wIndex GetComponentListCount() const noexcept { return currentComponentListCount + lateComponentListCount; }
+            [[nodiscard]] inline wIndex GetPageListCount() const noexcept { return currentPageListCount + latePageListCount; }
+
+            // Index into the scene block, only for lists below the current counts.
+            [[nodiscard]] inline std::size_t GetComponentListHeaderIndex(SceneIndex sceneIndex, wIndex listIndex) const noexcept { return (sceneIndex - 1) * GetCurrentComponentListCount() + listIndex; }
+            [[nodiscard]] inline std::size_t GetPageListHeaderIndex(SceneIndex sceneIndex, wIndex listIndex) const noexcept { return (sceneIndex - 1) * GetCurrentPageListCount() + listIndex; }
+
+            [[nodiscard]] inline ComponentListHeaderHot& GetComponentListHot(SceneIndex sceneIndex, wIndex listIndex) const noexcept
+            {
+                if (listIndex < currentComponentListCount)
+                {
+                    return componentListsHot[GetComponentListHeaderIndex(sceneIndex, listIndex)];
+                }
+                return GetLateHot<ComponentListHeaderHot>(lateComponentLists[listIndex - currentComponentListCount], sceneIndex);
+            }
+            [[nodiscard]] inline ComponentListHeaderCold& GetComponentListCold(SceneIndex sceneIndex, wIndex listIndex) const noexcept
+            {
+                if (listIndex < currentComponentListCount)
+                {
+                    return componentListsCold[GetComponentListHeaderIndex(sceneIndex, listIndex)];
+                }
+                return GetLateCold<ComponentListHeaderHot, ComponentListHeaderCold>(lateComponentLists[listIndex - currentComponentListCount], lateSceneCapacity, sceneIndex);
+            }
+            [[nodiscard]] inline PageListHeaderHot& GetPageListHot(SceneIndex sceneIndex, wIndex listIndex) const noexcept
+            {
+                if (listIndex < currentPageListCount)
+                {
+                    return pageListsHot[GetPageListHeaderIndex(sceneIndex, listIndex)];
+                }
+                return GetLateHot<PageListHeaderHot>(latePageLists[listIndex - currentPageListCount], sceneIndex);
+            }
+            [[nodiscard]] inline PageListHeaderCold& GetPageListCold(SceneIndex sceneIndex, wIndex listIndex) const noexcept
+            {
+                if (listIndex < currentPageListCount)
+                {
+                    return pageListsCold[GetPageListHeaderIndex(sceneIndex, listIndex)];
+                }
+                return GetLateCold<PageListHeaderHot, PageListHeaderCold>(latePageLists[listIndex - currentPageListCount], lateSceneCapacity, sceneIndex);
+            }
 
-            void UpdateCurrentComponentListCount(wIndex componentTypeCount, wIndex componentListCount) noexcept;
+            // A late list is one block holding the hot headers of every scene slot followed by the cold ones.
+            template<typename Hot, typename Cold>
+            [[nodiscard]] static inline constexpr std::size_t GetLateColdOffset(wIndex sceneCapacity) noexcept { return wUtils::AlignUp(sceneCapacity * sizeof(Hot), alignof(Cold)); }
+            template<typename Hot, typename Cold>
+            [[nodiscard]] static inline constexpr std::size_t GetLateListSize(wIndex sceneCapacity) noexcept { return GetLateColdOffset<Hot, Cold>(sceneCapacity) + sceneCapacity * sizeof(Cold); }
+            template<typename Hot>
+            [[nodiscard]] static inline Hot& GetLateHot(void* lateList, SceneIndex sceneIndex) noexcept { return static_cast<Hot*>(lateList)[sceneIndex - 1]; }
+            template<typename Hot, typename Cold>
+            [[nodiscard]] static inline Cold& GetLateCold(void* lateList, wIndex sceneCapacity, SceneIndex sceneIndex) noexcept { return reinterpret_cast<Cold*>(static_cast<std::byte*>(lateList) + GetLateColdOffset<Hot, Cold>(sceneCapacity))[sceneIndex - 1]; }
+
+            void UpdateCurrentComponentListCount(wIndex componentTypeCount, wIndex componentListCount, wIndex pageListCount) noexcept;
 
             ComponentListHeaderHot* componentListsHot;
             PageListHeaderHot* pageListsHot;
             ComponentListHeaderCold* componentListsCold;
             PageListHeaderCold* pageListsCold;
-            wIndex currentComponentTypeCount;
-            wIndex currentComponentListCount;
+            // Lists of types added after the scene block was laid out. They live in their own blocks until the next
+            // reallocation of the scene block widens the stride, see ComponentSystem::AddLateList.
+            void** lateComponentLists;
+            void** latePageLists;
+            ChangeVersion changeVersion; // Stamped on dense blocks written by structural changes
+            wIndex currentComponentTypeCount; // Including the late types
+            wIndex currentComponentListCount; // Lists per scene in the scene block
+            wIndex currentPageListCount;
+            wIndex lateComponentListCount;
+            wIndex latePageListCount;
+            wIndex lateSceneCapacity;
         };
 
-        using ReallocateComponentsFn = void(*)(ComponentListHeaderHot& headerHot, ComponentListHeaderCold& headerCold, wIndex newSlotCapacity);
-        using ReallocatePagesFn = void(*)(PageListHeaderHot& headerHot, PageListHeaderCold& headerCold, wIndex newPageCount);
-        using ComponentCreateFn = std::pair<ComponentIndex, ComponentGeneration>(*)(SceneIndex sceneIndex, CreateCtx& createCtx, Application& app);
-        using ComponentDestroyFn = void(*)(ComponentListHeaderHot& headerHot, ComponentListHeaderCold& headerCold);
-        using PageDestroyFn = void(*)(PageListHeaderHot& headerHot, PageListHeaderCold& headerCold);
+        // Where one scene's lists get their memory from.
+        struct ComponentAllocator
+        {
+            MemoryResource* lists; // Dense blocks, page tables and generations
+            MemoryResource* pages;
+            ReallocationHistogram* histogram; // May be null
+        };
+
+        using ReallocateComponentsFn = void(*)(ComponentListHeaderHot& headerHot, ComponentListHeaderCold& headerCold, wIndex newSlotCapacity, const ComponentAllocator& allocator);
+        using ReallocatePagesFn = void(*)(PageListHeaderHot& headerHot, PageListHeaderCold& headerCold, wIndex newPageCount, const ComponentAllocator& allocator);
+        using ComponentCreateFn = std::pair<ComponentIndex, ComponentGeneration>(*)(SceneIndex sceneIndex, CreateCtx& createCtx, const ComponentAllocator& allocator, Application& app);
+        // Indices are read and written with a byte stride so they can live inside arrays of handles.
+        using ComponentCreateBatchFn = void(*)(SceneIndex sceneIndex, wIndex count, ComponentIndex* outIndices, std::size_t outStride, CreateCtx& createCtx, const ComponentAllocator& allocator, Application& app);
+        // Removal never allocates, the free list reserves room for every slot whenever the slots grow.
+        using ComponentRemoveFn = void(*)(SceneIndex sceneIndex, ComponentIndex componentIndex, CreateCtx& createCtx) noexcept;
+        using ComponentRemoveBatchFn = void(*)(SceneIndex sceneIndex, const ComponentIndex* componentIndices, std::size_t stride, wIndex count, CreateCtx& createCtx) noexcept;
+        // Returns the first appended slot, see InstantiateComponents.
+        using ComponentInstantiateFn = ComponentIndex(*)(SceneIndex prefabSceneIndex, SceneIndex sceneIndex, wIndex count, CreateCtx& createCtx, const ComponentAllocator& allocator);
+        using ComponentSortKeyFn = uint64_t(*)(const void* component) noexcept;
+        using ComponentSortFn = void(*)(SceneIndex sceneIndex, CreateCtx& createCtx);
+        using ComponentSortSlotFn = void(*)(SceneIndex sceneIndex, ComponentIndex componentIndex, CreateCtx& createCtx) noexcept;
+        using ComponentDestroyFn = void(*)(ComponentListHeaderHot& headerHot, ComponentListHeaderCold& headerCold, const ComponentAllocator& allocator) noexcept;
+        using PageDestroyFn = void(*)(PageListHeaderHot& headerHot, PageListHeaderCold& headerCold, const ComponentAllocator& allocator) noexcept;
+
+        struct ChunkedComponentOps
+        {
+            void(*construct)(void* location, Application& app);
+            void(*relocate)(void* destination, void* source) noexcept;
+            void(*destroy)(void* location) noexcept;
+        };
 
         struct ComponentType
         {
-            ComponentType(std::size_t a_size, std::size_t a_alignment, ReallocateComponentsFn a_reallocateComponents, ComponentCreateFn a_create, ComponentDestroyFn a_destroy, wIndex a_listIndex)
-                : size(a_size), alignment(a_alignment), reallocateComponents(a_reallocateComponents), create(a_create), componentDestroy(a_destroy), pageSize(0), listIndex(a_listIndex) {}
+            ComponentType(std::size_t a_size, std::size_t a_alignment, bool a_triviallyCopyable, ReallocateComponentsFn a_reallocateComponents, ComponentCreateFn a_create, ComponentCreateBatchFn a_createBatch, ComponentRemoveFn a_remove, ComponentRemoveBatchFn a_removeBatch, ComponentInstantiateFn a_instantiate, ComponentDestroyFn a_destroy, wIndex a_listIndex)
+                : size(a_size), alignment(a_alignment), triviallyCopyable(a_triviallyCopyable), reallocateComponents(a_reallocateComponents), create(a_create), createBatch(a_createBatch), remove(a_remove), removeBatch(a_removeBatch), instantiate(a_instantiate), sortKey(nullptr), sortList(nullptr), sortComponent(nullptr), componentDestroy(a_destroy), pageSize(0), listIndex(a_listIndex) {}
 
-            ComponentType(std::size_t a_size, std::size_t a_alignment, ReallocatePagesFn a_reallocatePages, ComponentCreateFn a_create, PageDestroyFn a_destroy, wIndex a_listIndex, wIndex a_pageSize)
-                : size(a_size), alignment(a_alignment), reallocatePages(a_reallocatePages), create(a_create), pageDestroy(a_destroy), pageSize(a_pageSize), listIndex(a_listIndex) {}
+            ComponentType(std::size_t a_size, std::size_t a_alignment, bool a_triviallyCopyable, ReallocatePagesFn a_reallocatePages, ComponentCreateFn a_create, ComponentCreateBatchFn a_createBatch, ComponentRemoveFn a_remove, ComponentRemoveBatchFn a_removeBatch, ComponentInstantiateFn a_instantiate, PageDestroyFn a_destroy, wIndex a_listIndex, wIndex a_pageSize)
+                : size(a_size), alignment(a_alignment), triviallyCopyable(a_triviallyCopyable), reallocatePages(a_reallocatePages), create(a_create), createBatch(a_createBatch), remove(a_remove), removeBatch(a_removeBatch), instantiate(a_instantiate), sortKey(nullptr), sortList(nullptr), sortComponent(nullptr), pageDestroy(a_destroy), pageSize(a_pageSize), listIndex(a_listIndex) {}
+
+            ComponentType(std::size_t a_size, std::size_t a_alignment, bool a_triviallyCopyable, const ChunkedComponentOps* a_chunkedOps, wIndex a_listIndex)
+                : size(a_size), alignment(a_alignment), triviallyCopyable(a_triviallyCopyable), chunkedOps(a_chunkedOps), create(nullptr), createBatch(nullptr), remove(nullptr), removeBatch(nullptr), instantiate(nullptr), sortKey(nullptr), sortList(nullptr), sortComponent(nullptr), componentDestroy(nullptr), pageSize(ChunkedStorage), listIndex(a_listIndex) {}
+
+            [[nodiscard]] inline bool IsChunked() const noexcept { return pageSize == ChunkedStorage; }
+            [[nodiscard]] inline bool IsPaged() const noexcept { return pageSize && !IsChunked(); }
 
             std::size_t size;
             std::size_t alignment;
+            bool triviallyCopyable; // Lists of these types can be written to and loaded from snapshots as raw bytes
             union
             {
                 ReallocateComponentsFn reallocateComponents;
                 ReallocatePagesFn reallocatePages;
+                const ChunkedComponentOps* chunkedOps;
             };
             ComponentCreateFn create;
+            ComponentCreateBatchFn createBatch;
+            ComponentRemoveFn remove;
+            ComponentRemoveBatchFn removeBatch;
+            ComponentInstantiateFn instantiate;
+            ComponentSortKeyFn sortKey; // Set for sorted lists only, see SetSortKey
+            ComponentSortFn sortList;
+            ComponentSortSlotFn sortComponent;
             union
             {
                 ComponentDestroyFn componentDestroy;
@@ -176,21 +436,419 @@ namespace wCore
         };
 
         template<typename T, wIndex PageSize, typename GrowthPolicy>
-        static std::pair<ComponentIndex, ComponentGeneration> CreateComponent(SceneIndex sceneIndex, CreateCtx& createCtx, Application& app)
+        static std::pair<ComponentIndex, ComponentGeneration> CreateComponent(SceneIndex sceneIndex, CreateCtx& createCtx, const ComponentAllocator& allocator, Application& app)
         {
-            if (PageSize)
+            const wIndex listIndex = StaticComponentID<T>::GetListIndex();
+            if constexpr (PageSize)
             {
-                const std::size_t sceneStartPageIndex = (sceneIndex - 1) * createCtx.GetCurrentPageListCount();
-                const std::size_t pageListHeaderIndex = sceneStartPageIndex + StaticComponentID<T>::GetListIndex();
-                PageListHeaderHot& heagerHot = createCtx.pageListsHot[pageListHeaderIndex];
-                PageListHeaderCold& heagerCold = createCtx.pageListsCold[pageListHeaderIndex];
+                return EmplacePages<T, PageSize, GrowthPolicy>(createCtx.GetPageListHot(sceneIndex, listIndex), createCtx.GetPageListCold(sceneIndex, listIndex), allocator, app);
             }
             else
             {
-                const std::size_t sceneStartComponentIndex = (sceneIndex - 1) * createCtx.GetCurrentComponentListCount();
-                const std::size_t componentListHeaderIndex = sceneStartComponentIndex + StaticComponentID<T>::GetListIndex();
-                ComponentListHeaderHot& heagerHot = createCtx.componentListsHot[componentListHeaderIndex];
-                ComponentListHeaderCold& heagerCold = createCtx.componentListsCold[componentListHeaderIndex];
+                return EmplaceComponents<T, GrowthPolicy>(createCtx.GetComponentListHot(sceneIndex, listIndex), createCtx.GetComponentListCold(sceneIndex, listIndex), createCtx.changeVersion, allocator, app);
+            }
+        }
+
+        template<typename T>
+        static inline void ConstructComponent(T* location, Application& app)
+        {
+            if constexpr (std::is_constructible_v<T, Application&>)
+            {
+                std::construct_at(location, app);
+            }
+            else
+            {
+                std::construct_at(location);
+            }
+        }
+
+        template<typename T>
+        static inline void ConstructComponents(T* location, wIndex count, Application& app)
+        {
+            if constexpr (std::is_trivially_default_constructible_v<T> && !std::is_constructible_v<T, Application&>)
+            {
+                // Value initialization of a trivial type is all zero
+                std::memset(static_cast<void*>(location), 0, count * sizeof(T));
+            }
+            else
+            {
+                for (T* const end = location + count; location != end; ++location)
+                {
+                    ConstructComponent<T>(location, app);
+                }
+            }
+        }
+
+        template<typename T, wIndex PageSize, typename GrowthPolicy>
+        static void CreateComponents(SceneIndex sceneIndex, wIndex count, ComponentIndex* outIndices, std::size_t outStride, CreateCtx& createCtx, const ComponentAllocator& allocator, Application& app)
+        {
+            if (!count)
+            {
+                return;
+            }
+            const wIndex listIndex = StaticComponentID<T>::GetListIndex();
+            if constexpr (PageSize)
+            {
+                EmplacePagesBatch<T, PageSize, GrowthPolicy>(createCtx.GetPageListHot(sceneIndex, listIndex), createCtx.GetPageListCold(sceneIndex, listIndex), count, reinterpret_cast<std::byte*>(outIndices), outStride, allocator, app);
+            }
+            else
+            {
+                EmplaceComponentsBatch<T, GrowthPolicy>(createCtx.GetComponentListHot(sceneIndex, listIndex), createCtx.GetComponentListCold(sceneIndex, listIndex), count, reinterpret_cast<std::byte*>(outIndices), outStride, createCtx.changeVersion, allocator, app);
+            }
+        }
+
+        static inline void WriteComponentIndex(std::byte* out, std::size_t stride, wIndex position, ComponentIndex componentIndex) noexcept
+        {
+            if (out)
+            {
+                std::memcpy(out + position * stride, &componentIndex, sizeof(ComponentIndex));
+            }
+        }
+
+        [[nodiscard]] static inline ComponentIndex ReadComponentIndex(const std::byte* in, std::size_t stride, wIndex position) noexcept
+        {
+            ComponentIndex componentIndex;
+            std::memcpy(&componentIndex, in + position * stride, sizeof(ComponentIndex));
+            return componentIndex;
+        }
+
+        // Reused slots are taken from the free list first, the rest are appended as one contiguous run.
+        template<typename T, typename GrowthPolicy>
+        static void EmplaceComponentsBatch(ComponentListHeaderHot& headerHot, ComponentListHeaderCold& headerCold, wIndex count, std::byte* out, std::size_t outStride, ChangeVersion changeVersion, const ComponentAllocator& allocator, Application& app)
+        {
+            const wIndex firstPosition = headerCold.denseCount;
+            if (firstPosition + count > headerCold.capacity)
+            {
+                ReallocateComponents<T>(headerHot, headerCold, GrowthPolicy::template Next<T, 0>(firstPosition + count, headerCold.capacity), allocator);
+            }
+
+            ConstructComponents<T>(static_cast<T*>(headerHot.dense) + firstPosition, count, app);
+            StampBlocks(headerHot, firstPosition, firstPosition + count, changeVersion);
+
+            const wIndex reusedCount = std::min(count, headerCold.freeList.Count());
+            wIndex position = firstPosition;
+            for (wIndex i = 0; i < reusedCount; ++i, ++position)
+            {
+                const ComponentIndex componentIndex = headerCold.freeList.Remove();
+                headerHot.slotToDense[componentIndex - 1] = position + 1;
+                headerHot.denseToSlot[position] = componentIndex;
+                WriteComponentIndex(out, outStride, i, componentIndex);
+            }
+
+            const wIndex appendedCount = count - reusedCount;
+            const ComponentIndex firstAppended = headerCold.slotCount + 1;
+            std::memset(static_cast<void*>(headerHot.generations + headerCold.slotCount), 0, appendedCount * sizeof(ComponentGeneration));
+            for (wIndex i = 0; i < appendedCount; ++i, ++position)
+            {
+                const ComponentIndex componentIndex = firstAppended + i;
+                headerHot.slotToDense[componentIndex - 1] = position + 1;
+                headerHot.denseToSlot[position] = componentIndex;
+                WriteComponentIndex(out, outStride, reusedCount + i, componentIndex);
+            }
+
+            headerCold.slotCount += appendedCount;
+            headerCold.denseCount += count;
+        }
+
+        template<typename T, wIndex PageSize, typename GrowthPolicy>
+        static void EmplacePagesBatch(PageListHeaderHot& headerHot, PageListHeaderCold& headerCold, wIndex count, std::byte* out, std::size_t outStride, const ComponentAllocator& allocator, Application& app)
+        {
+            const wIndex reusedCount = std::min(count, headerCold.freeList.Count());
+            const wIndex appendedCount = count - reusedCount;
+            const wIndex requiredSlotCount = headerCold.slotCount + appendedCount;
+            if (requiredSlotCount > headerCold.pageCount * PageSize)
+            {
+                ReallocatePages<T, PageSize>(headerHot, headerCold, GrowthPolicy::template Next<T, PageSize>(wUtils::IntDivCeil(requiredSlotCount, PageSize), headerCold.pageCount), allocator);
+            }
+
+            for (wIndex i = 0; i < reusedCount; ++i)
+            {
+                const ComponentIndex componentIndex = headerCold.freeList.Remove();
+                RestorePage<T, PageSize>(headerHot, componentIndex, allocator);
+                ConstructComponent<T>(GetPageSlot<T, PageSize>(headerHot, componentIndex), app);
+                ++headerHot.generations[componentIndex - 1].generation;
+                WriteComponentIndex(out, outStride, i, componentIndex);
+            }
+
+            // Construct the appended slots one page run at a time
+            ComponentIndex componentIndex = headerCold.slotCount + 1;
+            for (wIndex remaining = appendedCount; remaining;)
+            {
+                const wIndex runCount = std::min(remaining, PageSize - (componentIndex - 1) % PageSize);
+                RestorePage<T, PageSize>(headerHot, componentIndex, allocator);
+                ConstructComponents<T>(GetPageSlot<T, PageSize>(headerHot, componentIndex), runCount, app);
+                remaining -= runCount;
+                componentIndex += runCount;
+            }
+            for (wIndex i = 0; i < appendedCount; ++i)
+            {
+                const ComponentIndex appendedIndex = headerCold.slotCount + 1 + i;
+                ++headerHot.generations[appendedIndex - 1].generation;
+                WriteComponentIndex(out, outStride, reusedCount + i, appendedIndex);
+            }
+            headerCold.slotCount += appendedCount;
+        }
+
+        // Appends count copies of every slot of the prefab list, free slots included, so instance i of the prefab slot s is
+        // the slot first + i * prefab slot count + s - 1 and keeps the generation of s. The free slots join the free list.
+        template<typename T, wIndex PageSize, typename GrowthPolicy>
+        static ComponentIndex InstantiateComponents(SceneIndex prefabSceneIndex, SceneIndex sceneIndex, wIndex count, CreateCtx& createCtx, const ComponentAllocator& allocator)
+        {
+            W_ASSERT(prefabSceneIndex != sceneIndex, "Scene: {} can not be instantiated into itself", sceneIndex);
+            const wIndex listIndex = StaticComponentID<T>::GetListIndex();
+            if constexpr (!std::is_copy_constructible_v<T>)
+            {
+                W_ASSERT(!(PageSize ? createCtx.GetPageListCold(prefabSceneIndex, listIndex).slotCount : createCtx.GetComponentListCold(prefabSceneIndex, listIndex).slotCount), "Component: {} is not copy constructible", wUtils::DebugGetTypeName<T>());
+                return (PageSize ? createCtx.GetPageListCold(sceneIndex, listIndex).slotCount : createCtx.GetComponentListCold(sceneIndex, listIndex).slotCount) + 1;
+            }
+            else if constexpr (PageSize)
+            {
+                return InstantiatePages<T, PageSize, GrowthPolicy>(createCtx.GetPageListHot(prefabSceneIndex, listIndex), createCtx.GetPageListCold(prefabSceneIndex, listIndex), createCtx.GetPageListHot(sceneIndex, listIndex), createCtx.GetPageListCold(sceneIndex, listIndex), count, allocator);
+            }
+            else
+            {
+                return InstantiateDense<T, GrowthPolicy>(createCtx.GetComponentListHot(prefabSceneIndex, listIndex), createCtx.GetComponentListCold(prefabSceneIndex, listIndex), createCtx.GetComponentListHot(sceneIndex, listIndex), createCtx.GetComponentListCold(sceneIndex, listIndex), count, createCtx.changeVersion, allocator);
+            }
+        }
+
+        // Components that store slots of their own list, like Transform::parent, shift them by the first slot of their
+        // instance minus one with a member RemapSlots(ComponentIndex slotOffset), which may be private to ComponentSetup.
+        template<typename T>
+        static constexpr bool HasSlotRemap = requires(T& component, ComponentIndex slotOffset) { component.RemapSlots(slotOffset); };
+
+        template<typename T>
+        static inline void CopyComponents(T* destination, const T* source, wIndex count)
+        {
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                if (count)
+                {
+                    std::memcpy(static_cast<void*>(destination), source, count * sizeof(T));
+                }
+            }
+            else
+            {
+                std::uninitialized_copy_n(source, count, destination);
+            }
+        }
+
+        template<typename T, typename GrowthPolicy>
+        static ComponentIndex InstantiateDense(const ComponentListHeaderHot& prefabHot, const ComponentListHeaderCold& prefabCold, ComponentListHeaderHot& headerHot, ComponentListHeaderCold& headerCold, wIndex count, ChangeVersion changeVersion, const ComponentAllocator& allocator)
+        {
+            const ComponentIndex firstSlot = headerCold.slotCount + 1;
+            const wIndex prefabSlotCount = prefabCold.slotCount;
+            const wIndex prefabDenseCount = prefabCold.denseCount;
+            if (!count || !prefabSlotCount)
+            {
+                return firstSlot;
+            }
+            // The slots are appended, and there are never fewer slots than dense positions
+            const wIndex requiredCapacity = headerCold.slotCount + count * prefabSlotCount;
+            if (requiredCapacity > headerCold.capacity)
+            {
+                ReallocateComponents<T>(headerHot, headerCold, GrowthPolicy::template Next<T, 0>(requiredCapacity, headerCold.capacity), allocator);
+            }
+
+            const wIndex firstPosition = headerCold.denseCount;
+            for (wIndex instance = 0; instance < count; ++instance)
+            {
+                const wIndex slotOffset = firstSlot - 1 + instance * prefabSlotCount;
+                const wIndex positionOffset = firstPosition + instance * prefabDenseCount;
+                CopyComponents<T>(static_cast<T*>(headerHot.dense) + positionOffset, static_cast<const T*>(prefabHot.dense), prefabDenseCount);
+                if constexpr (HasSlotRemap<T>)
+                {
+                    for (wIndex position = 0; position < prefabDenseCount; ++position)
+                    {
+                        static_cast<T*>(headerHot.dense)[positionOffset + position].RemapSlots(slotOffset);
+                    }
+                }
+                std::memcpy(static_cast<void*>(headerHot.generations + slotOffset), prefabHot.generations, prefabSlotCount * sizeof(ComponentGeneration));
+                // 0 marks a free slot and stays 0
+                for (wIndex slotIndex = 0; slotIndex < prefabSlotCount; ++slotIndex)
+                {
+                    const ComponentIndex position = prefabHot.slotToDense[slotIndex];
+                    headerHot.slotToDense[slotOffset + slotIndex] = position ? position + positionOffset : 0;
+                }
+                for (wIndex position = 0; position < prefabDenseCount; ++position)
+                {
+                    headerHot.denseToSlot[positionOffset + position] = prefabHot.denseToSlot[position] + slotOffset;
+                }
+            }
+            StampBlocks(headerHot, firstPosition, firstPosition + count * prefabDenseCount, changeVersion);
+
+            headerCold.slotCount = requiredCapacity;
+            headerCold.denseCount += count * prefabDenseCount;
+            if (prefabSlotCount != prefabDenseCount)
+            {
+                headerCold.freeList.Reserve(headerCold.freeList.Count() + count * (prefabSlotCount - prefabDenseCount));
+                for (ComponentIndex componentIndex = firstSlot; componentIndex <= headerCold.slotCount; ++componentIndex)
+                {
+                    if (!headerHot.slotToDense[componentIndex - 1])
+                    {
+                        headerCold.freeList.Add(componentIndex);
+                    }
+                }
+            }
+            return firstSlot;
+        }
+
+        template<typename T, wIndex PageSize, typename GrowthPolicy>
+        static ComponentIndex InstantiatePages(const PageListHeaderHot& prefabHot, const PageListHeaderCold& prefabCold, PageListHeaderHot& headerHot, PageListHeaderCold& headerCold, wIndex count, const ComponentAllocator& allocator)
+        {
+            const ComponentIndex firstSlot = headerCold.slotCount + 1;
+            const wIndex prefabSlotCount = prefabCold.slotCount;
+            if (!count || !prefabSlotCount)
+            {
+                return firstSlot;
+            }
+            const wIndex requiredSlotCount = headerCold.slotCount + count * prefabSlotCount;
+            if (requiredSlotCount > headerCold.pageCount * PageSize)
+            {
+                ReallocatePages<T, PageSize>(headerHot, headerCold, GrowthPolicy::template Next<T, PageSize>(wUtils::IntDivCeil(requiredSlotCount, PageSize), headerCold.pageCount), allocator);
+            }
+
+            const T* const* prefabPages = static_cast<const T* const*>(prefabHot.data);
+            for (wIndex instance = 0; instance < count; ++instance)
+            {
+                const wIndex slotOffset = firstSlot - 1 + instance * prefabSlotCount;
+                std::memcpy(static_cast<void*>(headerHot.generations + slotOffset), prefabHot.generations, prefabSlotCount * sizeof(ComponentGeneration));
+                // Copy in runs that end at a page boundary of either list
+                for (wIndex slotIndex = 0; slotIndex < prefabSlotCount;)
+                {
+                    const ComponentIndex componentIndex = slotOffset + slotIndex + 1;
+                    const wIndex runCount = std::min({ prefabSlotCount - slotIndex, PageSize - slotIndex % PageSize, PageSize - (componentIndex - 1) % PageSize });
+                    const T* const source = prefabPages[slotIndex / PageSize];
+                    // Pages released by compaction hold no live slot
+                    if (source)
+                    {
+                        RestorePage<T, PageSize>(headerHot, componentIndex, allocator);
+                        if constexpr (std::is_trivially_copyable_v<T>)
+                        {
+                            CopyComponents<T>(GetPageSlot<T, PageSize>(headerHot, componentIndex), source + slotIndex % PageSize, runCount);
+                        }
+                        else
+                        {
+                            for (wIndex i = 0; i < runCount; ++i)
+                            {
+                                if (IsPageSlotAlive(prefabHot.generations[slotIndex + i]))
+                                {
+                                    std::construct_at(GetPageSlot<T, PageSize>(headerHot, componentIndex + i), source[(slotIndex + i) % PageSize]);
+                                }
+                            }
+                        }
+                    }
+                    slotIndex += runCount;
+                }
+                if constexpr (HasSlotRemap<T>)
+                {
+                    for (wIndex slotIndex = 0; slotIndex < prefabSlotCount; ++slotIndex)
+                    {
+                        if (IsPageSlotAlive(prefabHot.generations[slotIndex]))
+                        {
+                            GetPageSlot<T, PageSize>(headerHot, slotOffset + slotIndex + 1)->RemapSlots(slotOffset);
+                        }
+                    }
+                }
+            }
+
+            headerCold.slotCount = requiredSlotCount;
+            const wIndex freeCount = prefabSlotCount - static_cast<wIndex>(std::count_if(prefabHot.generations, prefabHot.generations + prefabSlotCount, [](ComponentGeneration generation) { return IsPageSlotAlive(generation); }));
+            if (freeCount)
+            {
+                headerCold.freeList.Reserve(headerCold.freeList.Count() + count * freeCount);
+                for (ComponentIndex componentIndex = firstSlot; componentIndex <= headerCold.slotCount; ++componentIndex)
+                {
+                    if (!IsPageSlotAlive(headerHot.generations[componentIndex - 1]))
+                    {
+                        headerCold.freeList.Add(componentIndex);
+                    }
+                }
+            }
+            return firstSlot;
+        }
+
+        template<typename T, typename GrowthPolicy>
+        static std::pair<ComponentIndex, ComponentGeneration> EmplaceComponents(ComponentListHeaderHot& headerHot, ComponentListHeaderCold& headerCold, ChangeVersion changeVersion, const ComponentAllocator& allocator, Application& app)
+        {
+            if (headerCold.denseCount == headerCold.capacity)
+            {
+                ReallocateComponents<T>(headerHot, headerCold, GrowthPolicy::template Next<T, 0>(headerCold.denseCount + 1, headerCold.capacity), allocator);
+            }
+
+            const wIndex densePosition = headerCold.denseCount;
+            ConstructComponent<T>(static_cast<T*>(headerHot.dense) + densePosition, app);
+            headerHot.versions[densePosition / ChangeBlockSize] = changeVersion;
+
+            ComponentIndex componentIndex;
+            if (headerCold.freeList.Empty())
+            {
+                componentIndex = ++headerCold.slotCount;
+                std::construct_at(headerHot.generations + componentIndex - 1);
+            }
+            else
+            {
+                componentIndex = headerCold.freeList.Remove();
+            }
+
+            headerHot.slotToDense[componentIndex - 1] = densePosition + 1;
+            headerHot.denseToSlot[densePosition] = componentIndex;
+            ++headerCold.denseCount;
+
+            return { componentIndex, headerHot.generations[componentIndex - 1] };
+        }
+
+        template<typename T, wIndex PageSize, typename GrowthPolicy>
+        static std::pair<ComponentIndex, ComponentGeneration> EmplacePages(PageListHeaderHot& headerHot, PageListHeaderCold& headerCold, const ComponentAllocator& allocator, Application& app)
+        {
+            ComponentIndex componentIndex;
+            if (headerCold.freeList.Empty())
+            {
+                if (headerCold.slotCount == headerCold.pageCount * PageSize)
+                {
+                    ReallocatePages<T, PageSize>(headerHot, headerCold, GrowthPolicy::template Next<T, PageSize>(headerCold.pageCount + 1, headerCold.pageCount), allocator);
+                }
+                componentIndex = ++headerCold.slotCount;
+            }
+            else
+            {
+                componentIndex = headerCold.freeList.Remove();
+            }
+
+            RestorePage<T, PageSize>(headerHot, componentIndex, allocator);
+            ConstructComponent<T>(GetPageSlot<T, PageSize>(headerHot, componentIndex), app);
+            ++headerHot.generations[componentIndex - 1].generation;
+
+            return { componentIndex, headerHot.generations[componentIndex - 1] };
+        }
+
+        template<typename T, wIndex PageSize>
+        [[nodiscard]] static inline T* GetPageSlot(const PageListHeaderHot& headerHot, ComponentIndex componentIndex) noexcept
+        {
+            const wIndex slotIndex = componentIndex - 1;
+            return static_cast<T* const*>(headerHot.data)[slotIndex / PageSize] + slotIndex % PageSize;
+        }
+
+        // Compaction releases pages without live slots, they are allocated again once one of their slots is used.
+        template<typename T, wIndex PageSize>
+        static inline void RestorePage(PageListHeaderHot& headerHot, ComponentIndex componentIndex, const ComponentAllocator& allocator)
+        {
+            T*& page = static_cast<T**>(headerHot.data)[(componentIndex - 1) / PageSize];
+            if (!page)
+            {
+                page = static_cast<T*>(
+                    allocator.pages->Allocate(PageSize * sizeof(T), alignof(T))
+                );
+            }
+        }
+
+        [[nodiscard]] static inline constexpr bool IsPageSlotAlive(ComponentGeneration generation) noexcept { return generation.generation & 1; }
+
+        // Stamps every block overlapping the dense positions [begin, end).
+        static inline void StampBlocks(const ComponentListHeaderHot& headerHot, wIndex begin, wIndex end, ChangeVersion changeVersion) noexcept
+        {
+            if (begin < end)
+            {
+                std::fill(headerHot.versions + begin / ChangeBlockSize, headerHot.versions + (end - 1) / ChangeBlockSize + 1, changeVersion);
             }
         }
 
@@ -244,42 +902,102 @@ namespace wCore
         }*/
 
         template<typename T, wIndex PageSize>
-        static void ReallocatePages(PageListHeaderHot& headerHot, PageListHeaderCold& headerCold, wIndex newPageCount)
+        static void ReallocatePages(PageListHeaderHot& headerHot, PageListHeaderCold& headerCold, wIndex newPageCount, const ComponentAllocator& allocator)
         {
-            T** newMemory = static_cast<T**>(
-                ::operator new(newPageCount * sizeof(T*), std::align_val_t(alignof(T*)))
+            W_PROFILE_ZONE("ComponentSetup::ReallocatePages");
+            if (allocator.histogram)
+            {
+                allocator.histogram->Record(StaticComponentID<T>::GetID(), newPageCount * PageSize);
+            }
+            // Every slot can be freed at once, so removing components never grows the free list
+            headerCold.freeList.Reserve(newPageCount * PageSize);
+            T** newPages = static_cast<T**>(
+                allocator.lists->Allocate(newPageCount * sizeof(T*), alignof(T*))
+            );
+            ComponentGeneration* newGenerations = static_cast<ComponentGeneration*>(
+                allocator.lists->Allocate(newPageCount * PageSize * sizeof(ComponentGeneration), alignof(ComponentGeneration))
             );
 
             if (headerHot.data)
             {
-                std::memcpy(newMemory, headerHot.data, headerCold.pageCount * sizeof(T*));
-                ::operator delete(headerHot.data, std::align_val_t(alignof(T*)));
-                for (wIndex pageIndex = headerCold.pageCount; pageIndex < newPageCount; ++pageIndex)
-                {
-                    newMemory[pageIndex] = static_cast<T*>(
-                        ::operator new(PageSize * sizeof(T), std::align_val_t(alignof(T)))
-                    );
-                }
+                std::memcpy(newPages, headerHot.data, headerCold.pageCount * sizeof(T*));
+                std::memcpy(newGenerations, headerHot.generations, headerCold.pageCount * PageSize * sizeof(ComponentGeneration));
+                allocator.lists->Deallocate(headerHot.data, headerCold.pageCount * sizeof(T*), alignof(T*));
+                allocator.lists->Deallocate(headerHot.generations, headerCold.pageCount * PageSize * sizeof(ComponentGeneration), alignof(ComponentGeneration));
             }
 
-            headerHot.data = newMemory;
+            for (wIndex pageIndex = headerCold.pageCount; pageIndex < newPageCount; ++pageIndex)
+            {
+                newPages[pageIndex] = static_cast<T*>(
+                    allocator.pages->Allocate(PageSize * sizeof(T), alignof(T))
+                );
+            }
+            std::uninitialized_value_construct_n(newGenerations + headerCold.pageCount * PageSize, (newPageCount - headerCold.pageCount) * PageSize);
+
+            headerHot.data = newPages;
+            headerHot.generations = newGenerations;
             headerCold.pageCount = newPageCount;
         }
 
+        struct ComponentBlockLayout
+        {
+            std::size_t slotToDenseOffset;
+            std::size_t denseToSlotOffset;
+            std::size_t generationsOffset;
+            std::size_t versionsOffset;
+            std::size_t size;
+        };
+
+        // One block holds [T x capacity][slotToDense x capacity][denseToSlot x capacity][generations x capacity][versions x capacity / ChangeBlockSize].
         template<typename T>
-        static void ReallocateComponents(ComponentListHeaderHot& headerHot, ComponentListHeaderCold& headerCold, wIndex newCapacity)
+        [[nodiscard]] static inline constexpr ComponentBlockLayout GetComponentBlockLayout(wIndex capacity) noexcept { return GetComponentBlockLayout(sizeof(T), capacity); }
+
+        [[nodiscard]] static inline constexpr ComponentBlockLayout GetComponentBlockLayout(std::size_t componentSize, wIndex capacity) noexcept
         {
-            std::size_t offset = newCapacity * sizeof(T);
+            ComponentBlockLayout layout;
+            std::size_t offset = capacity * componentSize;
 
             offset = wUtils::AlignUp(offset, alignof(ComponentIndex));
-            const std::size_t slotToDenceOffset = offset;
-            offset += newCapacity * sizeof(ComponentIndex);
+            layout.slotToDenseOffset = offset;
+            offset += capacity * sizeof(ComponentIndex);
 
-            constexpr std::size_t alignment = wUtils::Max(alignof(T), alignof(ComponentIndex));
+            layout.denseToSlotOffset = offset;
+            offset += capacity * sizeof(ComponentIndex);
+
+            offset = wUtils::AlignUp(offset, alignof(ComponentGeneration));
+            layout.generationsOffset = offset;
+            offset += capacity * sizeof(ComponentGeneration);
+
+            offset = wUtils::AlignUp(offset, alignof(ChangeVersion));
+            layout.versionsOffset = offset;
+            offset += GetChangeBlockCount(capacity) * sizeof(ChangeVersion);
+
+            layout.size = offset;
+            return layout;
+        }
+
+        template<typename T>
+        static inline constexpr std::size_t ComponentBlockAlignment = std::max(DenseAlignment, wUtils::MaxAlignOf<T, ComponentIndex, ComponentGeneration, ChangeVersion>);
+        [[nodiscard]] static inline constexpr std::size_t GetComponentBlockAlignment(std::size_t componentAlignment) noexcept { return std::max({ DenseAlignment, componentAlignment, alignof(ComponentIndex), alignof(ComponentGeneration), alignof(ChangeVersion) }); }
 
+        template<typename T>
+        static void ReallocateComponents(ComponentListHeaderHot& headerHot, ComponentListHeaderCold& headerCold, wIndex newCapacity, const ComponentAllocator& allocator)
+        {
+            W_PROFILE_ZONE("ComponentSetup::ReallocateComponents");
+            if (allocator.histogram)
+            {
+                allocator.histogram->Record(StaticComponentID<T>::GetID(), newCapacity);
+            }
+            // Every slot can be freed at once, so removing components never grows the free list
+            headerCold.freeList.Reserve(newCapacity);
+            const ComponentBlockLayout layout = GetComponentBlockLayout<T>(newCapacity);
             std::byte* newMemory = static_cast<std::byte*>(
-                ::operator new(offset, std::align_val_t(alignment))
+                allocator.lists->Allocate(layout.size, ComponentBlockAlignment<T>)
             );
+            ComponentIndex* newSlotToDense = reinterpret_cast<ComponentIndex*>(newMemory + layout.slotToDenseOffset);
+            ComponentIndex* newDenseToSlot = reinterpret_cast<ComponentIndex*>(newMemory + layout.denseToSlotOffset);
+            ComponentGeneration* newGenerations = reinterpret_cast<ComponentGeneration*>(newMemory + layout.generationsOffset);
+            ChangeVersion* newVersions = reinterpret_cast<ChangeVersion*>(newMemory + layout.versionsOffset);
 
             if (headerHot.dense)
             {
@@ -293,8 +1011,8 @@ namespace wCore
                 else
                 {
                     T* const begin = static_cast<T*>(headerHot.dense);
-                    T* end = begin + headerCold.denseCount;
-                    T* dst = newMemory;
+                    T* const end = begin + headerCold.denseCount;
+                    T* dst = reinterpret_cast<T*>(newMemory);
                     for (T* src = begin; src != end; ++src, ++dst)
                     {
                         std::construct_at(dst, std::move(*src));
@@ -306,27 +1024,332 @@ namespace wCore
                 }
                 if (headerCold.slotCount)
                 {
-                    std::memcpy(newMemory, headerHot.dense, headerCold.slotCount * sizeof(ComponentIndex));
+                    std::memcpy(newSlotToDense, headerHot.slotToDense, headerCold.slotCount * sizeof(ComponentIndex));
+                    std::memcpy(newGenerations, headerHot.generations, headerCold.slotCount * sizeof(ComponentGeneration));
                 }
-                ::operator delete(headerHot.dense, std::align_val_t(alignment));
+                if (headerCold.denseCount)
+                {
+                    std::memcpy(newDenseToSlot, headerHot.denseToSlot, headerCold.denseCount * sizeof(ComponentIndex));
+                    std::memcpy(newVersions, headerHot.versions, GetChangeBlockCount(headerCold.denseCount) * sizeof(ChangeVersion));
+                }
+                allocator.lists->Deallocate(headerHot.dense, GetComponentBlockLayout<T>(headerCold.capacity).size, ComponentBlockAlignment<T>);
             }
 
             headerHot.dense = newMemory;
-            headerHot.slotToDense = reinterpret_cast<ComponentIndex*>(newMemory + slotToDenceOffset);
+            headerHot.slotToDense = newSlotToDense;
+            headerHot.denseToSlot = newDenseToSlot;
+            headerHot.generations = newGenerations;
+            headerHot.versions = newVersions;
 
             headerCold.capacity = newCapacity;
         }
 
-        /*template<typename T>
-        static void DestroyKnownListUnchecked(ComponentListHeader& header) noexcept
+        template<typename T, wIndex PageSize>
+        static void RemoveComponent(SceneIndex sceneIndex, ComponentIndex componentIndex, CreateCtx& createCtx) noexcept
         {
-            if constexpr (!std::is_trivially_destructible_v<T>)
+            const wIndex listIndex = StaticComponentID<T>::GetListIndex();
+            if constexpr (PageSize)
             {
-                T* const data = header.Data<T>();
-                std::destroy_n(data, header.count);
+                ErasePage<T, PageSize>(createCtx.GetPageListHot(sceneIndex, listIndex), createCtx.GetPageListCold(sceneIndex, listIndex), componentIndex);
             }
-            ::operator delete(header.data, std::align_val_t(alignof(T)));
-        }*/
+            else
+            {
+                EraseComponent<T>(createCtx.GetComponentListHot(sceneIndex, listIndex), createCtx.GetComponentListCold(sceneIndex, listIndex), componentIndex, createCtx.changeVersion);
+            }
+        }
+
+        template<typename T, wIndex PageSize>
+        static void RemoveComponents(SceneIndex sceneIndex, const ComponentIndex* componentIndices, std::size_t stride, wIndex count, CreateCtx& createCtx) noexcept
+        {
+            const wIndex listIndex = StaticComponentID<T>::GetListIndex();
+            const std::byte* in = reinterpret_cast<const std::byte*>(componentIndices);
+            if constexpr (PageSize)
+            {
+                PageListHeaderHot& headerHot = createCtx.GetPageListHot(sceneIndex, listIndex);
+                PageListHeaderCold& headerCold = createCtx.GetPageListCold(sceneIndex, listIndex);
+                for (wIndex i = 0; i < count; ++i)
+                {
+                    ErasePage<T, PageSize>(headerHot, headerCold, ReadComponentIndex(in, stride, i));
+                }
+            }
+            else
+            {
+                ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(sceneIndex, listIndex);
+                ComponentListHeaderCold& headerCold = createCtx.GetComponentListCold(sceneIndex, listIndex);
+                for (wIndex i = 0; i < count; ++i)
+                {
+                    EraseComponent<T>(headerHot, headerCold, ReadComponentIndex(in, stride, i), createCtx.changeVersion);
+                }
+            }
+        }
+
+        template<typename T, wIndex PageSize>
+        static inline void ErasePage(PageListHeaderHot& headerHot, PageListHeaderCold& headerCold, ComponentIndex componentIndex) noexcept
+        {
+            std::destroy_at(GetPageSlot<T, PageSize>(headerHot, componentIndex));
+            ++headerHot.generations[componentIndex - 1].generation;
+            headerCold.freeList.Add(componentIndex);
+        }
+
+        template<typename T>
+        static inline void EraseComponent(ComponentListHeaderHot& headerHot, ComponentListHeaderCold& headerCold, ComponentIndex componentIndex, ChangeVersion changeVersion) noexcept
+        {
+            // Swap the last dense element into the hole
+            T* const dense = static_cast<T*>(headerHot.dense);
+            const wIndex densePosition = headerHot.slotToDense[componentIndex - 1] - 1;
+            const wIndex lastPosition = --headerCold.denseCount;
+            std::destroy_at(dense + densePosition);
+            if (densePosition != lastPosition)
+            {
+                RelocateComponent(dense + densePosition, dense + lastPosition);
+                const ComponentIndex movedIndex = headerHot.denseToSlot[lastPosition];
+                headerHot.denseToSlot[densePosition] = movedIndex;
+                headerHot.slotToDense[movedIndex - 1] = densePosition + 1;
+                // The moved component now sits in another block
+                headerHot.versions[densePosition / ChangeBlockSize] = changeVersion;
+            }
+
+            headerHot.slotToDense[componentIndex - 1] = 0;
+            ++headerHot.generations[componentIndex - 1].generation;
+            headerCold.freeList.Add(componentIndex);
+        }
+
+        template<typename T>
+        static void RemoveComponentOrdered(SceneIndex sceneIndex, ComponentIndex componentIndex, CreateCtx& createCtx) noexcept
+        {
+            RemoveComponentsOrdered<T>(sceneIndex, &componentIndex, sizeof(ComponentIndex), 1, createCtx);
+        }
+
+        // Clears every removed position first, then closes the gaps in one pass from the first of them.
+        template<typename T>
+        static void RemoveComponentsOrdered(SceneIndex sceneIndex, const ComponentIndex* componentIndices, std::size_t stride, wIndex count, CreateCtx& createCtx) noexcept
+        {
+            const wIndex listIndex = StaticComponentID<T>::GetListIndex();
+            const std::byte* in = reinterpret_cast<const std::byte*>(componentIndices);
+            ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(sceneIndex, listIndex);
+            ComponentListHeaderCold& headerCold = createCtx.GetComponentListCold(sceneIndex, listIndex);
+            T* const dense = static_cast<T*>(headerHot.dense);
+
+            wIndex firstPosition = headerCold.denseCount;
+            for (wIndex i = 0; i < count; ++i)
+            {
+                const ComponentIndex componentIndex = ReadComponentIndex(in, stride, i);
+                const wIndex densePosition = headerHot.slotToDense[componentIndex - 1] - 1;
+                std::destroy_at(dense + densePosition);
+                headerHot.denseToSlot[densePosition] = InvalidComponent;
+                headerHot.slotToDense[componentIndex - 1] = 0;
+                ++headerHot.generations[componentIndex - 1].generation;
+                headerCold.freeList.Add(componentIndex);
+                firstPosition = std::min(firstPosition, densePosition);
+            }
+
+            wIndex writePosition = firstPosition;
+            for (wIndex readPosition = firstPosition; readPosition < headerCold.denseCount; ++readPosition)
+            {
+                const ComponentIndex movedIndex = headerHot.denseToSlot[readPosition];
+                if (movedIndex == InvalidComponent)
+                {
+                    continue;
+                }
+                RelocateComponent(dense + writePosition, dense + readPosition);
+                headerHot.denseToSlot[writePosition] = movedIndex;
+                headerHot.slotToDense[movedIndex - 1] = writePosition + 1;
+                ++writePosition;
+            }
+            headerCold.denseCount = writePosition;
+            StampBlocks(headerHot, firstPosition, writePosition, createCtx.changeVersion);
+        }
+
+        template<typename T, auto KeyFn>
+        [[nodiscard]] static uint64_t GetSortKey(const void* component) noexcept { return static_cast<uint64_t>(std::invoke(KeyFn, *static_cast<const T*>(component))); }
+
+        struct SortEntry
+        {
+            uint64_t key;
+            wIndex position; // Where the component that belongs here currently is
+        };
+
+        // A sorted list is one pass over the keys. Otherwise only the part after the sorted prefix is sorted and merged
+        // into it, so components appended to a sorted list cost about as much as sorting them on their own.
+        template<typename T, auto KeyFn>
+        static void SortComponentList(SceneIndex sceneIndex, CreateCtx& createCtx)
+        {
+            W_PROFILE_ZONE("ComponentSetup::SortComponentList");
+            const wIndex listIndex = StaticComponentID<T>::GetListIndex();
+            const ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(sceneIndex, listIndex);
+            const wIndex denseCount = createCtx.GetComponentListCold(sceneIndex, listIndex).denseCount;
+            T* const dense = static_cast<T*>(headerHot.dense);
+
+            wIndex sortedCount = denseCount ? 1 : 0;
+            while (sortedCount < denseCount && GetSortKey<T, KeyFn>(dense + sortedCount - 1) <= GetSortKey<T, KeyFn>(dense + sortedCount))
+            {
+                ++sortedCount;
+            }
+            if (sortedCount == denseCount)
+            {
+                return;
+            }
+
+            std::vector<SortEntry> order(denseCount);
+            for (wIndex position = 0; position < denseCount; ++position)
+            {
+                order[position] = { GetSortKey<T, KeyFn>(dense + position), position };
+            }
+            const auto byKey = [](const SortEntry& a, const SortEntry& b) noexcept { return a.key < b.key; };
+            std::stable_sort(order.begin() + sortedCount, order.end(), byKey);
+            std::inplace_merge(order.begin(), order.begin() + sortedCount, order.end(), byKey);
+
+            // The list was out of order, so at least two components move
+            wIndex begin = 0;
+            while (order[begin].position == begin)
+            {
+                ++begin;
+            }
+            wIndex end = denseCount;
+            while (order[end - 1].position == end - 1)
+            {
+                --end;
+            }
+            PermuteComponents<T>(headerHot, order.data(), begin, end);
+            StampBlocks(headerHot, begin, end, createCtx.changeVersion);
+        }
+
+        // Moves every component in [begin, end) to its entry in order, one cycle of the permutation at a time.
+        template<typename T>
+        static void PermuteComponents(const ComponentListHeaderHot& headerHot, SortEntry* order, wIndex begin, wIndex end) noexcept
+        {
+            T* const dense = static_cast<T*>(headerHot.dense);
+            alignas(T) std::byte heldStorage[sizeof(T)];
+            T* const held = reinterpret_cast<T*>(heldStorage);
+            for (wIndex start = begin; start < end; ++start)
+            {
+                if (order[start].position == start)
+                {
+                    continue;
+                }
+                // Lift the component out of start and pull every other component of the cycle into the hole it leaves
+                RelocateComponent(held, dense + start);
+                const ComponentIndex heldIndex = headerHot.denseToSlot[start];
+                wIndex position = start;
+                while (order[position].position != start)
+                {
+                    const wIndex source = order[position].position;
+                    RelocateComponent(dense + position, dense + source);
+                    headerHot.denseToSlot[position] = headerHot.denseToSlot[source];
+                    order[position].position = position;
+                    position = source;
+                }
+                RelocateComponent(dense + position, held);
+                headerHot.denseToSlot[position] = heldIndex;
+                order[position].position = position;
+            }
+            for (wIndex position = begin; position < end; ++position)
+            {
+                headerHot.slotToDense[headerHot.denseToSlot[position] - 1] = position + 1;
+            }
+        }
+
+        // Binary searches the place of one component in an otherwise sorted list and rotates the range in between.
+        template<typename T, auto KeyFn>
+        static void SortComponentSlot(SceneIndex sceneIndex, ComponentIndex componentIndex, CreateCtx& createCtx) noexcept
+        {
+            const wIndex listIndex = StaticComponentID<T>::GetListIndex();
+            const ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(sceneIndex, listIndex);
+            const wIndex denseCount = createCtx.GetComponentListCold(sceneIndex, listIndex).denseCount;
+            T* const dense = static_cast<T*>(headerHot.dense);
+            ComponentIndex* const denseToSlot = headerHot.denseToSlot;
+
+            const wIndex position = headerHot.slotToDense[componentIndex - 1] - 1;
+            const uint64_t key = GetSortKey<T, KeyFn>(dense + position);
+            // Behind the equal keys before it, ahead of the equal keys after it, so a component that did not move stays
+            const wIndex before = std::upper_bound(dense, dense + position, key, [](uint64_t k, const T& component) noexcept { return k < GetSortKey<T, KeyFn>(&component); }) - dense;
+            const wIndex after = std::lower_bound(dense + position + 1, dense + denseCount, key, [](const T& component, uint64_t k) noexcept { return GetSortKey<T, KeyFn>(&component) < k; }) - dense;
+
+            wIndex rangeBegin = position;
+            wIndex rangeEnd = position + 1;
+            if (before < position)
+            {
+                rangeBegin = before;
+                std::rotate(dense + before, dense + position, dense + position + 1);
+                std::rotate(denseToSlot + before, denseToSlot + position, denseToSlot + position + 1);
+            }
+            else if (after > position + 1)
+            {
+                rangeEnd = after;
+                std::rotate(dense + position, dense + position + 1, dense + after);
+                std::rotate(denseToSlot + position, denseToSlot + position + 1, denseToSlot + after);
+            }
+            else
+            {
+                return;
+            }
+            for (wIndex densePosition = rangeBegin; densePosition < rangeEnd; ++densePosition)
+            {
+                headerHot.slotToDense[denseToSlot[densePosition] - 1] = densePosition + 1;
+            }
+            StampBlocks(headerHot, rangeBegin, rangeEnd, createCtx.changeVersion);
+        }
+
+        template<typename T>
+        static inline void RelocateComponent(T* destination, T* source) noexcept
+        {
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                std::memcpy(static_cast<void*>(destination), static_cast<const void*>(source), sizeof(T));
+            }
+            else
+            {
+                std::construct_at(destination, std::move(*source));
+                std::destroy_at(source);
+            }
+        }
+
+        template<typename T>
+        static void DestroyComponentList(ComponentListHeaderHot& headerHot, ComponentListHeaderCold& headerCold, const ComponentAllocator& allocator) noexcept
+        {
+            if (headerHot.dense)
+            {
+                std::destroy_n(static_cast<T*>(headerHot.dense), headerCold.denseCount);
+                allocator.lists->Deallocate(headerHot.dense, GetComponentBlockLayout<T>(headerCold.capacity).size, ComponentBlockAlignment<T>);
+            }
+            headerCold.freeList.Destroy();
+        }
+
+        template<typename T, wIndex PageSize>
+        static void DestroyPageList(PageListHeaderHot& headerHot, PageListHeaderCold& headerCold, const ComponentAllocator& allocator) noexcept
+        {
+            if (headerHot.data)
+            {
+                T** const pages = static_cast<T**>(headerHot.data);
+                if constexpr (!std::is_trivially_destructible_v<T>)
+                {
+                    for (ComponentIndex componentIndex = ComponentIndexStart; componentIndex <= headerCold.slotCount; ++componentIndex)
+                    {
+                        if (IsPageSlotAlive(headerHot.generations[componentIndex - 1]))
+                        {
+                            std::destroy_at(GetPageSlot<T, PageSize>(headerHot, componentIndex));
+                        }
+                    }
+                }
+                for (wIndex pageIndex = 0; pageIndex < headerCold.pageCount; ++pageIndex)
+                {
+                    if (pages[pageIndex])
+                    {
+                        allocator.pages->Deallocate(pages[pageIndex], PageSize * sizeof(T), alignof(T));
+                    }
+                }
+                allocator.lists->Deallocate(headerHot.data, headerCold.pageCount * sizeof(T*), alignof(T*));
+                allocator.lists->Deallocate(headerHot.generations, headerCold.pageCount * PageSize * sizeof(ComponentGeneration), alignof(ComponentGeneration));
+            }
+            headerCold.freeList.Destroy();
+        }
+
+        template<typename T>
+        static inline constexpr ChunkedComponentOps ChunkedOps = {
+            [](void* location, Application& app) { ConstructComponent<T>(static_cast<T*>(location), app); },
+            [](void* destination, void* source) noexcept { std::construct_at(static_cast<T*>(destination), std::move(*static_cast<T*>(source))); std::destroy_at(static_cast<T*>(source)); },
+            [](void* location) noexcept { std::destroy_at(static_cast<T*>(location)); }
+        };
 
         template<typename T>
         class StaticComponentID
@@ -334,6 +1357,7 @@ namespace wCore
         public:
             static inline ComponentTypeIndex GetID() { return s_id; }
             static inline wIndex GetListIndex() { return s_listIndex; }
+            static inline wIndex GetPageSize() { return s_pageSize; }
             static inline void Set(ComponentTypeIndex id, wIndex listIndex, wIndex pageSize) { s_id = id; s_listIndex = listIndex; s_pageSize = pageSize; }
 
         private:
@@ -346,9 +1370,18 @@ namespace wCore
 
         std::vector<std::string> m_names;
         std::vector<ComponentType> m_types;
+        std::vector<ComponentTypeIndex> m_chunkedTypes;
         wIndex m_componentListCount;
+        wIndex m_pageListCount;
+        std::function<void(ComponentTypeIndex)> m_typeAdded; // Lets the owning ComponentSystem give scenes that already exist the new list
 
         friend class ComponentSystem;
+        friend class ArchetypeStorage;
+        friend class SceneSnapshot;
+        friend class StagedScene;
+        friend class TransformHierarchy;
+        template<typename... Descs>
+        friend class ComponentRegistry;
     };
 }
 
@@ -2,10 +2,18 @@
 #define TUNGSTEN_CORE_COMPONENT_SYSTEM_HPP
 
 #include "TungstenCore/ComponentSetup.hpp"
+#include "TungstenCore/ComponentView.hpp"
+#include "TungstenCore/ArchetypeStorage.hpp"
+#include "TungstenCore/EntityTable.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <span>
 
 namespace wCore
 {
+    class StagedScene;
+
     class SceneGeneration
     {
     public:
@@ -21,7 +29,10 @@ namespace wCore
 
     struct SceneHandle
     {
-        SceneHandle(SceneIndex a_sceneIndex, SceneGeneration a_generation)
+        constexpr SceneHandle() noexcept
+            : sceneIndex(InvalidScene), generation() {}
+
+        constexpr SceneHandle(SceneIndex a_sceneIndex, SceneGeneration a_generation)
             : sceneIndex(a_sceneIndex), generation(a_generation) {}
 
         SceneIndex sceneIndex;
@@ -31,7 +42,10 @@ namespace wCore
     template<typename T>
     struct ComponentHandle
     {
-        ComponentHandle(SceneHandle a_sceneHandle, ComponentIndex a_componentIndex, ComponentGeneration a_generation)
+        constexpr ComponentHandle() noexcept
+            : sceneHandle(), componentIndex(InvalidComponent), generation() {}
+
+        constexpr ComponentHandle(SceneHandle a_sceneHandle, ComponentIndex a_componentIndex, ComponentGeneration a_generation)
             : sceneHandle(a_sceneHandle), componentIndex(a_componentIndex), generation(a_generation) {}
 
         SceneHandle sceneHandle;
@@ -41,7 +55,7 @@ namespace wCore
 
     struct ComponentHandleAny
     {
-        ComponentHandleAny(ComponentTypeIndex a_componentTypeIndex, SceneHandle a_sceneHandle, ComponentIndex a_componentIndex, ComponentGeneration a_generation)
+        constexpr ComponentHandleAny(ComponentTypeIndex a_componentTypeIndex, SceneHandle a_sceneHandle, ComponentIndex a_componentIndex, ComponentGeneration a_generation)
             : componentTypeIndex(a_componentTypeIndex), sceneHandle(a_sceneHandle), componentIndex(a_componentIndex), generation(a_generation) {}
 
         ComponentTypeIndex componentTypeIndex;
@@ -50,14 +64,118 @@ namespace wCore
         ComponentGeneration generation;
     };
 
+    // Published to the EventBus with ComponentSystem::Config::componentEvents by single and batch creates and destroys,
+    // through entities too. InstantiatePrefab, CloneScene, SceneSnapshot::Load and CommitStagedScene publish a created
+    // event for every component they add. DestroyScene, archetype entities and ComponentRegistry publish nothing.
+    // Destroyed handles carry the generation the component had, so they match handles that were stored. Publishing
+    // can allocate, so the destroys that publish are not noexcept.
+    struct ComponentCreatedEvent
+    {
+        ComponentHandleAny componentHandle;
+    };
+
+    struct ComponentDestroyedEvent
+    {
+        ComponentHandleAny componentHandle;
+    };
+
+    struct ArchetypeEntityHandle
+    {
+        constexpr ArchetypeEntityHandle(SceneHandle a_sceneHandle, ArchetypeEntityIndex a_entityIndex, ComponentGeneration a_generation)
+            : sceneHandle(a_sceneHandle), entityIndex(a_entityIndex), generation(a_generation) {}
+
+        SceneHandle sceneHandle;
+        ArchetypeEntityIndex entityIndex;
+        ComponentGeneration generation;
+    };
+
+    struct EntityHandle
+    {
+        constexpr EntityHandle() noexcept
+            : sceneHandle(), entityIndex(InvalidEntity), generation() {}
+
+        constexpr EntityHandle(SceneHandle a_sceneHandle, EntityIndex a_entityIndex, ComponentGeneration a_generation)
+            : sceneHandle(a_sceneHandle), entityIndex(a_entityIndex), generation(a_generation) {}
+
+        SceneHandle sceneHandle;
+        EntityIndex entityIndex;
+        ComponentGeneration generation;
+    };
+
+    // Where ComponentSystem::InstantiatePrefab put its instances. Every instance repeats the slots of the prefab list, so
+    // instance i of the prefab slot s is the slot firstSlot + i * prefabSlotCount + s - 1, with the generation of s.
+    struct PrefabInstances
+    {
+        struct Range
+        {
+            ComponentIndex firstSlot;
+            wIndex prefabSlotCount;
+        };
+
+        template<typename T>
+        [[nodiscard]] inline ComponentHandle<T> Get(ComponentHandle<T> prefabComponent, wIndex instance) const noexcept
+        {
+            const Range& range = ranges[componentSetup->GetComponentTypeIndex<T>() - 1];
+            W_ASSERT(prefabComponent.componentIndex != InvalidComponent && prefabComponent.componentIndex <= range.prefabSlotCount && instance < count, "Prefab Component: {} instance {} out of range", prefabComponent.componentIndex, instance);
+            return ComponentHandle<T>(sceneHandle, range.firstSlot + instance * range.prefabSlotCount + prefabComponent.componentIndex - 1, prefabComponent.generation);
+        }
+
+        // Entities repeat the same way, their links point at the copies of the prefab entity's components.
+        [[nodiscard]] inline EntityHandle GetEntity(EntityHandle prefabEntity, wIndex instance) const noexcept
+        {
+            W_ASSERT(prefabEntity.entityIndex != InvalidEntity && prefabEntity.entityIndex <= prefabEntitySlotCount && instance < count, "Prefab Entity: {} instance {} out of range", prefabEntity.entityIndex, instance);
+            return EntityHandle(sceneHandle, firstEntity + instance * prefabEntitySlotCount + prefabEntity.entityIndex - 1, prefabEntity.generation);
+        }
+
+        const ComponentSetup* componentSetup;
+        SceneHandle sceneHandle;
+        wIndex count;
+        std::vector<Range> ranges; // Per ComponentTypeIndex, empty ranges for ChunkedStorage
+        EntityIndex firstEntity; // InvalidEntity if the prefab scene has no entities
+        wIndex prefabEntitySlotCount;
+    };
+
+    // Bytes reserved count every allocation a list holds, including slot indices, generations and page tables.
+    // Bytes used only count the live components.
+    struct ComponentListStats
+    {
+        wIndex liveCount;
+        wIndex capacity; // Components that fit without reallocating
+        wIndex slotCount; // Slots ever handed out, live or free. 0 for ChunkedStorage
+        wIndex pageCount; // Paged lists only
+        wIndex residentPageCount; // Pages not released by ComponentSystem::Compact
+        wIndex freeListCount;
+        std::size_t bytesReserved;
+        std::size_t bytesUsed;
+    };
+
+    struct SceneStats
+    {
+        wIndex componentCount; // Over all types, archetype entities count once per component
+        std::size_t bytesReserved; // Sum over the lists
+        std::size_t bytesUsed;
+        std::size_t arenaBytesReserved; // Blocks of the scene arena, which include dead list allocations. 0 without Config::sceneArenas
+    };
+
     class ComponentSystem
     {
     public:
+        struct Config
+        {
+            MemoryResource* memoryResource = nullptr; // Upstream for everything below, nullptr uses the global heap
+            bool sceneArenas = false; // Give every scene a SceneArena for its lists, destroying a scene rewinds it
+            std::size_t sceneArenaBlockSize = 64 * 1024;
+            bool pagePool = false; // Recycle pages of paged lists and archetype chunks across scenes
+            bool concurrentLookup = false; // Allow TryGet from other threads, freed lists are kept until ReclaimRetiredMemory
+            bool componentEvents = false; // Publish ComponentCreatedEvent and ComponentDestroyedEvent to the EventBus of the Application
+        };
+
         ComponentSystem(Application& app) noexcept;
+        ComponentSystem(Application& app, const Config& config) noexcept;
         ~ComponentSystem() noexcept;
 
-        ComponentSystem(const ComponentSetup&) = delete;
-        ComponentSystem& operator=(const ComponentSetup&) = delete;
+        ComponentSystem(const ComponentSystem&) = delete;
+        ComponentSystem& operator=(const ComponentSystem&) = delete;
 
         // Scenes
         void ReserveScenes(wIndex minCapacity);
@@ -65,8 +183,20 @@ namespace wCore
 
         [[nodiscard]] inline SceneHandle CreateScene() { return CreateScene(""); }
         [[nodiscard]] SceneHandle CreateScene(std::string_view name);
-        void DestroyScene(SceneIndex sceneIndex) noexcept;
-        [[nodiscard]] inline bool SceneExists(SceneHandle sceneHandle) const noexcept { return sceneHandle.generation == m_sceneGenerations[sceneHandle.sceneIndex]; };
+        void DestroyScene(SceneHandle sceneHandle) noexcept;
+        [[nodiscard]] inline bool SceneExists(SceneHandle sceneHandle) const noexcept { return sceneHandle.sceneIndex != InvalidScene && sceneHandle.sceneIndex <= m_sceneSlotCount && sceneHandle.generation == m_sceneGenerations[sceneHandle.sceneIndex - 1]; };
+
+        // Creates a scene with a copy of every component at the same slot and generation, so a handle into the source
+        // scene addresses the copy once its SceneHandle is swapped. Lists of trivially copyable types are copied with
+        // memcpy, others element by element. Entities keep their index and generation too. ChunkedStorage components
+        // are not copied, the source must have none.
+        [[nodiscard]] SceneHandle CloneScene(SceneHandle sceneHandle, std::string_view name = "");
+        // Appends count copies of the components of the prefab scene to the target scene, one bulk copy per list and
+        // instance. Free slots of the target are not reused, so every instance is one run of slots per list. Sorted lists are
+        // merged back into order afterwards, which moves dense positions but not slots. Components that store slots of their
+        // own list, like the parents of Transforms, are remapped into their instance, see ComponentSetup::HasSlotRemap.
+        // Each Transform instance is appended as its own run of root subtrees, so the hierarchy order holds.
+        PrefabInstances InstantiatePrefab(SceneHandle prefabSceneHandle, SceneHandle sceneHandle, wIndex count);
 
         //inline const Scene& GetScene(uint32_t sceneIndex) const { return m_scenes[sceneIndex - 1]; }
 /*
@@ -74,235 +204,702 @@ namespace wCore
         inline void SetSceneName(SceneIndex sceneIndex, std::string_view name) { m_sceneData[sceneIndex - 1].name = name; }
         inline void SetSceneName(SceneIndex sceneIndex, std::string&& name) noexcept { m_sceneData[sceneIndex - 1].name = std::move(name); }
 
-        [[nodiscard]] inline wIndex GetSceneCount() const noexcept { return m_sceneData.size() - m_sceneFreeList.size(); }
-        [[nodiscard]] inline wIndex GetSceneSlotCount() const noexcept { return m_sceneData.size(); }
-        [[nodiscard]] inline wIndex GetSceneSlotCapacity() const noexcept { return m_sceneData.capacity(); }
         */
+        [[nodiscard]] inline wIndex GetSceneCount() const noexcept { return m_sceneSlotCount - m_sceneFreeList.Count(); }
+        [[nodiscard]] inline wIndex GetSceneSlotCount() const noexcept { return m_sceneSlotCount; }
+        [[nodiscard]] inline wIndex GetSceneSlotCapacity() const noexcept { return m_sceneSlotCapacity; }
         [[nodiscard]] inline wIndex GetSceneFreeListCount() const noexcept { return m_sceneFreeList.Count(); }
         [[nodiscard]] inline wIndex GetSceneFreeListCapacity() const noexcept { return m_sceneFreeList.Capacity(); }
 
         // Components
-        //inline void ReserveComponents(wIndex sceneIndex, wIndex minCapacity) { ReserveKnownList<Component>(m_componentLists[GetSceneStartListIndex(sceneIndex) + ComponentListOffset], minCapacity); }
-
         template<typename T>
-        inline void ReserveComponents(SceneIndex sceneIndex, wIndex minCapacity) { ReserveKnownList<T>(GetComponentListHeader<T>(sceneIndex), minCapacity); }
+        inline void ReserveComponents(SceneIndex sceneIndex, wIndex minCapacity) { ReserveComponents(m_componentSetup.GetComponentTypeIndex<T>(), sceneIndex, minCapacity); }
 
         template<typename T>
         [[nodiscard]] ComponentHandle<T> CreateComponent(SceneHandle sceneHandle)
         {
-            auto [componentIndex, generation] = ComponentSetup::CreateComponent(sceneHandle.sceneIndex, m_createCtx, m_app)
-            return ComponentHandle(sceneHandle, componentIndex, generation);
+            const ComponentHandleAny handle = CreateComponent(m_componentSetup.GetComponentTypeIndex<T>(), sceneHandle);
+            return ComponentHandle<T>(handle.sceneHandle, handle.componentIndex, handle.generation);
         }
 
-        /*template<typename T, typename... Args>
-        [[nodiscard]] ComponentHandle<T> EmplaceComponent(SceneHandle sceneHandle, Args&&... args)
+        // Returns nullptr if the handle is stale. The pointer is invalidated by any structural change to the list.
+        template<typename T>
+        [[nodiscard]] T* GetComponent(ComponentHandle<T> componentHandle) noexcept
         {
-            auto [componentIndex, generation] = ComponentSetup::CreateComponent(sceneHandle.sceneIndex, m_createCtx, m_app)
-            return ComponentHandle(sceneHandle, componentIndex, generation);
-        }*/
+            if (!SceneExists(componentHandle.sceneHandle))
+            {
+                return nullptr;
+            }
+            return FindComponent<T>(m_componentSetup, m_createCtx, componentHandle.sceneHandle.sceneIndex, componentHandle.componentIndex, componentHandle.generation);
+        }
 
-        /*template<typename T>
-        [[nodiscard]] T& GetComponent(wIndex sceneIndex, ComponentIndex componentIndex)
+        // Creates count components with at most one reallocation. outHandles may be null.
+        template<typename T>
+        void CreateComponents(SceneHandle sceneHandle, wIndex count, ComponentHandle<T>* outHandles)
         {
-            const std::size_t sceneStartListIndex = GetSceneStartListIndex(sceneIndex);
-            const wIndex listIndex = IndexKnownList<Component>(m_componentLists[sceneStartListIndex + ComponentListOffset], componentIndex - 1);
-            return IndexKnownList<T>(m_componentLists[sceneStartListIndex + GetComponentListOffset<T>()], listIndex);
+            CreateComponents(m_componentSetup.GetComponentTypeIndex<T>(), sceneHandle, count, outHandles ? &outHandles->componentIndex : nullptr, sizeof(ComponentHandle<T>));
+            if (outHandles)
+            {
+                const ComponentGeneration* generations = GetGenerations<T>(sceneHandle.sceneIndex);
+                for (ComponentHandle<T>* handle = outHandles; handle != outHandles + count; ++handle)
+                {
+                    handle->sceneHandle = sceneHandle;
+                    handle->generation = generations[handle->componentIndex - 1];
+                }
+            }
         }
 
+        // Handles must be unique. Consecutive handles of the same scene are removed in one call.
         template<typename T>
-        [[nodiscard]] const T& GetComponent(wIndex sceneIndex, ComponentIndex componentIndex) const
+        void DestroyComponents(std::span<const ComponentHandle<T>> componentHandles)
         {
-            const std::size_t sceneStartListIndex = GetSceneStartListIndex(sceneIndex);
-            const wIndex listIndex = IndexKnownList<Component>(m_componentLists[sceneStartListIndex + ComponentListOffset], componentIndex - 1);
-            return IndexKnownList<T>(m_componentLists[sceneStartListIndex + GetComponentListOffset<T>()], listIndex);
+            for (const ComponentHandle<T>& componentHandle : componentHandles)
+            {
+                W_ASSERT(ComponentExists(componentHandle), "Component: {} of type {} does not exist", componentHandle.componentIndex, m_componentSetup.GetComponentTypeName<T>());
+            }
+
+            const ComponentTypeIndex componentTypeIndex = m_componentSetup.GetComponentTypeIndex<T>();
+            for (wIndex runBegin = 0; runBegin < componentHandles.size();)
+            {
+                const SceneHandle sceneHandle = componentHandles[runBegin].sceneHandle;
+                wIndex runEnd = runBegin + 1;
+                while (runEnd < componentHandles.size() && componentHandles[runEnd].sceneHandle.sceneIndex == sceneHandle.sceneIndex)
+                {
+                    ++runEnd;
+                }
+                DestroyComponents(componentTypeIndex, sceneHandle, &componentHandles[runBegin].componentIndex, runEnd - runBegin, sizeof(ComponentHandle<T>));
+                runBegin = runEnd;
+            }
         }
 
-        [[nodiscard]] inline wIndex GetComponentCount(uint32_t sceneIndex) const { return GetKnownListCount<Component>(m_componentLists[GetSceneStartListIndex(sceneIndex) + ComponentListOffset]); }
-        [[nodiscard]] inline wIndex GetComponentCapacity(uint32_t sceneIndex) const { return GetKnownListCapacity<Component>(m_componentLists[GetSceneStartListIndex(sceneIndex) + ComponentListOffset]); }
+        template<typename T>
+        inline void DestroyComponent(ComponentHandle<T> componentHandle) { DestroyComponent(ComponentHandleAny(m_componentSetup.GetComponentTypeIndex<T>(), componentHandle.sceneHandle, componentHandle.componentIndex, componentHandle.generation)); }
 
-        [[nodiscard]] inline wIndex GetComponentNameCount(uint32_t sceneIndex) const { return GetKnownListCount<std::string>(m_componentLists[GetSceneStartListIndex(sceneIndex) + ComponentListOffset]); }
-        [[nodiscard]] inline wIndex GetComponentNameCapacity(uint32_t sceneIndex) const { return GetKnownListCapacity<std::string>(m_componentLists[GetSceneStartListIndex(sceneIndex) + ComponentListOffset]); }*/
+        // Stamps the block of a component written through GetComponent. Paged components carry no stamps.
+        template<typename T>
+        void MarkChanged(ComponentHandle<T> componentHandle) noexcept
+        {
+            W_ASSERT(ComponentExists(componentHandle), "Component: {} of type {} does not exist", componentHandle.componentIndex, m_componentSetup.GetComponentTypeName<T>());
+            if (!m_componentSetup.IsPaged<T>())
+            {
+                const ComponentSetup::ComponentListHeaderHot& headerHot = m_createCtx.GetComponentListHot(componentHandle.sceneHandle.sceneIndex, ComponentSetup::StaticComponentID<T>::GetListIndex());
+                headerHot.versions[(headerHot.slotToDense[componentHandle.componentIndex - 1] - 1) / ChangeBlockSize] = m_createCtx.changeVersion;
+            }
+        }
 
+        // Sorted lists, see ComponentSetup::SetSortKey.
+        // Restores the order after components were created or their keys changed, for example once per frame before
+        // extraction. Costs one pass over the keys if nothing changed.
         template<typename T>
-        [[nodiscard]] inline wIndex GetComponentCount(wIndex sceneIndex) const { return GetKnownListCount<T>(GetComponentListHeader<T>(sceneIndex)); }
+        inline void SortComponents(SceneHandle sceneHandle) { SortComponents(m_componentSetup.GetComponentTypeIndex<T>(), sceneHandle); }
 
+        // Moves one component to its place after it was created or its key changed, the rest of the list must be in
+        // order. Only the dense range between the old and the new position is rotated.
         template<typename T>
-        [[nodiscard]] inline wIndex GetComponentCapacity(wIndex sceneIndex) const { return GetKnownListCapacity<T>(GetComponentListHeader<T>(sceneIndex)); }
+        inline void SortComponent(ComponentHandle<T> componentHandle) noexcept { SortComponent(ComponentHandleAny(m_componentSetup.GetComponentTypeIndex<T>(), componentHandle.sceneHandle, componentHandle.componentIndex, componentHandle.generation)); }
 
-        // API
-        [[nodiscard]] inline ComponentSetup& GetComponentSetup() { return m_componentSetup; };
-        [[nodiscard]] inline const ComponentSetup& GetComponentSetup() const { return m_componentSetup; }
+        // Calls fn(uint64_t key, std::span<T> run) for every run of components with equal keys, in key order.
+        template<typename T, typename Fn>
+        void EachSortedRun(SceneHandle sceneHandle, Fn&& fn)
+        {
+            const ComponentSetup::ComponentSortKeyFn sortKey = m_componentSetup.m_types[m_componentSetup.GetComponentTypeIndex<T>() - 1].sortKey;
+            W_ASSERT(sortKey, "Component: {} has no sort key", m_componentSetup.GetComponentTypeName<T>());
+            const std::span<T> components = GetDenseSpan<T>(sceneHandle);
+            for (wIndex runBegin = 0; runBegin < components.size();)
+            {
+                const uint64_t key = sortKey(&components[runBegin]);
+                wIndex runEnd = runBegin + 1;
+                while (runEnd < components.size() && sortKey(&components[runEnd]) == key)
+                {
+                    ++runEnd;
+                }
+                fn(key, components.subspan(runBegin, runEnd - runBegin));
+                runBegin = runEnd;
+            }
+        }
 
-        // Internal
-        void ReserveComponents(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex, wIndex minCapacity);
-        [[nodiscard]] ComponentHandleAny CreateComponent(ComponentTypeIndex componentTypeIndex, SceneHandle scene);
+        template<typename T>
+        [[nodiscard]] inline bool ComponentExists(ComponentHandle<T> componentHandle) const noexcept { return ComponentExists(ComponentHandleAny(m_componentSetup.GetComponentTypeIndex<T>(), componentHandle.sceneHandle, componentHandle.componentIndex, componentHandle.generation)); }
 
-        [[nodiscard]] inline wIndex GetComponentCount(ComponentTypeIndex componentTypeIndex, wIndex sceneIndex) const;
-        [[nodiscard]] inline wIndex GetComponentCapacity(ComponentTypeIndex componentTypeIndex, wIndex sceneIndex) const;
+        template<typename T>
+        [[nodiscard]] inline wIndex GetComponentCount(SceneIndex sceneIndex) const { return GetComponentCount(m_componentSetup.GetComponentTypeIndex<T>(), sceneIndex); }
 
-    private:
-        static constexpr wIndex InitialCapacity = 8;
-        static inline constexpr wIndex CalculateNextCapacity(wIndex current) noexcept
+        template<typename T>
+        [[nodiscard]] inline wIndex GetComponentCapacity(SceneIndex sceneIndex) const { return GetComponentCapacity(m_componentSetup.GetComponentTypeIndex<T>(), sceneIndex); }
+
+        // Views
+        // A view reads the dense arrays directly and is invalidated by any structural change to the lists it covers.
+        template<typename... Ts>
+        [[nodiscard]] ComponentView<Ts...> View(SceneHandle sceneHandle) noexcept
         {
-            if (current)
-            {
-                return current * 2;
-            }
-            return InitialCapacity;
+            W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+            return ComponentView<Ts...>({ GetDenseListView<std::remove_const_t<Ts>>(sceneHandle.sceneIndex)... }, m_createCtx.changeVersion);
         }
 
-        struct SceneData
+        template<typename... Ts, typename Fn>
+        inline void Each(SceneHandle sceneHandle, Fn&& fn) { View<Ts...>(sceneHandle).Each(std::forward<Fn>(fn)); }
+
+        // Visits the components of the first type whose block was written at or after since, see ComponentView::EachChanged.
+        template<typename T, typename... Ts, typename Fn>
+        inline void EachChanged(SceneHandle sceneHandle, ChangeVersion since, Fn&& fn) { View<T, Ts...>(sceneHandle).template EachChanged<T>(since, std::forward<Fn>(fn)); }
+
+        template<typename T>
+        [[nodiscard]] inline std::span<T> GetDenseSpan(SceneHandle sceneHandle) noexcept { return View<T>(sceneHandle).template GetSpan<T>(); }
+
+        // Archetypes
+        template<typename... Ts>
+        [[nodiscard]] inline ArchetypeEntityHandle CreateArchetypeEntity(SceneHandle sceneHandle) { return CreateArchetypeEntity(sceneHandle, m_componentSetup.GetArchetypeSignature<Ts...>()); }
+
+        [[nodiscard]] ArchetypeEntityHandle CreateArchetypeEntity(SceneHandle sceneHandle, ArchetypeSignature signature);
+        void DestroyArchetypeEntity(ArchetypeEntityHandle entityHandle) noexcept;
+        [[nodiscard]] bool ArchetypeEntityExists(ArchetypeEntityHandle entityHandle) const noexcept;
+
+        template<typename T>
+        [[nodiscard]] T* GetArchetypeComponent(ArchetypeEntityHandle entityHandle) noexcept
         {
-            uint32_t nameIndex;
-        };
-/*
+            W_ASSERT(ArchetypeEntityExists(entityHandle), "ArchetypeEntity: {} does not exist", entityHandle.entityIndex);
+            return static_cast<T*>(GetArchetypeStorage(entityHandle.sceneHandle.sceneIndex)->GetComponent(entityHandle.entityIndex, ComponentSetup::StaticComponentID<T>::GetListIndex()));
+        }
+
         template<typename T>
-        static void ReserveKnownList(ComponentSetup::ListHeader& header, wIndex num)
+        T& AddArchetypeComponent(ArchetypeEntityHandle entityHandle)
         {
-            if (num > header.Capacity<T>() - header.Begin<T>())
-            {
-                ComponentSetup::ReallocateKnownList<T>(header, num);
-            }
+            W_ASSERT(ArchetypeEntityExists(entityHandle), "ArchetypeEntity: {} does not exist", entityHandle.entityIndex);
+            ArchetypeStorage* storage = GetArchetypeStorage(entityHandle.sceneHandle.sceneIndex);
+            storage->ChangeSignature(entityHandle.entityIndex, storage->GetSignature(entityHandle.entityIndex) | m_componentSetup.GetArchetypeSignature<T>(), m_componentSetup, m_app);
+            return *GetArchetypeComponent<T>(entityHandle);
         }
 
         template<typename T>
-        static wIndex AddToKnownList(ComponentSetup::ListHeader& header, T& value)
+        void RemoveArchetypeComponent(ArchetypeEntityHandle entityHandle)
         {
-            T* end = header.End<T>();
-            const T* const begin = header.Data<T>();
-            const T* const capacity = header.Capacity<T>();
+            W_ASSERT(ArchetypeEntityExists(entityHandle), "ArchetypeEntity: {} does not exist", entityHandle.entityIndex);
+            ArchetypeStorage* storage = GetArchetypeStorage(entityHandle.sceneHandle.sceneIndex);
+            storage->ChangeSignature(entityHandle.entityIndex, storage->GetSignature(entityHandle.entityIndex) & ~m_componentSetup.GetArchetypeSignature<T>(), m_componentSetup, m_app);
+        }
+
+        // fn is called with an ArchetypeChunk<Ts...> for every non empty chunk of every archetype containing all of Ts.
+        template<typename... Ts, typename Fn>
+        void EachChunk(SceneHandle sceneHandle, Fn&& fn)
+        {
+            W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+            const ArchetypeStorage* storage = GetArchetypeStorage(sceneHandle.sceneIndex);
+            if (!storage)
+            {
+                return;
+            }
 
-            if (header.count == header.capacity)
+            const ArchetypeSignature required = m_componentSetup.GetArchetypeSignature<Ts...>();
+            for (const ArchetypeStorage::Archetype& archetype : storage->GetArchetypes())
             {
-                if (&value >= data && &value < data + header.count)
+                if ((archetype.signature & required) == required)
                 {
-                    T tmp = value;
-                    ReallocateKnownList<T>(header, CalculateNextCapacity(header.count + 1, header.capacity));
-                    end = header.End<T>();
-                    std::construct_at(end, std::move_if_noexcept(tmp));
-                    header.end = end + 1;
-                    return oldCount;
+                    const std::array<wIndex, sizeof...(Ts)> columnIndices = { archetype.GetColumnIndex(ComponentSetup::StaticComponentID<Ts>::GetListIndex())... };
+                    for (wIndex chunkIndex = 0; chunkIndex < archetype.GetUsedChunkCount(); ++chunkIndex)
+                    {
+                        fn(MakeArchetypeChunk<Ts...>(archetype, chunkIndex, columnIndices, std::index_sequence_for<Ts...>()));
+                    }
                 }
-
-                ReallocateKnownList<T>(header, CalculateNextCapacity(header.count + 1, header.capacity));
-                end = header.End<T>();
             }
+        }
+
+        template<typename... Ts, typename Fn>
+        inline void EachChunked(SceneHandle sceneHandle, Fn&& fn) { EachChunk<Ts...>(sceneHandle, [&fn](const ArchetypeChunk<Ts...>& chunk) { chunk.Each(fn); }); }
 
-            std::construct_at(end, value);
+        // Entities
+        // An entity links at most one component of every dense or paged type in its scene, see EntityTable. Its components
+        // are ordinary components: views and handles see them as usual, and destroying one directly unlinks it.
+        [[nodiscard]] EntityHandle CreateEntity(SceneHandle sceneHandle);
+        // Destroys the entity and every component linked to it.
+        void DestroyEntity(EntityHandle entityHandle);
+        [[nodiscard]] bool EntityExists(EntityHandle entityHandle) const noexcept;
 
-            header.end = end + 1;
-            return oldCount;
+        template<typename T>
+        ComponentHandle<T> AddComponent(EntityHandle entityHandle)
+        {
+            const ComponentHandleAny handle = AddComponent(m_componentSetup.GetComponentTypeIndex<T>(), entityHandle);
+            return ComponentHandle<T>(handle.sceneHandle, handle.componentIndex, handle.generation);
         }
 
         template<typename T>
-        static wIndex AddToKnownList(ComponentSetup::ListHeader& header, T&& value)
+        inline void RemoveComponent(EntityHandle entityHandle) { RemoveComponent(m_componentSetup.GetComponentTypeIndex<T>(), entityHandle); }
+
+        template<typename T>
+        [[nodiscard]] inline bool HasComponent(EntityHandle entityHandle) const noexcept
         {
-            T* end = header.End<T>();
-            const T* const begin = header.Begin<T>();
-            const T* const capacity = header.Capacity<T>();
-            const wIndex oldCount = end - begin;
+            W_ASSERT(EntityExists(entityHandle), "Entity: {} does not exist", entityHandle.entityIndex);
+            return GetEntityTable(entityHandle.sceneHandle.sceneIndex)->Has(entityHandle.entityIndex, m_componentSetup.GetComponentTypeIndex<T>());
+        }
 
-            if (end == capacity)
+        // Returns nullptr if the entity has no T. The pointer is invalidated by any structural change to the list.
+        template<typename T>
+        [[nodiscard]] T* GetComponent(EntityHandle entityHandle) noexcept
+        {
+            W_ASSERT(EntityExists(entityHandle), "Entity: {} does not exist", entityHandle.entityIndex);
+            const EntityTable& entities = *GetEntityTable(entityHandle.sceneHandle.sceneIndex);
+            const ComponentTypeIndex componentTypeIndex = m_componentSetup.GetComponentTypeIndex<T>();
+            if (!entities.Has(entityHandle.entityIndex, componentTypeIndex))
             {
-                if (&value >= begin && &value < end)
-                {
-                    T tmp = std::move(value);
-                    ReallocateKnownList<T>(header, CalculateNextCapacity(oldCount + 1, capacity - begin));
-                    end = header.End<T>();
-                    std::construct_at(end, std::move_if_noexcept(tmp));
-                    header.end = end + 1;
-                    return oldCount;
-                }
-
-                ReallocateKnownList<T>(header, CalculateNextCapacity(oldCount + 1, capacity - begin));
-                end = header.End<T>();
+                return nullptr;
             }
-
-            std::construct_at(end, std::move_if_noexcept(value));
-
-            header.end = end + 1;
-            return oldCount;
+            return GetLinkedComponent<T>(entityHandle.sceneHandle.sceneIndex, entities.GetSlot(entityHandle.entityIndex, componentTypeIndex));
         }
 
+        // Returns the default handle if the entity has no T.
         template<typename T>
-        static void DestroyKnownList(ComponentSetup::ListHeader& header) noexcept(std::is_nothrow_destructible_v<T>) noexcept
+        [[nodiscard]] ComponentHandle<T> GetComponentHandle(EntityHandle entityHandle) const noexcept
         {
-            if (!ComponentSetup::IsSentinel<T>(header.begin))
+            W_ASSERT(EntityExists(entityHandle), "Entity: {} does not exist", entityHandle.entityIndex);
+            const EntityTable& entities = *GetEntityTable(entityHandle.sceneHandle.sceneIndex);
+            const ComponentTypeIndex componentTypeIndex = m_componentSetup.GetComponentTypeIndex<T>();
+            if (!entities.Has(entityHandle.entityIndex, componentTypeIndex))
             {
-                ComponentSetup::DestroyKnownListUnchecked<T>(header);
+                return ComponentHandle<T>();
             }
+            const ComponentIndex componentIndex = entities.GetSlot(entityHandle.entityIndex, componentTypeIndex);
+            return ComponentHandle<T>(entityHandle.sceneHandle, componentIndex, GetGenerations<T>(entityHandle.sceneHandle.sceneIndex)[componentIndex - 1]);
         }
 
+        // Returns the default handle if the component belongs to no entity.
         template<typename T>
-        [[nodiscard]] inline static wIndex GetKnownListCount(ComponentSetup::ListHeader& header) noexcept { return header.End<T>() - header.Begin<T>(); }
+        [[nodiscard]] EntityHandle GetEntity(ComponentHandle<T> componentHandle) const noexcept
+        {
+            W_ASSERT(ComponentExists(componentHandle), "Component: {} of type {} does not exist", componentHandle.componentIndex, m_componentSetup.GetComponentTypeName<T>());
+            const EntityTable* entities = GetEntityTable(componentHandle.sceneHandle.sceneIndex);
+            const EntityIndex entityIndex = entities ? entities->GetOwner(m_componentSetup.GetComponentTypeIndex<T>(), componentHandle.componentIndex) : InvalidEntity;
+            if (entityIndex == InvalidEntity)
+            {
+                return EntityHandle();
+            }
+            return EntityHandle(componentHandle.sceneHandle, entityIndex, entities->GetGeneration(entityIndex));
+        }
 
-        template<typename T>
-        [[nodiscard]] inline static wIndex GetKnownListCapacity(ComponentSetup::ListHeader& header) noexcept { return header.Capacity<T>() - header.Begin<T>(); }
+        // Calls fn(EntityHandle, T&, Ts&...) for every entity that has all of the types. The dense list of T drives the
+        // iteration, so pass the rarest type first. The others are found through the entity and may be paged. Like a
+        // view, non const dense types are stamped with the current ChangeVersion, use const types to only read.
+        template<typename T, typename... Ts, typename Fn>
+        void EachEntity(SceneHandle sceneHandle, Fn&& fn)
+        {
+            W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+            const SceneIndex sceneIndex = sceneHandle.sceneIndex;
+            const EntityTable* entities = GetEntityTable(sceneIndex);
+            if (!entities)
+            {
+                return;
+            }
+            const DenseListView list = GetDenseListView<std::remove_const_t<T>>(sceneIndex);
+            const ComponentTypeIndex componentTypeIndex = m_componentSetup.GetComponentTypeIndex<std::remove_const_t<T>>();
+            if constexpr (!std::is_const_v<T>)
+            {
+                std::fill_n(list.versions, GetChangeBlockCount(list.denseCount), m_createCtx.changeVersion);
+            }
+            for (wIndex position = 0; position < list.denseCount; ++position)
+            {
+                const EntityIndex entityIndex = entities->GetOwner(componentTypeIndex, list.denseToSlot[position]);
+                if (entityIndex == InvalidEntity || !(entities->Has(entityIndex, ComponentSetup::StaticComponentID<std::remove_const_t<Ts>>::GetID()) && ...))
+                {
+                    continue;
+                }
+                fn(EntityHandle(sceneHandle, entityIndex, entities->GetGeneration(entityIndex)), static_cast<T*>(list.dense)[position], *GetLinkedComponent<Ts, true>(sceneIndex, entities->GetSlot(entityIndex, ComponentSetup::StaticComponentID<std::remove_const_t<Ts>>::GetID()))...);
+            }
+        }
 
-        template<typename T>
-        [[nodiscard]] inline static T& IndexKnownList(ComponentSetup::ListHeader& header, wIndex index) noexcept { return header.Begin<T>()[index]; }
+        // Staging
+        // A StagedScene is filled on any thread and then committed into a free scene slot by copying its list headers.
+        // Create, commit and discard on the owning thread. Staged lists allocate from the upstream MemoryResource, or the
+        // scene arena when enabled, never from the PagePool, so the upstream resource must be thread safe. The heap is.
+        // No component types may be added while a StagedScene is alive, filling it reads the type table.
+        [[nodiscard]] std::unique_ptr<StagedScene> CreateStagedScene();
+        [[nodiscard]] SceneHandle CommitStagedScene(StagedScene& stagedScene);
+        void DiscardStagedScene(StagedScene& stagedScene) noexcept;
+
+        // Concurrent lookup
+        // With Config::concurrentLookup any number of threads may TryGet inside a ConcurrentReadGuard while the owning
+        // thread creates and destroys components. Readers never lock: they validate against a sequence the writer bumps
+        // around structural changes and retry, and lists freed by a reallocation are only returned to the upstream
+        // resource by ReclaimRetiredMemory once no reader that may have seen them is left. The returned pointer stays
+        // dereferenceable until the guard ends, but if the writer destroys or moves the component meanwhile it can show
+        // another component. Writing through it from a reader is only safe if nothing else writes that component.
+        // ChunkedStorage components can not be looked up concurrently.
+        class ConcurrentReadGuard
+        {
+        public:
+            explicit ConcurrentReadGuard(const ComponentSystem& componentSystem) noexcept
+                : m_epochMemory(componentSystem.m_epochMemory.get())
+            {
+                W_ASSERT(m_epochMemory, "ComponentSystem was not created with Config::concurrentLookup");
+                m_epochMemory->EnterRead();
+            }
+            ~ConcurrentReadGuard() noexcept { m_epochMemory->ExitRead(); }
 
-        template<typename T>
-        [[nodiscard]] inline static const T& IndexKnownList(const ComponentSetup::ListHeader& header, wIndex index) noexcept { return header.Begin<T>()[index]; }
+            ConcurrentReadGuard(const ConcurrentReadGuard&) = delete;
+            ConcurrentReadGuard& operator=(const ConcurrentReadGuard&) = delete;
 
-        template<typename T>
-        [[nodiscard]] inline static T& KnownListAt(ComponentSetup::ListHeader& header, wIndex index) { W_ASSERT(index < GetKnownListCount<T>(header), "KnownList Index {} out of Range! KnownList Count: {}", index, GetKnownListCount<T>(header)); return Index<T>(header, index); }
+        private:
+            EpochMemoryResource* m_epochMemory;
+        };
 
+        // Returns nullptr if the handle is stale. Call inside a ConcurrentReadGuard.
         template<typename T>
-        [[nodiscard]] inline static const T& KnownListAt(const ComponentSetup::ListHeader& header, wIndex index) { W_ASSERT(index < GetKnownListCount<T>(header), "KnownList Index {} out of Range! KnownList Count: {}", index, GetKnownListCount<T>(header)); return Index<T>(header, index); }
-
+        [[nodiscard]] inline T* TryGet(ComponentHandle<T> componentHandle) const noexcept { return static_cast<T*>(TryGet(ComponentHandleAny(m_componentSetup.GetComponentTypeIndex<T>(), componentHandle.sceneHandle, componentHandle.componentIndex, componentHandle.generation))); }
+        [[nodiscard]] void* TryGet(ComponentHandleAny componentHandle) const noexcept;
+
+        // Called by the owning thread, Application does so once per frame.
+        inline void ReclaimRetiredMemory() noexcept { if (m_epochMemory) { m_epochMemory->Reclaim(); } }
+        [[nodiscard]] inline bool IsConcurrentLookupEnabled() const noexcept { return m_epochMemory != nullptr; }
+
+        // Change detection
+        // Writes are stamped with the current version. Application advances it once per frame.
+        [[nodiscard]] inline ChangeVersion GetChangeVersion() const noexcept { return m_createCtx.changeVersion; }
+        inline ChangeVersion AdvanceChangeVersion() noexcept { return ++m_createCtx.changeVersion; }
+
+        // Memory
+        [[nodiscard]] inline MemoryResource& GetMemoryResource() const noexcept { return *m_memoryResource; }
+        [[nodiscard]] inline PagePool* GetPagePool() noexcept { return m_pagePool.get(); }
+        [[nodiscard]] inline SceneArena* GetSceneArena(SceneIndex sceneIndex) const noexcept { return m_sceneData[sceneIndex - 1].arena; }
+
+        // Returns the arenas of destroyed scenes and the cached pages to the upstream resource.
+        void ReleaseUnusedMemory() noexcept;
+
+        // Compaction
+        // Shrinks dense lists to their slot count, releases pages without live slots and trims the page tables and the
+        // scene block. Slots and generations are kept, so handles stay valid, but pointers into moved lists do not.
+        // Lists in a scene arena only release their pages, a smaller block would just take more of the arena.
+        // Returns the bytes given back. Every pass that finishes, including CompactScene and a budgeted pass, then calls
+        // ReleaseUnusedMemory.
+        std::size_t Compact();
+        std::size_t CompactScene(SceneHandle sceneHandle);
+        // Compacts one list after another until the budget is spent and continues there on the next call, so a pass can
+        // be spread over frames. Returns true when a pass has finished.
+        bool Compact(std::chrono::microseconds budget);
+
+        // Statistics
         template<typename T>
-        [[nodiscard]] inline static std::span<T> GetSpanFromKnownList(ComponentSetup::ListHeader& header) noexcept { return { header.Begin<T>(), header.End<T>() }; }
+        [[nodiscard]] inline ComponentListStats GetComponentListStats(SceneIndex sceneIndex) const noexcept { return GetComponentListStats(m_componentSetup.GetComponentTypeIndex<T>(), sceneIndex); }
+        [[nodiscard]] ComponentListStats GetComponentListStats(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex) const noexcept;
+        [[nodiscard]] SceneStats GetSceneStats(SceneIndex sceneIndex) const noexcept;
 
+        // Reallocations of every list of a type since the first scene was created, see ReallocationHistogram.
         template<typename T>
-        [[nodiscard]] inline static std::span<const T> GetSpanFromKnownList(const ComponentSetup::ListHeader& header) noexcept { return { header.Begin<T>(), header.End<T>() }; }
-*/
-        void ReallocateScenes(wIndex newCapacity);
-        void DeleteSceneContent(std::size_t sceneStartPtrIndex);
+        [[nodiscard]] inline ReallocationHistogram::Buckets GetReallocationHistogram() const noexcept { return GetReallocationHistogram(m_componentSetup.GetComponentTypeIndex<T>()); }
+        [[nodiscard]] ReallocationHistogram::Buckets GetReallocationHistogram(ComponentTypeIndex componentTypeIndex) const noexcept;
+        inline void ResetReallocationHistogram() noexcept { if (m_reallocationHistogram) { m_reallocationHistogram->Reset(); } }
+
+        // API
+        [[nodiscard]] inline ComponentSetup& GetComponentSetup() { return m_componentSetup; };
+        [[nodiscard]] inline const ComponentSetup& GetComponentSetup() const { return m_componentSetup; }
+
+        // Internal
+        void ReserveComponents(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex, wIndex minCapacity);
+        [[nodiscard]] ComponentHandleAny CreateComponent(ComponentTypeIndex componentTypeIndex, SceneHandle scene);
+        void DestroyComponent(ComponentHandleAny componentHandle);
+        void CreateComponents(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle, wIndex count, ComponentIndex* outIndices, std::size_t outStride = sizeof(ComponentIndex));
+        void DestroyComponents(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle, const ComponentIndex* componentIndices, wIndex count, std::size_t stride = sizeof(ComponentIndex));
+        [[nodiscard]] bool ComponentExists(ComponentHandleAny componentHandle) const noexcept;
+        void SortComponents(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle);
+        [[nodiscard]] ComponentHandleAny AddComponent(ComponentTypeIndex componentTypeIndex, EntityHandle entityHandle);
+        void RemoveComponent(ComponentTypeIndex componentTypeIndex, EntityHandle entityHandle);
+        void SortComponent(ComponentHandleAny componentHandle) noexcept;
+
+        [[nodiscard]] wIndex GetComponentCount(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex) const;
+        [[nodiscard]] wIndex GetComponentCapacity(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex) const;
+
+    private:
+        friend class SceneSnapshot;
+        friend class StagedScene;
+        friend class TransformHierarchy;
+        template<typename... Descs>
+        friend class ComponentRegistry;
+        template<typename T, auto BoundsFn>
+        friend class SpatialGrid;
+
+        static constexpr wIndex InitialCapacity = 8;
+        static inline constexpr wIndex CalculateNextCapacity(wIndex current) noexcept
+        {
+            if (current)
+            {
+                return current * 2;
+            }
+            return InitialCapacity;
+        }
+
+        // Marks a structural change for concurrent readers, the outermost scope bumps the sequence to odd and back to even.
+        class WriteScope
+        {
+        public:
+            explicit WriteScope(ComponentSystem& componentSystem) noexcept
+                : m_componentSystem(componentSystem.m_epochMemory && !componentSystem.m_writeDepth++ ? &componentSystem : nullptr)
+            {
+                if (m_componentSystem)
+                {
+                    m_componentSystem->m_sequence.store(m_componentSystem->m_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_release);
+                }
+            }
+            ~WriteScope() noexcept
+            {
+                if (m_componentSystem)
+                {
+                    m_componentSystem->m_sequence.store(m_componentSystem->m_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+                    m_componentSystem->m_writeDepth = 0;
+                }
+            }
+
+            WriteScope(const WriteScope&) = delete;
+            WriteScope& operator=(const WriteScope&) = delete;
+
+        private:
+            ComponentSystem* m_componentSystem; // Null for nested scopes and without concurrent lookup
+        };
+
+        // Reads a field the writer may be changing, the result is only meaningful once the sequence is validated.
+        template<typename U>
+        [[nodiscard]] static inline U LoadRacy(const U& value) noexcept { return std::atomic_ref<U>(const_cast<U&>(value)).load(std::memory_order_relaxed); }
+        [[nodiscard]] bool ValidateSequence(uint64_t sequence) const noexcept;
+        [[nodiscard]] void* LoadComponent(const ComponentSetup::ComponentType& type, ComponentHandleAny componentHandle, uint64_t sequence) const noexcept;
+        // Finds the headers of a list in the scene block or in its late list, both null if the sequence changed meanwhile.
+        template<typename Hot, typename Cold>
+        [[nodiscard]] std::pair<const Hot*, const Cold*> LoadListHeaders(Hot* const& listsHot, Cold* const& listsCold, void** const& lateLists, const wIndex& listCount, const wIndex& lateListCount, SceneIndex sceneIndex, wIndex listIndex, uint64_t sequence) const noexcept
+        {
+            const Hot* hot = LoadRacy(listsHot);
+            const Cold* cold = LoadRacy(listsCold);
+            const wIndex stride = LoadRacy(listCount);
+            void* const* late = LoadRacy(lateLists);
+            const wIndex lateCount = LoadRacy(lateListCount);
+            const wIndex lateSceneCapacity = LoadRacy(m_createCtx.lateSceneCapacity);
+            if (!ValidateSequence(sequence) || listIndex >= stride + lateCount)
+            {
+                return {};
+            }
+            if (listIndex < stride)
+            {
+                const std::size_t headerIndex = (sceneIndex - 1) * stride + listIndex;
+                return { hot + headerIndex, cold + headerIndex };
+            }
+            void* const lateList = LoadRacy(late[listIndex - stride]);
+            if (!ValidateSequence(sequence))
+            {
+                return {};
+            }
+            return { &ComponentSetup::CreateCtx::GetLateHot<Hot>(lateList, sceneIndex), &ComponentSetup::CreateCtx::GetLateCold<Hot, Cold>(lateList, lateSceneCapacity, sceneIndex) };
+        }
+
+        struct SceneData
+        {
+            uint32_t nameIndex;
+            ArchetypeStorage* archetypes; // Created on first use
+            EntityTable* entities; // Created on first use
+            SceneArena* arena; // Only with Config::sceneArenas
+        };
 
-        void DestroyComponentList(std::size_t sceneStartPtrIndex, ComponentTypeIndex componentTypeIndex);
+        [[nodiscard]] inline ComponentSetup::ComponentAllocator GetComponentAllocator(SceneIndex sceneIndex) const noexcept
+        {
+            SceneArena* arena = m_sceneData[sceneIndex - 1].arena;
+            return { arena ? static_cast<MemoryResource*>(arena) : m_memoryResource, m_pageMemoryResource, m_reallocationHistogram.get() };
+        }
 
-        // Component
-        // std::string names
-        [[nodiscard]] inline std::size_t GetSceneStartListIndex(SceneIndex sceneIndex) const noexcept { return (sceneIndex - 1) * m_currentComponentListCount; }
+        [[nodiscard]] inline ArchetypeStorage* GetArchetypeStorage(SceneIndex sceneIndex) const noexcept { return m_sceneData[sceneIndex - 1].archetypes; }
+        [[nodiscard]] inline EntityTable* GetEntityTable(SceneIndex sceneIndex) const noexcept { return m_sceneData[sceneIndex - 1].entities; }
 
-        [[nodiscard]] static constexpr std::size_t GetComponentListOffset(ComponentTypeIndex componentTypeIndex) noexcept { return componentTypeIndex - 1; }
-        [[nodiscard]] inline std::size_t GetComponentListIndex(SceneIndex sceneIndex, ComponentTypeIndex componentTypeIndex) const noexcept { return GetSceneStartListIndex(sceneIndex) + GetComponentListOffset(componentTypeIndex); }
-        //[[nodiscard]] inline ComponentSetup::ComponentListHeader& GetComponentListHeader(SceneIndex sceneIndex, ComponentTypeIndex componentTypeIndex) noexcept { return m_componentLists[GetComponentListIndex(sceneIndex, componentTypeIndex)]; }
-        //[[nodiscard]] inline const ComponentSetup::ComponentListHeader& GetComponentListHeader(SceneIndex sceneIndex, ComponentTypeIndex componentTypeIndex) const noexcept { return m_componentLists[GetComponentListIndex(sceneIndex, componentTypeIndex)]; }
+        // Handle of a live slot of a dense or paged list, for the component events.
+        [[nodiscard]] ComponentHandleAny GetSlotHandle(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle, ComponentIndex componentIndex) const noexcept;
+        // Publishes a ComponentCreatedEvent for every live slot of the list from firstSlot on, after a bulk copy.
+        void PublishCreatedSlots(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle, ComponentIndex firstSlot);
+        void PublishCreatedScene(SceneHandle sceneHandle);
+
+        // The component in a slot an entity links, which is always live. With Stamp, a non const dense component stamps its block.
+        template<typename T, bool Stamp = false>
+        [[nodiscard]] T* GetLinkedComponent(SceneIndex sceneIndex, ComponentIndex componentIndex) const noexcept
+        {
+            using U = std::remove_const_t<T>;
+            const wIndex slotIndex = componentIndex - 1;
+            const wIndex listIndex = ComponentSetup::StaticComponentID<U>::GetListIndex();
+            if (m_componentSetup.IsPaged<U>())
+            {
+                const wIndex pageSize = ComponentSetup::StaticComponentID<U>::GetPageSize();
+                return static_cast<U* const*>(m_createCtx.GetPageListHot(sceneIndex, listIndex).data)[slotIndex / pageSize] + slotIndex % pageSize;
+            }
+            const ComponentSetup::ComponentListHeaderHot& headerHot = m_createCtx.GetComponentListHot(sceneIndex, listIndex);
+            const wIndex densePosition = headerHot.slotToDense[slotIndex] - 1;
+            if constexpr (Stamp && !std::is_const_v<T>)
+            {
+                headerHot.versions[densePosition / ChangeBlockSize] = m_createCtx.changeVersion;
+            }
+            return static_cast<U*>(headerHot.dense) + densePosition;
+        }
+
+        template<typename... Ts, std::size_t... Is>
+        [[nodiscard]] static inline ArchetypeChunk<Ts...> MakeArchetypeChunk(const ArchetypeStorage::Archetype& archetype, wIndex chunkIndex, const std::array<wIndex, sizeof...(Ts)>& columnIndices, std::index_sequence<Is...>) noexcept
+        {
+            return ArchetypeChunk<Ts...>(archetype.GetEntities(chunkIndex), { archetype.GetColumn(chunkIndex, columnIndices[Is])... }, archetype.GetChunkRowCount(chunkIndex));
+        }
 
         template<typename T>
-        [[nodiscard]] inline std::size_t GetComponentListOffset() const noexcept { return GetComponentListOffset(m_componentSetup.GetComponentTypeIndex<T>()); }
+        [[nodiscard]] DenseListView GetDenseListView(SceneIndex sceneIndex) noexcept
+        {
+            W_ASSERT(!m_componentSetup.IsPaged<T>(), "Component: {} uses paged storage and can not be viewed as a dense list", m_componentSetup.GetComponentTypeName<T>());
+            const wIndex listIndex = ComponentSetup::StaticComponentID<T>::GetListIndex();
+            const ComponentSetup::ComponentListHeaderHot& headerHot = m_createCtx.GetComponentListHot(sceneIndex, listIndex);
+            const ComponentSetup::ComponentListHeaderCold& headerCold = m_createCtx.GetComponentListCold(sceneIndex, listIndex);
+            return { headerHot.dense, headerHot.slotToDense, headerHot.denseToSlot, headerHot.versions, headerCold.denseCount, headerCold.slotCount };
+        }
 
         template<typename T>
-        [[nodiscard]] inline std::size_t GetComponentListIndex(SceneIndex sceneIndex) const noexcept { return GetSceneStartListIndex(sceneIndex) + GetComponentListOffset<T>(); }
-/*
+        [[nodiscard]] const ComponentGeneration* GetGenerations(SceneIndex sceneIndex) const noexcept { return GetGenerations<T>(m_componentSetup, m_createCtx, sceneIndex); }
+
         template<typename T>
-        [[nodiscard]] inline ComponentSetup::ListHeader& GetComponentListHeader(SceneIndex sceneIndex) noexcept { return m_componentLists[GetComponentListIndex<T>(sceneIndex)]; }
+        [[nodiscard]] static const ComponentGeneration* GetGenerations(const ComponentSetup& componentSetup, const ComponentSetup::CreateCtx& createCtx, SceneIndex sceneIndex) noexcept
+        {
+            if (componentSetup.IsPaged<T>())
+            {
+                return createCtx.GetPageListHot(sceneIndex, ComponentSetup::StaticComponentID<T>::GetListIndex()).generations;
+            }
+            return createCtx.GetComponentListHot(sceneIndex, ComponentSetup::StaticComponentID<T>::GetListIndex()).generations;
+        }
 
+        // Returns nullptr if the slot is out of range or its generation differs. Shared with StagedScene.
         template<typename T>
-        [[nodiscard]] inline const ComponentSetup::ListHeader& GetComponentListHeader(SceneIndex sceneIndex) const noexcept { return m_componentLists[GetComponentListIndex<T>(sceneIndex)]; }
-*/
+        [[nodiscard]] static T* FindComponent(const ComponentSetup& componentSetup, const ComponentSetup::CreateCtx& createCtx, SceneIndex sceneIndex, ComponentIndex componentIndex, ComponentGeneration generation) noexcept
+        {
+            if (componentIndex == InvalidComponent)
+            {
+                return nullptr;
+            }
+            const wIndex slotIndex = componentIndex - 1;
+            const wIndex listIndex = ComponentSetup::StaticComponentID<T>::GetListIndex();
+            if (componentSetup.IsPaged<T>())
+            {
+                const ComponentSetup::PageListHeaderHot& headerHot = createCtx.GetPageListHot(sceneIndex, listIndex);
+                if (componentIndex > createCtx.GetPageListCold(sceneIndex, listIndex).slotCount || !(headerHot.generations[slotIndex] == generation))
+                {
+                    return nullptr;
+                }
+                const wIndex pageSize = ComponentSetup::StaticComponentID<T>::GetPageSize();
+                return static_cast<T* const*>(headerHot.data)[slotIndex / pageSize] + slotIndex % pageSize;
+            }
+            const ComponentSetup::ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(sceneIndex, listIndex);
+            if (componentIndex > createCtx.GetComponentListCold(sceneIndex, listIndex).slotCount || !(headerHot.generations[slotIndex] == generation))
+            {
+                return nullptr;
+            }
+            return static_cast<T*>(headerHot.dense) + headerHot.slotToDense[slotIndex] - 1;
+        }
 
-        // void* data and Generation* for each component type
-        static inline constexpr std::size_t GetPointerCountPerScene(std::size_t componentTypeCount) noexcept { return 2 * componentTypeCount; }
+        static void ReserveComponents(const ComponentSetup::ComponentType& type, ComponentSetup::CreateCtx& createCtx, SceneIndex sceneIndex, wIndex minCapacity, const ComponentSetup::ComponentAllocator& allocator);
+        static void DeleteListContent(const ComponentSetup& componentSetup, ComponentSetup::CreateCtx& createCtx, SceneIndex sceneIndex, const ComponentSetup::ComponentAllocator& allocator) noexcept;
 
-        // wIndex slotCount and wIndex capacity for each component type
-        static inline constexpr std::size_t GetIndexCountPerScene(std::size_t componentTypeCount) noexcept { return 2 * componentTypeCount; }
+        static constexpr std::size_t SceneBlockAlignment = wUtils::MaxAlignOf<ComponentSetup::ComponentListHeaderHot, ComponentSetup::PageListHeaderHot, SceneGeneration, ComponentSetup::ComponentListHeaderCold, ComponentSetup::PageListHeaderCold, SceneData>;
 
+        // Also folds the late lists into the stride of the new block.
+        void ReallocateScenes(wIndex newCapacity);
+        // Gives every scene slot a zeroed header block for a type added after the scene block exists, see CreateCtx.
+        void AddLateType(ComponentTypeIndex componentTypeIndex);
+        template<typename Hot, typename Cold>
+        void AddLateList(void**& lateLists, wIndex& lateListCount);
+        template<typename Hot, typename Cold>
+        void FreeLateLists(void**& lateLists, wIndex& lateListCount) noexcept;
+        [[nodiscard]] std::size_t GetLateListsSize() const noexcept;
+        void ClearSceneHeaders(SceneIndex sceneIndex) noexcept;
+        std::size_t CompactList(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex);
+        std::size_t CompactSceneBlock();
+        // Takes a slot from the free list or appends one, without touching its headers.
+        [[nodiscard]] SceneIndex ClaimSceneSlot();
+        [[nodiscard]] SceneArena* AcquireSceneArena();
+        void ReleaseSceneArena(SceneArena* arena) noexcept;
+        void DeleteSceneContent(SceneIndex sceneIndex) noexcept;
 
         Application& m_app;
         ComponentSetup m_componentSetup;
 
+        std::unique_ptr<EpochMemoryResource> m_epochMemory; // Only with Config::concurrentLookup, wraps the upstream resource
+        MemoryResource* m_memoryResource;
+        std::unique_ptr<PagePool> m_pagePool;
+        MemoryResource* m_pageMemoryResource; // m_pagePool if enabled, otherwise m_memoryResource
+        bool m_sceneArenasEnabled;
+        bool m_componentEvents;
+        std::size_t m_sceneArenaBlockSize;
+        std::vector<SceneArena*> m_unusedSceneArenas;
+
         std::byte* m_scenes;
+        std::size_t m_sceneBlockSize;
         SceneGeneration* m_sceneGenerations;
         ComponentSetup::CreateCtx m_createCtx;
         SceneData* m_sceneData;
         wIndex m_sceneSlotCount;
         wIndex m_sceneSlotCapacity;
+        wIndex m_stagedSceneCount; // Staged scenes not yet committed or discarded, the type table must not move under them
 
         wUtils::FreeList<SceneIndex> m_sceneFreeList;
         wUtils::SlotList<std::string> m_sceneNames;
+        std::unique_ptr<ReallocationHistogram> m_reallocationHistogram; // Created with the scene block, grows with late types
+        SceneIndex m_compactSceneIndex; // Where the budgeted Compact continues
+        ComponentTypeIndex m_compactTypeIndex;
+
+        std::atomic<uint64_t> m_sequence; // Odd while a structural change is in progress
+        wIndex m_writeDepth;
+    };
+
+    // Lists of one scene that is not in the ComponentSystem yet. Handles returned here have an invalid SceneHandle
+    // until the scene is committed, see SceneStream::Resolve. Only dense and paged lists can be staged.
+    class StagedScene
+    {
+    public:
+        ~StagedScene() noexcept;
+
+        StagedScene(const StagedScene&) = delete;
+        StagedScene& operator=(const StagedScene&) = delete;
+
+        template<typename T>
+        inline void ReserveComponents(wIndex minCapacity) { ComponentSystem::ReserveComponents(GetType<T>(), m_createCtx, SceneIndexStart, minCapacity, m_allocator); }
+
+        template<typename T>
+        [[nodiscard]] ComponentHandle<T> CreateComponent()
+        {
+            auto [componentIndex, generation] = GetType<T>().create(SceneIndexStart, m_createCtx, m_allocator, *m_app);
+            return ComponentHandle<T>(SceneHandle(), componentIndex, generation);
+        }
+
+        // Same as ComponentSystem::CreateComponents. outHandles may be null.
+        template<typename T>
+        void CreateComponents(wIndex count, ComponentHandle<T>* outHandles)
+        {
+            GetType<T>().createBatch(SceneIndexStart, count, outHandles ? &outHandles->componentIndex : nullptr, sizeof(ComponentHandle<T>), m_createCtx, m_allocator, *m_app);
+            if (outHandles)
+            {
+                const ComponentGeneration* generations = ComponentSystem::GetGenerations<T>(*m_componentSetup, m_createCtx, SceneIndexStart);
+                for (ComponentHandle<T>* handle = outHandles; handle != outHandles + count; ++handle)
+                {
+                    handle->sceneHandle = SceneHandle();
+                    handle->generation = generations[handle->componentIndex - 1];
+                }
+            }
+        }
+
+        template<typename T>
+        [[nodiscard]] inline T* GetComponent(ComponentHandle<T> componentHandle) noexcept { return ComponentSystem::FindComponent<T>(*m_componentSetup, m_createCtx, SceneIndexStart, componentHandle.componentIndex, componentHandle.generation); }
+
+    private:
+        friend class ComponentSystem;
+
+        StagedScene(const ComponentSetup& componentSetup, Application& app, ComponentSystem& componentSystem, const ComponentSetup::CreateCtx& layout, const ComponentSetup::ComponentAllocator& allocator, SceneArena* arena);
+
+        template<typename T>
+        [[nodiscard]] inline const ComponentSetup::ComponentType& GetType() const noexcept
+        {
+            W_ASSERT(!m_componentSetup->IsChunked<T>(), "Component: {} uses ChunkedStorage and can not be staged", m_componentSetup->GetComponentTypeName<T>());
+            return m_componentSetup->m_types[m_componentSetup->GetComponentTypeIndex<T>() - 1];
+        }
+
+        const ComponentSetup* m_componentSetup;
+        Application* m_app;
+        ComponentSystem* m_componentSystem; // Null once committed or discarded
+        ComponentSetup::CreateCtx m_createCtx; // Headers of a single scene at SceneIndexStart
+        std::vector<ComponentSetup::ComponentListHeaderHot> m_componentListsHot;
+        std::vector<ComponentSetup::PageListHeaderHot> m_pageListsHot;
+        std::vector<ComponentSetup::ComponentListHeaderCold> m_componentListsCold;
+        std::vector<ComponentSetup::PageListHeaderCold> m_pageListsCold;
+        ComponentSetup::ComponentAllocator m_allocator;
+        SceneArena* m_arena;
     };
 
     class Scene
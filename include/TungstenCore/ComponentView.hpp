@@ -0,0 +1,192 @@
+#ifndef TUNGSTEN_CORE_COMPONENT_VIEW_HPP
+#define TUNGSTEN_CORE_COMPONENT_VIEW_HPP
+
+#include <array>
+#include <span>
+#include <tuple>
+#include <utility>
+#include "TungstenCore/ComponentSetup.hpp"
+
+namespace wCore
+{
+    // Raw view of one dense component list. Only valid until the next structural change to that list.
+    struct DenseListView
+    {
+        void* dense;
+        const ComponentIndex* slotToDense;
+        const ComponentIndex* denseToSlot;
+        ChangeVersion* versions;
+        wIndex denseCount;
+        wIndex slotCount;
+
+        [[nodiscard]] inline bool Contains(ComponentIndex componentIndex) const noexcept { return componentIndex <= slotCount && slotToDense[componentIndex - 1]; }
+    };
+
+    // Access to a non const type stamps the blocks it touches with the current ChangeVersion, use const types to only read.
+    template<typename... Ts>
+    class ComponentView
+    {
+        static_assert(sizeof...(Ts) > 0, "ComponentView needs at least one component type");
+
+    public:
+        // fn is called as fn(Ts&...) or fn(ComponentIndex, Ts&...).
+        // Iteration starts from the smallest list and checks the others through slotToDense.
+        template<typename Fn>
+        void Each(Fn&& fn) const
+        {
+            if constexpr (sizeof...(Ts) == 1)
+            {
+                EachFrom<0>(fn);
+            }
+            else
+            {
+                const wIndex pivot = GetSmallestListIndex();
+                DispatchEach(fn, pivot, std::index_sequence_for<Ts...>());
+            }
+        }
+
+        [[nodiscard]] inline wIndex GetSmallestListIndex() const noexcept
+        {
+            wIndex smallest = 0;
+            for (wIndex listIndex = 1; listIndex < sizeof...(Ts); ++listIndex)
+            {
+                if (m_lists[listIndex].denseCount < m_lists[smallest].denseCount)
+                {
+                    smallest = listIndex;
+                }
+            }
+            return smallest;
+        }
+
+        // Like Each, but iterates the list of T and skips every block not written since the given version.
+        // Blocks stamped with exactly that version are visited again, so passing the version of the previous query never misses a write.
+        template<typename T, typename Fn>
+        void EachChanged(ChangeVersion since, Fn&& fn) const
+        {
+            EachChangedFrom<IndexOf<T>()>(fn, since);
+        }
+
+        // Upper bound of the number of matches, exact for single type views.
+        [[nodiscard]] inline wIndex GetMaxCount() const noexcept { return m_lists[GetSmallestListIndex()].denseCount; }
+
+        template<typename T>
+        [[nodiscard]] inline std::span<T> GetSpan() const noexcept
+        {
+            const DenseListView& list = m_lists[IndexOf<T>()];
+            if constexpr (!std::is_const_v<T>)
+            {
+                std::fill_n(list.versions, GetChangeBlockCount(list.denseCount), m_writeVersion);
+            }
+            return { static_cast<T*>(list.dense), list.denseCount };
+        }
+
+        template<typename T>
+        [[nodiscard]] inline std::span<const ComponentIndex> GetComponentIndices() const noexcept
+        {
+            const DenseListView& list = m_lists[IndexOf<T>()];
+            return { list.denseToSlot, list.denseCount };
+        }
+
+    private:
+        ComponentView(const std::array<DenseListView, sizeof...(Ts)>& lists, ChangeVersion writeVersion) noexcept
+            : m_lists(lists), m_writeVersion(writeVersion) {}
+
+        template<typename T, wIndex I = 0>
+        [[nodiscard]] static constexpr wIndex IndexOf() noexcept
+        {
+            static_assert(I < sizeof...(Ts), "Type is not part of this ComponentView");
+            if constexpr (std::is_same_v<T, std::tuple_element_t<I, std::tuple<Ts...>>>)
+            {
+                return I;
+            }
+            else
+            {
+                return IndexOf<T, I + 1>();
+            }
+        }
+
+        template<typename Fn, std::size_t... Is>
+        inline void DispatchEach(Fn& fn, wIndex pivot, std::index_sequence<Is...>) const
+        {
+            ((pivot == Is ? (EachFrom<Is>(fn), true) : false) || ...);
+        }
+
+        template<std::size_t Pivot, typename Fn>
+        void EachFrom(Fn& fn) const
+        {
+            const DenseListView& pivotList = m_lists[Pivot];
+            for (wIndex densePosition = 0; densePosition < pivotList.denseCount; ++densePosition)
+            {
+                const ComponentIndex componentIndex = pivotList.denseToSlot[densePosition];
+                if (ContainsAllExcept<Pivot>(componentIndex, std::index_sequence_for<Ts...>()))
+                {
+                    Invoke<Pivot>(fn, componentIndex, densePosition, std::index_sequence_for<Ts...>());
+                }
+            }
+        }
+
+        template<std::size_t Pivot, typename Fn>
+        void EachChangedFrom(Fn& fn, ChangeVersion since) const
+        {
+            const DenseListView& pivotList = m_lists[Pivot];
+            const wIndex blockCount = GetChangeBlockCount(pivotList.denseCount);
+            for (wIndex blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+            {
+                if (pivotList.versions[blockIndex] < since)
+                {
+                    continue;
+                }
+                const wIndex blockEnd = std::min((blockIndex + 1) * ChangeBlockSize, pivotList.denseCount);
+                for (wIndex densePosition = blockIndex * ChangeBlockSize; densePosition < blockEnd; ++densePosition)
+                {
+                    const ComponentIndex componentIndex = pivotList.denseToSlot[densePosition];
+                    if (ContainsAllExcept<Pivot>(componentIndex, std::index_sequence_for<Ts...>()))
+                    {
+                        Invoke<Pivot>(fn, componentIndex, densePosition, std::index_sequence_for<Ts...>());
+                    }
+                }
+            }
+        }
+
+        template<std::size_t Pivot, std::size_t... Is>
+        [[nodiscard]] inline bool ContainsAllExcept(ComponentIndex componentIndex, std::index_sequence<Is...>) const noexcept
+        {
+            return ((Is == Pivot || m_lists[Is].Contains(componentIndex)) && ...);
+        }
+
+        template<std::size_t Pivot, typename Fn, std::size_t... Is>
+        inline void Invoke(Fn& fn, ComponentIndex componentIndex, wIndex pivotPosition, std::index_sequence<Is...>) const
+        {
+            if constexpr (std::is_invocable_v<Fn&, ComponentIndex, Ts&...>)
+            {
+                fn(componentIndex, Get<Is, Pivot>(componentIndex, pivotPosition)...);
+            }
+            else
+            {
+                fn(Get<Is, Pivot>(componentIndex, pivotPosition)...);
+            }
+        }
+
+        template<std::size_t I, std::size_t Pivot>
+        [[nodiscard]] inline std::tuple_element_t<I, std::tuple<Ts...>>& Get(ComponentIndex componentIndex, wIndex pivotPosition) const noexcept
+        {
+            using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+            const DenseListView& list = m_lists[I];
+            const wIndex densePosition = I == Pivot ? pivotPosition : list.slotToDense[componentIndex - 1] - 1;
+            if constexpr (!std::is_const_v<T>)
+            {
+                list.versions[densePosition / ChangeBlockSize] = m_writeVersion;
+            }
+            return static_cast<T*>(list.dense)[densePosition];
+        }
+
+        std::array<DenseListView, sizeof...(Ts)> m_lists;
+        ChangeVersion m_writeVersion;
+
+        friend class ComponentSystem;
+        template<typename... Descs>
+        friend class ComponentRegistry;
+    };
+}
+
+#endif
\ No newline at end of file
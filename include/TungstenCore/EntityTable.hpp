@@ -0,0 +1,132 @@
+#ifndef TUNGSTEN_CORE_ENTITY_TABLE_HPP
+#define TUNGSTEN_CORE_ENTITY_TABLE_HPP
+
+#include <bit>
+#include <vector>
+#include "TungstenCore/ComponentSetup.hpp"
+
+namespace wCore
+{
+    using EntityIndex = wIndex;
+    inline constexpr EntityIndex InvalidEntity = 0;
+    inline constexpr EntityIndex EntityIndexStart = 1;
+
+    // Links the components of one scene that make up one object, at most one per dense or paged type.
+    // Every entity has a generation, odd while alive like a paged slot, and a signature with one bit per ComponentTypeIndex.
+    // Per type a sparse array maps entities to the slots of their components and a second one maps the slots back. Has is
+    // a single load of the signature, the slot of a component one more. Links are by slot, so swaps, sorting and
+    // compaction of the dense arrays never touch them. Entities are not part of snapshots or staged scenes.
+    class EntityTable
+    {
+    public:
+        static constexpr wIndex SignatureWordBits = 64;
+
+        EntityTable() noexcept;
+
+        EntityTable(const EntityTable&) = delete;
+        EntityTable& operator=(const EntityTable&) = delete;
+
+        [[nodiscard]] std::pair<EntityIndex, ComponentGeneration> Create();
+        // Every component must be unlinked first.
+        void Destroy(EntityIndex entityIndex) noexcept;
+
+        [[nodiscard]] inline bool EntityExists(EntityIndex entityIndex, ComponentGeneration generation) const noexcept { return entityIndex != InvalidEntity && entityIndex <= m_generations.size() && m_generations[entityIndex - 1] == generation && IsAlive(generation); }
+        [[nodiscard]] inline ComponentGeneration GetGeneration(EntityIndex entityIndex) const noexcept { return m_generations[entityIndex - 1]; }
+
+        [[nodiscard]] inline bool Has(EntityIndex entityIndex, ComponentTypeIndex componentTypeIndex) const noexcept
+        {
+            const wIndex bit = componentTypeIndex - 1;
+            return bit < m_signatureWordCount * SignatureWordBits && ((m_signatures[(entityIndex - 1) * m_signatureWordCount + bit / SignatureWordBits] >> (bit % SignatureWordBits)) & 1);
+        }
+        // Only for linked types, see Has.
+        [[nodiscard]] inline ComponentIndex GetSlot(EntityIndex entityIndex, ComponentTypeIndex componentTypeIndex) const noexcept { return m_links[componentTypeIndex - 1].entityToSlot[entityIndex - 1]; }
+        // InvalidEntity if no entity links the slot.
+        [[nodiscard]] inline EntityIndex GetOwner(ComponentTypeIndex componentTypeIndex, ComponentIndex componentIndex) const noexcept
+        {
+            if (componentTypeIndex > m_links.size())
+            {
+                return InvalidEntity;
+            }
+            const std::vector<EntityIndex>& slotToEntity = m_links[componentTypeIndex - 1].slotToEntity;
+            return componentIndex <= slotToEntity.size() ? slotToEntity[componentIndex - 1] : InvalidEntity;
+        }
+
+        void Link(EntityIndex entityIndex, ComponentTypeIndex componentTypeIndex, ComponentIndex componentIndex);
+        void Unlink(EntityIndex entityIndex, ComponentTypeIndex componentTypeIndex) noexcept;
+        // Unlinks the slot from its entity if it has one, for components destroyed without going through the entity.
+        void UnlinkSlot(ComponentTypeIndex componentTypeIndex, ComponentIndex componentIndex) noexcept;
+
+        // Calls fn(ComponentTypeIndex) for every type linked to the entity. fn may unlink the type it is called with.
+        template<typename Fn>
+        void EachComponentType(EntityIndex entityIndex, Fn&& fn) const
+        {
+            const uint64_t* signature = m_signatures.data() + (entityIndex - 1) * m_signatureWordCount;
+            for (wIndex wordIndex = 0; wordIndex < m_signatureWordCount; ++wordIndex)
+            {
+                for (uint64_t word = signature[wordIndex]; word; word &= word - 1)
+                {
+                    fn(static_cast<ComponentTypeIndex>(wordIndex * SignatureWordBits + std::countr_zero(word) + 1));
+                }
+            }
+        }
+
+        // Appends count copies of the entities of prefab, instance i of the prefab entity e is firstEntity + i * prefab
+        // slot count + e - 1 with the generation of e, so dead prefab entities become free entities. instanceSlot
+        // (ComponentTypeIndex, prefab slot, instance) returns the slot the component was copied to. Returns firstEntity.
+        template<typename SlotFn>
+        EntityIndex Instantiate(const EntityTable& prefab, wIndex count, SlotFn&& instanceSlot)
+        {
+            W_ASSERT(&prefab != this, "A scene can not instantiate its own entities");
+            const wIndex prefabSlotCount = prefab.m_generations.size();
+            const EntityIndex firstEntity = m_generations.size() + 1;
+            if (prefab.m_signatureWordCount > m_signatureWordCount)
+            {
+                WidenSignatures(prefab.m_signatureWordCount);
+            }
+            m_generations.reserve(m_generations.size() + count * prefabSlotCount);
+            m_signatures.resize((m_generations.size() + count * prefabSlotCount) * m_signatureWordCount);
+
+            for (wIndex instance = 0; instance < count; ++instance)
+            {
+                for (EntityIndex prefabEntity = EntityIndexStart; prefabEntity <= prefabSlotCount; ++prefabEntity)
+                {
+                    const ComponentGeneration generation = prefab.m_generations[prefabEntity - 1];
+                    m_generations.push_back(generation);
+                    const EntityIndex entityIndex = m_generations.size();
+                    if (!IsAlive(generation))
+                    {
+                        m_freeList.Add(entityIndex);
+                        continue;
+                    }
+                    prefab.EachComponentType(prefabEntity, [&](ComponentTypeIndex componentTypeIndex)
+                    {
+                        Link(entityIndex, componentTypeIndex, instanceSlot(componentTypeIndex, prefab.GetSlot(prefabEntity, componentTypeIndex), instance));
+                    });
+                }
+            }
+            return firstEntity;
+        }
+
+        [[nodiscard]] inline wIndex GetEntityCount() const noexcept { return m_generations.size() - m_freeList.Count(); }
+        [[nodiscard]] inline wIndex GetEntitySlotCount() const noexcept { return m_generations.size(); }
+
+    private:
+        struct TypeLinks
+        {
+            std::vector<ComponentIndex> entityToSlot; // Sized to the entity slots once the type is first linked
+            std::vector<EntityIndex> slotToEntity; // Up to the highest linked slot
+        };
+
+        [[nodiscard]] static inline bool IsAlive(ComponentGeneration generation) noexcept { return generation.generation & 1; }
+        // Types added after the table was created can need more words per entity.
+        void WidenSignatures(wIndex signatureWordCount);
+
+        std::vector<ComponentGeneration> m_generations;
+        std::vector<uint64_t> m_signatures; // m_signatureWordCount words per entity slot
+        std::vector<TypeLinks> m_links; // Per ComponentTypeIndex, grown on first link
+        wUtils::FreeList<EntityIndex> m_freeList;
+        wIndex m_signatureWordCount;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,188 @@
+#ifndef TUNGSTEN_CORE_EVENT_BUS_HPP
+#define TUNGSTEN_CORE_EVENT_BUS_HPP
+
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include "TungstenUtils/TungstenUtils.hpp"
+#include "TungstenCore/JobSystem.hpp"
+
+namespace wCore
+{
+    using EventTypeIndex = wIndex;
+    inline constexpr EventTypeIndex InvalidEventType = 0;
+    inline constexpr EventTypeIndex EventTypeIndexStart = 1;
+
+    template<typename T>
+    class EventReader;
+
+    // Typed event channels, double buffered per tick.
+    // Every channel keeps one segment per JobSystem thread, so jobs publish by appending to a vector only their thread
+    // touches, without locks or atomics. Events published during a tick become readable after Swap, which Application
+    // calls at the end of every tick, and stay readable for the whole next tick. Readers get spans straight into the
+    // segments, nothing is copied. Swapping and clearing keep the allocations, so a steady event rate stops allocating.
+    // Threads outside the JobSystem share segment 0 with the owner thread and must not publish while it does.
+    class EventBus
+    {
+    public:
+        explicit EventBus(const JobSystem& jobSystem);
+        ~EventBus() noexcept;
+
+        EventBus(const EventBus&) = delete;
+        EventBus& operator=(const EventBus&) = delete;
+
+        // Channels are added once, on the owner thread, before anything publishes.
+        template<typename T>
+        void AddChannel()
+        {
+            static_assert(std::is_nothrow_destructible_v<T>, "Events must be nothrow-destructible");
+            W_ASSERT(!StaticEventID<T>::GetID(), "Event: {} already has a channel", wUtils::DebugGetTypeName<T>());
+            m_channels.emplace_back(std::make_unique<Channel<T>>(m_segmentCount));
+            StaticEventID<T>::Set(m_channels.size());
+        }
+
+        template<typename T>
+        [[nodiscard]] inline bool HasChannel() const noexcept { return StaticEventID<T>::GetID() != InvalidEventType; }
+
+        // Appends to the segment of the calling thread, readable after the next Swap.
+        template<typename T, typename... Args>
+        inline T& Publish(Args&&... args) { return GetLocalSegment<T>().write.emplace_back(std::forward<Args>(args)...); }
+
+        template<typename T>
+        inline void PublishBulk(std::span<const T> events)
+        {
+            std::vector<T>& write = GetLocalSegment<T>().write;
+            write.insert(write.end(), events.begin(), events.end());
+        }
+
+        // Events published before the last Swap. The spans stay valid until the next Swap or Clear, any thread may read
+        // them.
+        template<typename T>
+        [[nodiscard]] inline EventReader<T> Read() const noexcept { return EventReader<T>(GetChannel<T>().segments.get(), m_segmentCount); }
+
+        // Makes the events published since the last Swap readable and drops the ones that were. Must not run while jobs
+        // publish or read.
+        void Swap() noexcept;
+        // Drops every event of every channel, published and readable.
+        void Clear() noexcept;
+
+        [[nodiscard]] inline wIndex GetChannelCount() const noexcept { return m_channels.size(); }
+        [[nodiscard]] inline wIndex GetSegmentCount() const noexcept { return m_segmentCount; }
+
+    private:
+        template<typename T>
+        friend class EventReader;
+
+        template<typename T>
+        struct alignas(64) Segment
+        {
+            std::vector<T> write;
+            std::vector<T> read;
+        };
+
+        struct ChannelBase
+        {
+            virtual ~ChannelBase() noexcept = default;
+            virtual void Swap() noexcept = 0;
+            virtual void Clear() noexcept = 0;
+        };
+
+        template<typename T>
+        struct Channel final : ChannelBase
+        {
+            explicit Channel(wIndex a_segmentCount)
+                : segments(std::make_unique<Segment<T>[]>(a_segmentCount)), segmentCount(a_segmentCount) {}
+
+            void Swap() noexcept override
+            {
+                for (wIndex segmentIndex = 0; segmentIndex < segmentCount; ++segmentIndex)
+                {
+                    Segment<T>& segment = segments[segmentIndex];
+                    segment.read.swap(segment.write);
+                    segment.write.clear();
+                }
+            }
+
+            void Clear() noexcept override
+            {
+                for (wIndex segmentIndex = 0; segmentIndex < segmentCount; ++segmentIndex)
+                {
+                    segments[segmentIndex].write.clear();
+                    segments[segmentIndex].read.clear();
+                }
+            }
+
+            std::unique_ptr<Segment<T>[]> segments;
+            wIndex segmentCount;
+        };
+
+        template<typename T>
+        class StaticEventID
+        {
+        public:
+            static inline EventTypeIndex GetID() { return s_id; }
+            static inline void Set(EventTypeIndex id) { s_id = id; }
+
+        private:
+            static inline EventTypeIndex s_id;
+        };
+
+        template<typename T>
+        [[nodiscard]] inline Channel<T>& GetChannel() const noexcept
+        {
+            W_ASSERT(StaticEventID<T>::GetID(), "Event: {} has no channel, see EventBus::AddChannel", wUtils::DebugGetTypeName<T>());
+            return static_cast<Channel<T>&>(*m_channels[StaticEventID<T>::GetID() - 1]);
+        }
+
+        template<typename T>
+        [[nodiscard]] inline Segment<T>& GetLocalSegment() noexcept { return GetChannel<T>().segments[JobSystem::GetCurrentWorkerIndex()]; }
+
+        std::vector<std::unique_ptr<ChannelBase>> m_channels;
+        wIndex m_segmentCount;
+    };
+
+    // The readable events of one channel, one span per thread. Events of one thread keep their publishing order, threads
+    // follow in thread index order.
+    template<typename T>
+    class EventReader
+    {
+    public:
+        [[nodiscard]] inline wIndex GetSegmentCount() const noexcept { return m_segmentCount; }
+        [[nodiscard]] inline std::span<const T> GetSegment(wIndex segmentIndex) const noexcept { W_ASSERT(segmentIndex < m_segmentCount, "Segment: {} out of Range! Segment Count: {}", segmentIndex, m_segmentCount); return m_segments[segmentIndex].read; }
+
+        [[nodiscard]] wIndex GetCount() const noexcept
+        {
+            wIndex count = 0;
+            for (wIndex segmentIndex = 0; segmentIndex < m_segmentCount; ++segmentIndex)
+            {
+                count += m_segments[segmentIndex].read.size();
+            }
+            return count;
+        }
+        [[nodiscard]] inline bool Empty() const noexcept { return GetCount() == 0; }
+
+        template<typename Fn>
+        void ForEach(Fn&& fn) const
+        {
+            for (wIndex segmentIndex = 0; segmentIndex < m_segmentCount; ++segmentIndex)
+            {
+                for (const T& event : m_segments[segmentIndex].read)
+                {
+                    fn(event);
+                }
+            }
+        }
+
+    private:
+        friend class EventBus;
+
+        EventReader(const EventBus::Segment<T>* segments, wIndex segmentCount) noexcept
+            : m_segments(segments), m_segmentCount(segmentCount) {}
+
+        const EventBus::Segment<T>* m_segments;
+        wIndex m_segmentCount;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef TUNGSTEN_CORE_FRAME_LOOP_HPP
+#define TUNGSTEN_CORE_FRAME_LOOP_HPP
+
+#include <array>
+#include <chrono>
+#include "TungstenUtils/TungstenUtils.hpp"
+
+namespace wCore
+{
+    // Timing of Application::Run: fixed simulation ticks driven by an accumulator, frames presented at a variable or
+    // capped rate, and per frame budget statistics.
+    // Every frame adds the time since the last one to the accumulator and runs one tick per tick duration it holds, the
+    // rest is the interpolation between the last two ticks. A frame that falls far behind runs at most maxTicksPerFrame
+    // ticks and drops the remaining time instead of spiralling. Waiting for the next frame sleeps until spinThreshold
+    // before the deadline and spins the rest, sleeps alone overshoot by the scheduler granularity.
+    class FrameLoop
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Config
+        {
+            double tickRate = 60.0; // Fixed simulation ticks per second
+            double frameRate = 0.0; // Presented frames per second, 0 leaves pacing to presenting, for example waiting for vsync
+            wIndex maxTicksPerFrame = 8;
+            std::chrono::nanoseconds spinThreshold = std::chrono::microseconds(500); // 0 only sleeps, for servers that rather save CPU than jitter
+            bool headless = false; // Nothing is presented and every frame waits for the next tick
+            uint64_t maxFrames = 0; // Run returns after this many frames, 0 runs until Application::RequestExit
+        };
+
+        // Frames kept for the percentiles.
+        static constexpr wIndex HistorySize = 1024;
+
+        struct Stats
+        {
+            uint64_t frameCount = 0;
+            uint64_t tickCount = 0;
+            uint64_t catchUpTickCount = 0; // Ticks past the first of a frame
+            uint64_t droppedTickCount = 0; // Ticks skipped past maxTicksPerFrame
+            uint64_t overrunCount = 0; // Frames whose work took longer than the frame budget
+        };
+
+        explicit FrameLoop(const Config& config) noexcept;
+
+        // Starts the clock, the first frame runs one tick right away.
+        void Start() noexcept;
+        // Returns the number of ticks to run this frame.
+        [[nodiscard]] wIndex BeginFrame() noexcept;
+        // Records the work of the frame and waits for the next one. Without a frame rate, a frame that presented nothing
+        // waits for the next tick like in headless mode, so an idle loop does not spin.
+        void EndFrame(bool presented) noexcept;
+
+        [[nodiscard]] inline bool IsDone() const noexcept { return m_config.maxFrames && m_stats.frameCount >= m_config.maxFrames; }
+        [[nodiscard]] inline bool IsHeadless() const noexcept { return m_config.headless; }
+
+        [[nodiscard]] inline std::chrono::nanoseconds GetTickDuration() const noexcept { return m_tickDuration; }
+        [[nodiscard]] inline double GetTickSeconds() const noexcept { return std::chrono::duration<double>(m_tickDuration).count(); }
+        // Time since the last tick in ticks, in [0, 1). Presentation blends the last two ticks with it.
+        [[nodiscard]] inline double GetInterpolation() const noexcept { return static_cast<double>(m_accumulator.count()) / static_cast<double>(m_tickDuration.count()); }
+        // Frame period with a frame rate, the tick duration without.
+        [[nodiscard]] inline std::chrono::nanoseconds GetFrameBudget() const noexcept { return m_frameDuration.count() ? m_frameDuration : m_tickDuration; }
+
+        [[nodiscard]] inline const Stats& GetStats() const noexcept { return m_stats; }
+        // Percentile in [0, 100] of the last HistorySize frames. Work is the time from BeginFrame to EndFrame, frame time
+        // the time between two BeginFrame and so includes the wait.
+        [[nodiscard]] std::chrono::nanoseconds GetWorkTimePercentile(double percentile) const;
+        [[nodiscard]] std::chrono::nanoseconds GetFrameTimePercentile(double percentile) const;
+        void ResetStats() noexcept;
+
+        // Sleeps until spinThreshold before the deadline, then spins.
+        static void WaitUntil(Clock::time_point deadline, std::chrono::nanoseconds spinThreshold) noexcept;
+
+    private:
+        struct FrameSample
+        {
+            std::chrono::nanoseconds work;
+            std::chrono::nanoseconds frame;
+        };
+
+        [[nodiscard]] std::chrono::nanoseconds GetPercentile(std::chrono::nanoseconds FrameSample::* member, double percentile) const;
+
+        Config m_config;
+        std::chrono::nanoseconds m_tickDuration;
+        std::chrono::nanoseconds m_frameDuration; // 0 without a frame rate
+        std::chrono::nanoseconds m_accumulator;
+        Clock::time_point m_frameBegin;
+        Clock::time_point m_nextFrame; // Deadline of the next frame with a frame rate
+        std::chrono::nanoseconds m_lastFrameTime;
+        Stats m_stats;
+        std::array<FrameSample, HistorySize> m_history;
+    };
+}
+
+#endif
\ No newline at end of file
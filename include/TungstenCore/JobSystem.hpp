@@ -0,0 +1,175 @@
+#ifndef TUNGSTEN_CORE_JOB_SYSTEM_HPP
+#define TUNGSTEN_CORE_JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TungstenUtils/TungstenUtils.hpp"
+
+namespace wCore
+{
+    inline constexpr wIndex JobQueueCapacity = 2048;
+    inline constexpr std::size_t JobStorageSize = 96;
+
+    // Tracks a group of jobs for fork-join. Spawning increments it, a finished job decrements it.
+    class JobCounter
+    {
+    public:
+        constexpr JobCounter() noexcept
+            : m_count(0) {}
+
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        [[nodiscard]] inline bool IsDone() const noexcept { return !m_count.load(std::memory_order_acquire); }
+        [[nodiscard]] inline wIndex GetCount() const noexcept { return m_count.load(std::memory_order_acquire); }
+
+    private:
+        std::atomic<wIndex> m_count;
+        friend class JobSystem;
+    };
+
+    struct Job
+    {
+        void(*invoke)(Job& job);
+        JobCounter* counter;
+        std::atomic<bool> inUse;
+        bool heapAllocated; // Spawned from a thread without a queue
+        alignas(std::max_align_t) std::byte storage[JobStorageSize];
+    };
+
+    // Chase-Lev deque. The owning thread pushes and pops at the bottom, other threads steal from the top.
+    class WorkStealingQueue
+    {
+    public:
+        WorkStealingQueue() noexcept;
+
+        [[nodiscard]] bool Push(Job* job) noexcept;
+        [[nodiscard]] Job* Pop() noexcept;
+        [[nodiscard]] Job* Steal() noexcept;
+
+        [[nodiscard]] inline bool Empty() const noexcept { return m_bottom.load(std::memory_order_acquire) <= m_top.load(std::memory_order_acquire); }
+
+    private:
+        alignas(64) std::atomic<int64_t> m_top;
+        alignas(64) std::atomic<int64_t> m_bottom;
+        alignas(64) std::atomic<Job*> m_jobs[JobQueueCapacity];
+    };
+
+    // Shared worker pool. The thread that creates the JobSystem acts as worker 0 while it waits on a counter.
+    // Each queue owning thread allocates jobs from its own ring of 2 * JobQueueCapacity slots. Jobs that wait on nested jobs
+    // stay in use, so deep or wide fork join can fill the ring, further jobs are then heap allocated until slots free up.
+    class JobSystem
+    {
+    public:
+        struct Config
+        {
+            wIndex workerCount = DefaultWorkerCount();
+            bool pinWorkers = false;
+            wIndex firstCore = 0; // Worker n is pinned to core (firstCore + n) % core count, the owner thread to firstCore
+        };
+
+        JobSystem();
+        explicit JobSystem(const Config& config);
+        ~JobSystem() noexcept;
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        template<typename Fn>
+        void Spawn(JobCounter& counter, Fn&& fn)
+        {
+            using Functor = std::decay_t<Fn>;
+            static_assert(sizeof(Functor) <= JobStorageSize, "Job functor is too large, capture a pointer instead");
+            static_assert(alignof(Functor) <= alignof(std::max_align_t), "Job functor is over aligned");
+
+            const wIndex queueIndex = GetCurrentQueueIndex();
+            Job* job = AllocateJob(queueIndex);
+            job->invoke = [](Job& self)
+            {
+                Functor* functor = std::launder(reinterpret_cast<Functor*>(self.storage));
+                (*functor)();
+                std::destroy_at(functor);
+            };
+            job->counter = &counter;
+            std::construct_at(reinterpret_cast<Functor*>(job->storage), std::forward<Fn>(fn));
+            Submit(queueIndex, job);
+        }
+
+        // Runs other jobs until the counter reaches zero.
+        void Wait(const JobCounter& counter) noexcept;
+
+        // Calls fn(rangeBegin, rangeEnd) for consecutive sub ranges of [begin, end) of at most grainSize and waits for all of them.
+        template<typename Fn>
+        void ParallelFor(wIndex begin, wIndex end, wIndex grainSize, Fn&& fn)
+        {
+            W_ASSERT(grainSize, "ParallelFor grain size must not be 0");
+            if (end <= begin)
+            {
+                return;
+            }
+            if (end - begin <= grainSize || !GetWorkerCount())
+            {
+                fn(begin, end);
+                return;
+            }
+
+            JobCounter counter;
+            for (wIndex rangeBegin = begin + grainSize; rangeBegin < end; rangeBegin += grainSize)
+            {
+                const wIndex rangeEnd = rangeBegin + std::min(grainSize, end - rangeBegin);
+                Spawn(counter, [&fn, rangeBegin, rangeEnd] { fn(rangeBegin, rangeEnd); });
+            }
+            fn(begin, begin + grainSize);
+            Wait(counter);
+        }
+
+        [[nodiscard]] inline wIndex GetWorkerCount() const noexcept { return m_workers.size(); }
+        [[nodiscard]] inline wIndex GetThreadCount() const noexcept { return m_workers.size() + 1; }
+
+        // 0 for the owner thread and threads outside the pool, 1 to worker count for the workers.
+        [[nodiscard]] static wIndex GetCurrentWorkerIndex() noexcept;
+        [[nodiscard]] static wIndex DefaultWorkerCount() noexcept;
+
+    private:
+        struct alignas(64) WorkerData
+        {
+            WorkStealingQueue queue;
+            std::unique_ptr<Job[]> jobs;
+            wIndex nextJob;
+        };
+
+        static constexpr wIndex NoQueue = std::numeric_limits<wIndex>::max();
+
+        [[nodiscard]] wIndex GetCurrentQueueIndex() const noexcept;
+        [[nodiscard]] Job* AllocateJob(wIndex queueIndex);
+        void Submit(wIndex queueIndex, Job* job);
+        void WorkerLoop(wIndex workerIndex) noexcept;
+        [[nodiscard]] bool TryRunOne(wIndex queueIndex) noexcept;
+        [[nodiscard]] Job* FindJob(wIndex queueIndex) noexcept;
+        static void Execute(Job& job) noexcept;
+        static void PinCurrentThread(wIndex core) noexcept;
+
+        std::unique_ptr<WorkerData[]> m_workerData;
+        wIndex m_queueCount;
+        std::thread::id m_ownerThread;
+
+        // Jobs spawned from threads that do not own a queue.
+        std::mutex m_externalMutex;
+        std::deque<Job*> m_externalJobs;
+
+        std::atomic<wIndex> m_queuedJobs;
+        std::atomic<wIndex> m_sleepingWorkers;
+        std::mutex m_sleepMutex;
+        std::condition_variable m_sleepCondition;
+        std::atomic<bool> m_stopping;
+        std::vector<std::thread> m_workers;
+    };
+}
+
+#endif
\ No newline at end of file
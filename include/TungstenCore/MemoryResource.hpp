@@ -0,0 +1,161 @@
+#ifndef TUNGSTEN_CORE_MEMORY_RESOURCE_HPP
+#define TUNGSTEN_CORE_MEMORY_RESOURCE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "TungstenUtils/TungstenUtils.hpp"
+
+namespace wCore
+{
+    // Source of component storage. Deallocate always receives the size and alignment given to Allocate.
+    class MemoryResource
+    {
+    public:
+        virtual ~MemoryResource() noexcept = default;
+
+        [[nodiscard]] virtual void* Allocate(std::size_t size, std::size_t alignment) = 0;
+        virtual void Deallocate(void* memory, std::size_t size, std::size_t alignment) noexcept = 0;
+    };
+
+    // Global aligned operator new/delete.
+    class HeapMemoryResource final : public MemoryResource
+    {
+    public:
+        [[nodiscard]] void* Allocate(std::size_t size, std::size_t alignment) override;
+        void Deallocate(void* memory, std::size_t size, std::size_t alignment) noexcept override;
+
+        [[nodiscard]] static HeapMemoryResource& Get() noexcept;
+    };
+
+    // Bump allocator for the lists of one scene. Deallocate is a no-op and Reset rewinds to the first block while keeping
+    // every block, so a destroyed scene gives its memory back in O(1) and the next scene using the arena does not allocate.
+    class SceneArena final : public MemoryResource
+    {
+    public:
+        SceneArena(MemoryResource& upstream, std::size_t blockSize) noexcept;
+        ~SceneArena() noexcept override;
+
+        SceneArena(const SceneArena&) = delete;
+        SceneArena& operator=(const SceneArena&) = delete;
+
+        [[nodiscard]] void* Allocate(std::size_t size, std::size_t alignment) override;
+        inline void Deallocate(void*, std::size_t, std::size_t) noexcept override {}
+
+        void Reset() noexcept;
+        // Returns every block to the upstream resource.
+        void Release() noexcept;
+
+        [[nodiscard]] std::size_t GetBytesReserved() const noexcept;
+        [[nodiscard]] std::size_t GetBytesUsed() const noexcept;
+
+    private:
+        static constexpr std::size_t BlockAlignment = 64;
+
+        struct Block
+        {
+            std::byte* memory;
+            std::size_t size;
+        };
+
+        MemoryResource& m_upstream;
+        std::size_t m_blockSize;
+        std::vector<Block> m_blocks;
+        wIndex m_currentBlock;
+        std::size_t m_currentOffset;
+        std::size_t m_usedBeforeCurrent;
+    };
+
+    // Keeps freed allocations in per size and alignment buckets and hands them out again, so pages released by one scene
+    // are reused by the next without going back to the upstream resource. Allocate reserves room for every page it hands
+    // out, so Deallocate never allocates. Pages that were not allocated here go back upstream once their bucket is full.
+    class PagePool final : public MemoryResource
+    {
+    public:
+        explicit PagePool(MemoryResource& upstream) noexcept;
+        ~PagePool() noexcept override;
+
+        PagePool(const PagePool&) = delete;
+        PagePool& operator=(const PagePool&) = delete;
+
+        [[nodiscard]] void* Allocate(std::size_t size, std::size_t alignment) override;
+        void Deallocate(void* memory, std::size_t size, std::size_t alignment) noexcept override;
+
+        // Returns every cached page to the upstream resource.
+        void Trim() noexcept;
+
+        [[nodiscard]] wIndex GetCachedPageCount() const noexcept;
+        [[nodiscard]] std::size_t GetCachedBytes() const noexcept;
+
+    private:
+        struct Bucket
+        {
+            std::size_t size;
+            std::size_t alignment;
+            std::vector<void*> pages;
+            wIndex outstanding; // Handed out pages, pages keeps room for all of them
+        };
+
+        [[nodiscard]] Bucket& GetBucket(std::size_t size, std::size_t alignment);
+        [[nodiscard]] Bucket* FindBucket(std::size_t size, std::size_t alignment) noexcept;
+
+        MemoryResource& m_upstream;
+        std::vector<Bucket> m_buckets;
+    };
+
+    // Epoch based reclamation. Deallocate only retires memory, Reclaim frees what no reader can still be looking at.
+    // Readers bracket their accesses with EnterRead and ExitRead, which nest and never block. Each thread that reads
+    // takes one of MaxReaderThreads slots, shared by every EpochMemoryResource, and returns it when it exits. More
+    // threads reading at the same time abort.
+    class EpochMemoryResource final : public MemoryResource
+    {
+    public:
+        static constexpr wIndex MaxReaderThreads = 128;
+
+        explicit EpochMemoryResource(MemoryResource& upstream);
+        // Frees everything still retired, no reader may be active.
+        ~EpochMemoryResource() noexcept override;
+
+        EpochMemoryResource(const EpochMemoryResource&) = delete;
+        EpochMemoryResource& operator=(const EpochMemoryResource&) = delete;
+
+        [[nodiscard]] void* Allocate(std::size_t size, std::size_t alignment) override;
+        void Deallocate(void* memory, std::size_t size, std::size_t alignment) noexcept override;
+
+        void EnterRead() noexcept;
+        void ExitRead() noexcept;
+        [[nodiscard]] bool IsReading() const noexcept;
+
+        // Called by the writer, frees every retirement older than the oldest active reader.
+        void Reclaim() noexcept;
+
+        [[nodiscard]] wIndex GetRetiredCount() const noexcept;
+
+    private:
+        struct alignas(64) ReaderSlot
+        {
+            std::atomic<uint64_t> epoch; // 0 while not reading
+            wIndex depth; // Only touched by the owning thread
+        };
+
+        struct Retired
+        {
+            void* memory;
+            std::size_t size;
+            std::size_t alignment;
+            uint64_t epoch;
+        };
+
+        [[nodiscard]] static wIndex GetThreadSlot() noexcept;
+
+        MemoryResource& m_upstream;
+        std::atomic<uint64_t> m_epoch;
+        std::unique_ptr<ReaderSlot[]> m_readers;
+        mutable std::mutex m_retiredMutex; // Staged scenes may free from worker threads
+        std::vector<Retired> m_retired;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,121 @@
+#ifndef TUNGSTEN_CORE_PROFILER_HPP
+#define TUNGSTEN_CORE_PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "TungstenUtils/TungstenUtils.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+    #define TUNGSTEN_CORE_PROFILER_TSC
+#endif
+
+namespace wCore
+{
+    // Records scoped zones into a ring buffer per thread and exports them as a Chrome trace, which chrome://tracing and
+    // Perfetto open offline. Zones are only compiled in with the TUNGSTENCORE_ENABLE_PROFILER CMake option, see
+    // W_PROFILE_ZONE. Each zone takes two timestamp reads and one store into memory owned by its thread. On x86-64 the
+    // timestamps are invariant TSC ticks, converted to nanoseconds against the steady clock when exporting.
+    class Profiler
+    {
+    public:
+        // Zones kept per thread, older ones are overwritten.
+        static constexpr wIndex ThreadEventCapacity = 64 * 1024;
+
+        struct Event
+        {
+            const char* name; // Must outlive the export, use InternName for names that are not literals
+            uint64_t begin; // Ticks of Now
+            uint64_t end;
+        };
+
+        [[nodiscard]] static inline uint64_t Now() noexcept
+        {
+#if defined(TUNGSTEN_CORE_PROFILER_TSC)
+            return __rdtsc();
+#else
+            return GetSteadyNanoseconds();
+#endif
+        }
+        [[nodiscard]] static inline uint64_t GetSteadyNanoseconds() noexcept { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+        static inline void Record(const char* name, uint64_t begin, uint64_t end) noexcept
+        {
+            ThreadBuffer& buffer = GetThreadBuffer();
+            const uint64_t written = buffer.written.load(std::memory_order_relaxed);
+            buffer.events[written % ThreadEventCapacity] = { name, begin, end };
+            buffer.written.store(written + 1, std::memory_order_release);
+        }
+
+        // Names the calling thread in the trace.
+        static void SetThreadName(std::string_view name);
+        // Returns a copy of name that lives until the process exits, equal names share one copy.
+        [[nodiscard]] static const char* InternName(std::string_view name);
+
+        // Writes every recorded zone of every thread. Threads should not be recording while this runs, call it
+        // between frames. Returns false if the file could not be written.
+        [[nodiscard]] static bool WriteChromeTrace(const std::filesystem::path& path);
+        static void Clear() noexcept;
+
+    private:
+        struct ThreadBuffer
+        {
+            std::unique_ptr<Event[]> events;
+            std::atomic<uint64_t> written;
+            wIndex threadId;
+            std::string name;
+        };
+
+        [[nodiscard]] static inline ThreadBuffer& GetThreadBuffer() noexcept
+        {
+            thread_local ThreadBuffer* t_buffer = RegisterThread();
+            return *t_buffer;
+        }
+
+        // Buffers are owned by the Profiler and outlive their thread, so zones of finished threads are still exported.
+        [[nodiscard]] static ThreadBuffer* RegisterThread();
+        [[nodiscard]] static std::mutex& GetMutex() noexcept;
+        [[nodiscard]] static std::vector<ThreadBuffer*>& GetThreadBuffers() noexcept;
+
+        // A tick and steady clock pair taken when the first thread registers, the start of the calibration.
+        static inline uint64_t s_calibrationTicks = 0;
+        static inline uint64_t s_calibrationNanoseconds = 0;
+    };
+
+    class ProfileZone
+    {
+    public:
+        explicit ProfileZone(const char* name) noexcept
+            : m_name(name), m_begin(Profiler::Now()) {}
+        ~ProfileZone() noexcept { Profiler::Record(m_name, m_begin, Profiler::Now()); }
+
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+
+    private:
+        const char* m_name;
+        uint64_t m_begin;
+    };
+}
+
+#if defined(TUNGSTEN_CORE_PROFILER)
+    #define W_PROFILE_CONCAT_IMPL(a, b) a##b
+    #define W_PROFILE_CONCAT(a, b) W_PROFILE_CONCAT_IMPL(a, b)
+    #define W_PROFILE_ZONE(name) const ::wCore::ProfileZone W_PROFILE_CONCAT(wProfileZone, __LINE__)(name)
+    #define W_PROFILE_THREAD(name) ::wCore::Profiler::SetThreadName(name)
+#else
+    #define W_PROFILE_ZONE(name) ((void)0)
+    #define W_PROFILE_THREAD(name) ((void)0)
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef TUNGSTEN_CORE_SCENE_SNAPSHOT_HPP
+#define TUNGSTEN_CORE_SCENE_SNAPSHOT_HPP
+
+#include <filesystem>
+#include <span>
+#include "TungstenCore/ComponentSystem.hpp"
+
+namespace wCore
+{
+    enum class SnapshotResult : uint8_t
+    {
+        Success,
+        FileError,
+        InvalidFormat, // Bad magic, byte order, index width or out of range sections
+        VersionMismatch,
+        TypeMismatch, // A list in the file names an unknown type or its size, alignment or storage differs
+        UnsupportedType // Only trivially copyable types in dense or paged lists can be saved
+    };
+
+    // Binary image of the dense and paged lists of one scene.
+    // Every list is stored as it sits in memory: a dense list is one block in the ComponentBlockLayout of its slot count,
+    // a paged list is its slots followed by its generations. Sections are addressed by file offsets aligned to 64 bytes, so
+    // the file is relocatable and loading is a single memcpy per dense list and per page. Free lists are rebuilt on load
+    // from the free slots, so the order in which slots are reused may differ from the saved scene.
+    class SceneSnapshot
+    {
+    public:
+        static constexpr uint32_t Version = 2;
+        static constexpr std::size_t SectionAlignment = 64;
+
+        [[nodiscard]] static SnapshotResult Save(const ComponentSystem& componentSystem, SceneHandle sceneHandle, const std::filesystem::path& path);
+
+        // Maps the file and loads it into a new scene. On failure the returned SceneHandle is invalid and nothing is created.
+        [[nodiscard]] static std::pair<SnapshotResult, SceneHandle> Load(ComponentSystem& componentSystem, const std::filesystem::path& path, std::string_view sceneName = "");
+
+        // Loads from bytes the caller already has in memory, for example a mapping or a streamed buffer.
+        [[nodiscard]] static std::pair<SnapshotResult, SceneHandle> Load(ComponentSystem& componentSystem, std::span<const std::byte> data, std::string_view sceneName = "");
+
+        // Checks the header and every list against the ComponentSetup without creating anything.
+        [[nodiscard]] static SnapshotResult Validate(const ComponentSystem& componentSystem, std::span<const std::byte> data);
+    };
+}
+
+#endif
\ No newline at end of file
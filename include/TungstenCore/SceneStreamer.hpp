@@ -0,0 +1,105 @@
+#ifndef TUNGSTEN_CORE_SCENE_STREAMER_HPP
+#define TUNGSTEN_CORE_SCENE_STREAMER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "TungstenCore/ComponentSystem.hpp"
+#include "TungstenCore/JobSystem.hpp"
+
+namespace wCore
+{
+    class SceneStream;
+
+    // Runs on a JobSystem worker. Poll SceneStream::IsCancelRequested to stop early.
+    using SceneBuildFn = std::function<void(StagedScene& scene, SceneStream& stream)>;
+
+    // Progress and cancellation of one streamed scene, shared between the requester, the build job and the SceneStreamer.
+    class SceneStream
+    {
+    public:
+        enum class State : uint8_t
+        {
+            Queued,
+            Building,
+            Ready, // Built, waiting for a commit
+            Committed,
+            Cancelled
+        };
+
+        SceneStream(const SceneStream&) = delete;
+        SceneStream& operator=(const SceneStream&) = delete;
+
+        [[nodiscard]] inline State GetState() const noexcept { return m_state.load(std::memory_order_acquire); }
+        [[nodiscard]] inline bool IsDone() const noexcept { const State state = GetState(); return state == State::Committed || state == State::Cancelled; }
+
+        // Set by the build function, from 0 to 1.
+        inline void SetProgress(float progress) noexcept { m_progress.store(progress, std::memory_order_relaxed); }
+        [[nodiscard]] inline float GetProgress() const noexcept { return m_progress.load(std::memory_order_relaxed); }
+
+        // The staged scene is discarded instead of committed. Has no effect once committed.
+        inline void Cancel() noexcept { m_cancelRequested.store(true, std::memory_order_relaxed); }
+        [[nodiscard]] inline bool IsCancelRequested() const noexcept { return m_cancelRequested.load(std::memory_order_relaxed); }
+
+        [[nodiscard]] inline SceneHandle GetScene() const noexcept { W_ASSERT(GetState() == State::Committed, "SceneStream is not committed"); return m_scene; }
+
+        // Attaches the committed scene to a handle returned by the StagedScene.
+        template<typename T>
+        [[nodiscard]] inline ComponentHandle<T> Resolve(ComponentHandle<T> stagedHandle) const noexcept { return ComponentHandle<T>(GetScene(), stagedHandle.componentIndex, stagedHandle.generation); }
+
+    private:
+        friend class SceneStreamer;
+
+        SceneStream(std::unique_ptr<StagedScene> stagedScene, SceneBuildFn build) noexcept
+            : m_state(State::Queued), m_progress(0.0f), m_cancelRequested(false), m_stagedScene(std::move(stagedScene)), m_build(std::move(build)), m_counter(), m_scene() {}
+
+        std::atomic<State> m_state;
+        std::atomic<float> m_progress;
+        std::atomic<bool> m_cancelRequested;
+        std::unique_ptr<StagedScene> m_stagedScene;
+        SceneBuildFn m_build;
+        JobCounter m_counter;
+        SceneHandle m_scene;
+    };
+
+    // Builds scenes on the JobSystem and commits them at frame boundaries. A commit only claims a scene slot and copies
+    // the list headers, and Update stops committing once its time budget is used, so streaming does not cause hitches.
+    class SceneStreamer
+    {
+    public:
+        struct Config
+        {
+            std::chrono::microseconds commitBudget = std::chrono::microseconds(1000);
+        };
+
+        SceneStreamer(ComponentSystem& componentSystem, JobSystem& jobSystem, const Config& config) noexcept;
+        // Waits for running builds and discards every scene that was not committed.
+        ~SceneStreamer() noexcept;
+
+        SceneStreamer(const SceneStreamer&) = delete;
+        SceneStreamer& operator=(const SceneStreamer&) = delete;
+
+        [[nodiscard]] std::shared_ptr<SceneStream> Stream(SceneBuildFn build);
+
+        // Commits or discards finished builds in request order until the budget is used, at least one per call.
+        // A finished build waits behind an older one that is still running. Without JobSystem workers the oldest
+        // pending build runs here instead. No component types may be added while streams are pending.
+        inline void Update() { Update(m_config.commitBudget); }
+        void Update(std::chrono::microseconds budget);
+
+        [[nodiscard]] inline wIndex GetPendingCount() const noexcept { return m_streams.size(); }
+
+    private:
+        static void Build(SceneStream& stream);
+        void Finish(SceneStream& stream);
+
+        ComponentSystem& m_componentSystem;
+        JobSystem& m_jobSystem;
+        Config m_config;
+        std::vector<std::shared_ptr<SceneStream>> m_streams;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef TUNGSTEN_CORE_SIMD_KERNELS_HPP
+#define TUNGSTEN_CORE_SIMD_KERNELS_HPP
+
+#include <array>
+#include <span>
+#include <type_traits>
+#include "TungstenUtils/TungstenUtils.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define TUNGSTEN_CORE_SIMD_X86
+#endif
+
+namespace wCore
+{
+    enum class SimdLevel : uint8_t
+    {
+        Scalar,
+        SSE41,
+        AVX2, // With FMA
+        AVX512 // AVX-512F
+    };
+
+    // Six planes with inward normals, a point p is inside a plane if dot(normal, p) + distance >= 0.
+    struct Frustum
+    {
+        std::array<std::array<float, 4>, 6> planes; // normal x, y, z, distance
+    };
+
+    // Float kernels over component data that is already contiguous. Every input is a stream of floats read with a
+    // stride in floats: 1 for a separate stream, such as an archetype column of a float component, or the float count
+    // of T to read one field out of a dense span of T. Dense blocks and archetype columns start on a SimdAlignment
+    // boundary, unaligned streams still work.
+    // The widest level the CPU supports is picked on first use. FMA levels may round differently from the others.
+    class SimdKernels
+    {
+    public:
+        static constexpr std::size_t SimdAlignment = 64;
+
+        // Views a span of a type made of floats only, like a position or an AABB, as its floats.
+        template<typename T>
+        [[nodiscard]] static inline std::span<float> AsFloats(std::span<T> components) noexcept
+        {
+            static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % sizeof(float) == 0 && alignof(T) == alignof(float), "Type is not made of floats");
+            return { reinterpret_cast<float*>(components.data()), components.size() * (sizeof(T) / sizeof(float)) };
+        }
+
+        [[nodiscard]] static SimdLevel GetLevel() noexcept;
+        [[nodiscard]] static SimdLevel GetSupportedLevel() noexcept;
+        // Caps the level, for example to compare levels in a benchmark. Levels the CPU does not support are clamped.
+        static void SetMaxLevel(SimdLevel level) noexcept;
+
+        // values[i] += deltas[i] * scale. Integrating packed positions by packed velocities is one call over 3 * count floats.
+        static void MultiplyAdd(float* values, const float* deltas, float scale, wIndex count) noexcept;
+
+        // mins[i] = centers[i] - halfExtents[i], maxs[i] = centers[i] + halfExtents[i], over packed or separate axes.
+        static void UpdateAabbs(const float* centers, const float* halfExtents, float* mins, float* maxs, wIndex count) noexcept;
+
+        // Writes the indices of the spheres inside or intersecting the frustum in ascending order and returns their count.
+        [[nodiscard]] static wIndex CullSpheres(const float* x, const float* y, const float* z, const float* radii, std::size_t stride, wIndex count, const Frustum& frustum, wIndex* outIndices) noexcept;
+
+        // Writes the indices of the points within maxDistance of center in ascending order and returns their count.
+        [[nodiscard]] static wIndex CullDistance(const float* x, const float* y, const float* z, std::size_t stride, wIndex count, const std::array<float, 3>& center, float maxDistance, wIndex* outIndices) noexcept;
+
+    private:
+        struct Kernels
+        {
+            void(*multiplyAdd)(float* values, const float* deltas, float scale, wIndex count) noexcept;
+            void(*updateAabbs)(const float* centers, const float* halfExtents, float* mins, float* maxs, wIndex count) noexcept;
+            wIndex(*cullSpheres)(const float* x, const float* y, const float* z, const float* radii, std::size_t stride, wIndex count, const Frustum& frustum, wIndex* outIndices) noexcept;
+            wIndex(*cullDistance)(const float* x, const float* y, const float* z, std::size_t stride, wIndex count, const std::array<float, 3>& center, float maxDistance, wIndex* outIndices) noexcept;
+        };
+
+        [[nodiscard]] static const Kernels& GetKernels() noexcept;
+        [[nodiscard]] static const Kernels& GetKernels(SimdLevel level) noexcept;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,448 @@
+#ifndef TUNGSTEN_CORE_SPATIAL_GRID_HPP
+#define TUNGSTEN_CORE_SPATIAL_GRID_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <vector>
+#include "TungstenCore/ComponentSystem.hpp"
+#include "TungstenCore/JobSystem.hpp"
+
+namespace wCore
+{
+    struct SpatialBounds
+    {
+        [[nodiscard]] static constexpr SpatialBounds Point(float x, float y, float z) noexcept { return { { x, y, z }, { x, y, z } }; }
+        [[nodiscard]] static constexpr SpatialBounds Sphere(float x, float y, float z, float radius) noexcept { return { { x - radius, y - radius, z - radius }, { x + radius, y + radius, z + radius } }; }
+
+        [[nodiscard]] constexpr bool Overlaps(const SpatialBounds& other) const noexcept
+        {
+            return min[0] <= other.max[0] && other.min[0] <= max[0]
+                && min[1] <= other.max[1] && other.min[1] <= max[1]
+                && min[2] <= other.max[2] && other.min[2] <= max[2];
+        }
+
+        [[nodiscard]] constexpr float GetDistanceSquared(const std::array<float, 3>& point) const noexcept
+        {
+            float distanceSquared = 0.0f;
+            for (wIndex axis = 0; axis < 3; ++axis)
+            {
+                const float delta = std::max({ min[axis] - point[axis], 0.0f, point[axis] - max[axis] });
+                distanceSquared += delta * delta;
+            }
+            return distanceSquared;
+        }
+
+        // Distance along the ray to the first point inside, 0 if the origin is inside, negative if the ray misses
+        // within maxDistance. A ray along a face counts as a hit.
+        [[nodiscard]] inline float Raycast(const std::array<float, 3>& origin, const std::array<float, 3>& inverseDirection, float maxDistance) const noexcept
+        {
+            float entry = 0.0f;
+            float exit = maxDistance;
+            for (wIndex axis = 0; axis < 3; ++axis)
+            {
+                // 0 * inf is NaN for a ray along a face, std::min and std::max then keep the other operand
+                const float t0 = (min[axis] - origin[axis]) * inverseDirection[axis];
+                const float t1 = (max[axis] - origin[axis]) * inverseDirection[axis];
+                entry = std::max(entry, std::min(t0, t1));
+                exit = std::min(exit, std::max(t0, t1));
+            }
+            return entry <= exit ? entry : -1.0f;
+        }
+
+        std::array<float, 3> min;
+        std::array<float, 3> max;
+    };
+
+    struct SpatialRayHit
+    {
+        ComponentIndex componentIndex; // InvalidComponent if nothing was hit
+        float distance;
+    };
+
+    // Loose uniform grid over the dense list of T in one scene, for radius, bounds and ray queries.
+    // BoundsFn is a function or captureless lambda that maps a const T& to its SpatialBounds, for example the world
+    // translation of a Transform. The grid stores no copy of the components, only per slot the cell the center of the
+    // bounds falls into and the links of the cell's bucket, and reads the bounds from the dense list when querying.
+    // Objects may reach out of their cell by the largest half extent seen, which queries add to their range, so the cell
+    // size should be about the size of the larger common objects. Cells are hashed into a fixed number of buckets, so the
+    // grid is unbounded.
+    //
+    // Update follows the change versions of the list: only blocks written since the last Update are visited, destroyed
+    // components are dropped with one pass over the slots. Writes through ComponentSystem::GetComponent must be stamped
+    // with MarkChanged to be seen. Only for dense lists, queries and updates must not overlap structural changes.
+    template<typename T, auto BoundsFn>
+    class SpatialGrid
+    {
+        static_assert(std::is_nothrow_invocable_r_v<SpatialBounds, decltype(BoundsFn), const T&>, "Bounds functions must be nothrow-invocable with const T& and return SpatialBounds");
+
+    public:
+        struct Config
+        {
+            float cellSize = 8.0f;
+            wIndex bucketCount = 4096; // Rounded up to a power of two
+        };
+
+        // Jobs of the parallel Rebuild
+        static constexpr wIndex RebuildGrainSize = 4096;
+
+        SpatialGrid(ComponentSystem& componentSystem, SceneHandle sceneHandle)
+            : SpatialGrid(componentSystem, sceneHandle, Config()) {}
+
+        SpatialGrid(ComponentSystem& componentSystem, SceneHandle sceneHandle, const Config& config)
+            : m_componentSystem(&componentSystem), m_sceneHandle(sceneHandle), m_entries(), m_buckets(std::bit_ceil(std::max<wIndex>(config.bucketCount, 1)), InvalidComponent),
+            m_cellSize(config.cellSize), m_inverseCellSize(1.0f / config.cellSize), m_maxExtent(0.0f), m_count(0), m_version(ChangeVersionStart)
+        {
+            W_ASSERT(config.cellSize > 0.0f, "SpatialGrid cell size must be positive");
+        }
+
+        // Re-buckets the components written since the last Update or Rebuild and drops the destroyed ones.
+        void Update()
+        {
+            W_PROFILE_ZONE("SpatialGrid::Update");
+            const DenseListView list = GetList();
+            if (m_entries.size() < list.slotCount)
+            {
+                m_entries.resize(list.slotCount);
+            }
+
+            const T* const dense = static_cast<const T*>(list.dense);
+            const wIndex blockCount = GetChangeBlockCount(list.denseCount);
+            for (wIndex blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+            {
+                if (list.versions[blockIndex] < m_version)
+                {
+                    continue;
+                }
+                const wIndex blockEnd = std::min((blockIndex + 1) * ChangeBlockSize, list.denseCount);
+                for (wIndex densePosition = blockIndex * ChangeBlockSize; densePosition < blockEnd; ++densePosition)
+                {
+                    const ComponentIndex componentIndex = list.denseToSlot[densePosition];
+                    Entry& entry = m_entries[componentIndex - 1];
+                    const Cell cell = Place(BoundsFn(dense[densePosition]), m_maxExtent);
+                    if (entry.linked && entry.cell == cell)
+                    {
+                        continue;
+                    }
+                    if (entry.linked)
+                    {
+                        Unlink(componentIndex);
+                    }
+                    entry.cell = cell;
+                    Link(componentIndex);
+                }
+            }
+
+            // Every live component is linked, so more links than components means some were destroyed
+            if (m_count != list.denseCount)
+            {
+                for (ComponentIndex componentIndex = ComponentIndexStart; componentIndex <= m_entries.size(); ++componentIndex)
+                {
+                    if (m_entries[componentIndex - 1].linked && !list.Contains(componentIndex))
+                    {
+                        Unlink(componentIndex);
+                    }
+                }
+            }
+            m_version = m_componentSystem->GetChangeVersion();
+        }
+
+        // Rebuilds from the dense list, the bounds of the components are computed in parallel and linked in one pass.
+        // Also shrinks the reach of the cells back to the largest object that is left.
+        void Rebuild(JobSystem& jobSystem)
+        {
+            W_PROFILE_ZONE("SpatialGrid::Rebuild");
+            const DenseListView list = GetList();
+            ResetLinks(list.slotCount);
+
+            const T* const dense = static_cast<const T*>(list.dense);
+            std::vector<float> extents((list.denseCount + RebuildGrainSize - 1) / RebuildGrainSize, 0.0f);
+            jobSystem.ParallelFor(0, list.denseCount, RebuildGrainSize, [this, &list, dense, &extents](wIndex begin, wIndex end)
+            {
+                float extent = 0.0f;
+                for (wIndex densePosition = begin; densePosition < end; ++densePosition)
+                {
+                    m_entries[list.denseToSlot[densePosition] - 1].cell = Place(BoundsFn(dense[densePosition]), extent);
+                }
+                extents[begin / RebuildGrainSize] = extent;
+            });
+            m_maxExtent = extents.empty() ? 0.0f : *std::max_element(extents.begin(), extents.end());
+
+            LinkAll(list);
+        }
+
+        void Rebuild()
+        {
+            const DenseListView list = GetList();
+            ResetLinks(list.slotCount);
+
+            const T* const dense = static_cast<const T*>(list.dense);
+            for (wIndex densePosition = 0; densePosition < list.denseCount; ++densePosition)
+            {
+                m_entries[list.denseToSlot[densePosition] - 1].cell = Place(BoundsFn(dense[densePosition]), m_maxExtent);
+            }
+            LinkAll(list);
+        }
+
+        // Calls fn(ComponentIndex, const T&) for every component whose bounds overlap bounds.
+        template<typename Fn>
+        void QueryBounds(const SpatialBounds& bounds, Fn&& fn) const
+        {
+            Query(bounds, [&bounds, &fn](ComponentIndex componentIndex, const T& component, const SpatialBounds& componentBounds)
+            {
+                if (componentBounds.Overlaps(bounds))
+                {
+                    fn(componentIndex, component);
+                }
+            });
+        }
+
+        // Calls fn(ComponentIndex, const T&) for every component whose bounds are within radius of center.
+        template<typename Fn>
+        void QueryRadius(const std::array<float, 3>& center, float radius, Fn&& fn) const
+        {
+            const float radiusSquared = radius * radius;
+            Query(SpatialBounds::Sphere(center[0], center[1], center[2], radius), [&center, radiusSquared, &fn](ComponentIndex componentIndex, const T& component, const SpatialBounds& componentBounds)
+            {
+                if (componentBounds.GetDistanceSquared(center) <= radiusSquared)
+                {
+                    fn(componentIndex, component);
+                }
+            });
+        }
+
+        // Closest component whose bounds the ray enters within maxDistance. Walks the cells along the ray and stops at
+        // the first cell that ends behind the closest hit, so maxDistance must be finite.
+        [[nodiscard]] SpatialRayHit Raycast(const std::array<float, 3>& origin, const std::array<float, 3>& direction, float maxDistance) const noexcept
+        {
+            W_ASSERT(std::isfinite(maxDistance), "SpatialGrid::Raycast needs a finite max distance");
+            SpatialRayHit hit = { InvalidComponent, maxDistance };
+            const float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+            if (length == 0.0f || !m_count)
+            {
+                return hit;
+            }
+
+            const DenseListView list = GetList();
+            const T* const dense = static_cast<const T*>(list.dense);
+            const int32_t reach = static_cast<int32_t>(std::min(std::ceil(m_maxExtent * m_inverseCellSize), MaxCellCoordinate));
+
+            std::array<float, 3> unitDirection;
+            std::array<float, 3> inverseDirection;
+            Cell cell;
+            std::array<int32_t, 3> step;
+            std::array<float, 3> next; // Distance to the next cell boundary per axis
+            std::array<float, 3> delta; // Distance between cell boundaries per axis
+            for (wIndex axis = 0; axis < 3; ++axis)
+            {
+                unitDirection[axis] = direction[axis] / length;
+                inverseDirection[axis] = 1.0f / unitDirection[axis];
+                cell[axis] = ToCell(origin[axis]);
+                step[axis] = unitDirection[axis] > 0.0f ? 1 : -1;
+                const float boundary = static_cast<float>(cell[axis] + (unitDirection[axis] > 0.0f ? 1 : 0)) * m_cellSize;
+                next[axis] = unitDirection[axis] != 0.0f ? (boundary - origin[axis]) * inverseDirection[axis] : INFINITY;
+                delta[axis] = std::abs(m_cellSize * inverseDirection[axis]);
+            }
+
+            // A hit inside the cells walked so far lies in a cell whose objects were all tested, within reach of it
+            for (;;)
+            {
+                ForEachCell({ cell[0] - reach, cell[1] - reach, cell[2] - reach }, { cell[0] + reach, cell[1] + reach, cell[2] + reach }, [&](ComponentIndex componentIndex)
+                {
+                    const float distance = BoundsFn(dense[list.slotToDense[componentIndex - 1] - 1]).Raycast(origin, inverseDirection, hit.distance);
+                    if (distance >= 0.0f && (hit.componentIndex == InvalidComponent || distance < hit.distance))
+                    {
+                        hit = { componentIndex, distance };
+                    }
+                });
+
+                const wIndex axis = next[0] < next[1] ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2);
+                const float cellExit = next[axis];
+                if (cellExit >= maxDistance || (hit.componentIndex != InvalidComponent && hit.distance <= cellExit))
+                {
+                    return hit;
+                }
+                cell[axis] += step[axis];
+                next[axis] += delta[axis];
+            }
+        }
+
+        [[nodiscard]] inline wIndex GetCount() const noexcept { return m_count; }
+        [[nodiscard]] inline SceneHandle GetSceneHandle() const noexcept { return m_sceneHandle; }
+        [[nodiscard]] inline float GetCellSize() const noexcept { return m_cellSize; }
+        // How far objects reach out of their cell, the largest half extent seen since the last Rebuild.
+        [[nodiscard]] inline float GetMaxExtent() const noexcept { return m_maxExtent; }
+
+    private:
+        using Cell = std::array<int32_t, 3>;
+
+        // Cells past this are clamped, far away objects share the outermost cells
+        static constexpr float MaxCellCoordinate = 1 << 30;
+
+        struct Entry
+        {
+            Cell cell = {};
+            ComponentIndex previous = InvalidComponent;
+            ComponentIndex next = InvalidComponent;
+            bool linked = false;
+        };
+
+        [[nodiscard]] inline DenseListView GetList() const noexcept
+        {
+            W_ASSERT(m_componentSystem->SceneExists(m_sceneHandle), "Scene: {} of the SpatialGrid does not exist", m_sceneHandle.sceneIndex);
+            return m_componentSystem->template GetDenseListView<T>(m_sceneHandle.sceneIndex);
+        }
+
+        [[nodiscard]] inline int32_t ToCell(float coordinate) const noexcept
+        {
+            return static_cast<int32_t>(std::clamp(std::floor(coordinate * m_inverseCellSize), -MaxCellCoordinate, MaxCellCoordinate));
+        }
+
+        [[nodiscard]] inline Cell Place(const SpatialBounds& bounds, float& maxExtent) const noexcept
+        {
+            Cell cell;
+            for (wIndex axis = 0; axis < 3; ++axis)
+            {
+                maxExtent = std::max(maxExtent, (bounds.max[axis] - bounds.min[axis]) * 0.5f);
+                cell[axis] = ToCell((bounds.min[axis] + bounds.max[axis]) * 0.5f);
+            }
+            return cell;
+        }
+
+        [[nodiscard]] inline wIndex GetBucket(const Cell& cell) const noexcept
+        {
+            const uint32_t hash = static_cast<uint32_t>(cell[0]) * 73856093u ^ static_cast<uint32_t>(cell[1]) * 19349663u ^ static_cast<uint32_t>(cell[2]) * 83492791u;
+            return hash & (m_buckets.size() - 1);
+        }
+
+        void Link(ComponentIndex componentIndex) noexcept
+        {
+            Entry& entry = m_entries[componentIndex - 1];
+            ComponentIndex& head = m_buckets[GetBucket(entry.cell)];
+            entry.previous = InvalidComponent;
+            entry.next = head;
+            entry.linked = true;
+            if (head != InvalidComponent)
+            {
+                m_entries[head - 1].previous = componentIndex;
+            }
+            head = componentIndex;
+            ++m_count;
+        }
+
+        void Unlink(ComponentIndex componentIndex) noexcept
+        {
+            Entry& entry = m_entries[componentIndex - 1];
+            if (entry.previous != InvalidComponent)
+            {
+                m_entries[entry.previous - 1].next = entry.next;
+            }
+            else
+            {
+                m_buckets[GetBucket(entry.cell)] = entry.next;
+            }
+            if (entry.next != InvalidComponent)
+            {
+                m_entries[entry.next - 1].previous = entry.previous;
+            }
+            entry.linked = false;
+            --m_count;
+        }
+
+        void ResetLinks(wIndex slotCount)
+        {
+            m_entries.assign(slotCount, Entry());
+            std::fill(m_buckets.begin(), m_buckets.end(), InvalidComponent);
+            m_maxExtent = 0.0f;
+            m_count = 0;
+        }
+
+        void LinkAll(const DenseListView& list) noexcept
+        {
+            for (wIndex densePosition = 0; densePosition < list.denseCount; ++densePosition)
+            {
+                Link(list.denseToSlot[densePosition]);
+            }
+            m_version = m_componentSystem->GetChangeVersion();
+        }
+
+        // Calls fn(ComponentIndex) for every component whose cell lies in [first, last].
+        template<typename Fn>
+        void ForEachCell(const Cell& first, const Cell& last, Fn&& fn) const
+        {
+            const auto inRange = [&first, &last](const Cell& cell)
+            {
+                return cell[0] >= first[0] && cell[0] <= last[0] && cell[1] >= first[1] && cell[1] <= last[1] && cell[2] >= first[2] && cell[2] <= last[2];
+            };
+
+            // Past one cell per bucket, walking every bucket once is cheaper and visits no bucket twice
+            const double cellCount = (static_cast<double>(last[0]) - first[0] + 1) * (static_cast<double>(last[1]) - first[1] + 1) * (static_cast<double>(last[2]) - first[2] + 1);
+            if (cellCount > static_cast<double>(m_buckets.size()))
+            {
+                for (ComponentIndex head : m_buckets)
+                {
+                    for (ComponentIndex componentIndex = head; componentIndex != InvalidComponent; componentIndex = m_entries[componentIndex - 1].next)
+                    {
+                        if (inRange(m_entries[componentIndex - 1].cell))
+                        {
+                            fn(componentIndex);
+                        }
+                    }
+                }
+                return;
+            }
+
+            // Cells sharing a bucket are told apart by the cell of every entry
+            Cell cell;
+            for (cell[2] = first[2]; cell[2] <= last[2]; ++cell[2])
+            {
+                for (cell[1] = first[1]; cell[1] <= last[1]; ++cell[1])
+                {
+                    for (cell[0] = first[0]; cell[0] <= last[0]; ++cell[0])
+                    {
+                        for (ComponentIndex componentIndex = m_buckets[GetBucket(cell)]; componentIndex != InvalidComponent; componentIndex = m_entries[componentIndex - 1].next)
+                        {
+                            if (m_entries[componentIndex - 1].cell == cell)
+                            {
+                                fn(componentIndex);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Calls fn(ComponentIndex, const T&, const SpatialBounds&) for every component whose center lies within the
+        // largest extent of bounds.
+        template<typename Fn>
+        void Query(const SpatialBounds& bounds, Fn&& fn) const
+        {
+            if (!m_count)
+            {
+                return;
+            }
+            const DenseListView list = GetList();
+            const T* const dense = static_cast<const T*>(list.dense);
+            const Cell first = { ToCell(bounds.min[0] - m_maxExtent), ToCell(bounds.min[1] - m_maxExtent), ToCell(bounds.min[2] - m_maxExtent) };
+            const Cell last = { ToCell(bounds.max[0] + m_maxExtent), ToCell(bounds.max[1] + m_maxExtent), ToCell(bounds.max[2] + m_maxExtent) };
+            ForEachCell(first, last, [&list, dense, &fn](ComponentIndex componentIndex)
+            {
+                const T& component = dense[list.slotToDense[componentIndex - 1] - 1];
+                fn(componentIndex, component, BoundsFn(component));
+            });
+        }
+
+        ComponentSystem* m_componentSystem;
+        SceneHandle m_sceneHandle;
+        std::vector<Entry> m_entries; // By slot
+        std::vector<ComponentIndex> m_buckets; // First slot of every bucket
+        float m_cellSize;
+        float m_inverseCellSize;
+        float m_maxExtent;
+        wIndex m_count; // Linked slots
+        ChangeVersion m_version; // Blocks stamped at or after it are visited by the next Update
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef TUNGSTEN_CORE_SYSTEM_SCHEDULER_HPP
+#define TUNGSTEN_CORE_SYSTEM_SCHEDULER_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TungstenCore/ComponentSetup.hpp"
+#include "TungstenCore/JobSystem.hpp"
+
+namespace wCore
+{
+    using SystemIndex = wIndex;
+    inline constexpr SystemIndex InvalidSystem = 0;
+    inline constexpr SystemIndex SystemIndexStart = 1;
+
+    using SystemFn = std::function<void(Application& app)>;
+
+    class SystemAccess
+    {
+    public:
+        explicit SystemAccess(const ComponentSetup& componentSetup) noexcept
+            : m_componentSetup(&componentSetup) {}
+
+        template<typename... Ts>
+        inline SystemAccess& Reads() { (Read(m_componentSetup->GetComponentTypeIndex<Ts>()), ...); return *this; }
+
+        template<typename... Ts>
+        inline SystemAccess& Writes() { (Write(m_componentSetup->GetComponentTypeIndex<Ts>()), ...); return *this; }
+
+        SystemAccess& Read(ComponentTypeIndex componentTypeIndex);
+        SystemAccess& Write(ComponentTypeIndex componentTypeIndex);
+
+        // Explicit ordering on top of the data dependencies.
+        SystemAccess& After(SystemIndex systemIndex);
+
+        // Returns the first component type one side writes and the other touches, InvalidComponentType if there is none.
+        [[nodiscard]] ComponentTypeIndex FindConflict(const SystemAccess& other) const noexcept;
+        [[nodiscard]] inline bool ConflictsWith(const SystemAccess& other) const noexcept { return FindConflict(other) != InvalidComponentType; }
+
+        [[nodiscard]] inline const std::vector<ComponentTypeIndex>& GetReads() const noexcept { return m_reads; }
+        [[nodiscard]] inline const std::vector<ComponentTypeIndex>& GetWrites() const noexcept { return m_writes; }
+        [[nodiscard]] inline const std::vector<SystemIndex>& GetAfter() const noexcept { return m_after; }
+
+    private:
+        const ComponentSetup* m_componentSetup;
+        std::vector<ComponentTypeIndex> m_reads;
+        std::vector<ComponentTypeIndex> m_writes;
+        std::vector<SystemIndex> m_after;
+    };
+
+    // Systems run in registration order unless they can not conflict, in which case they may run at the same time.
+    // The graph is built incrementally as systems are added, so conflicts are known at registration time.
+    class SystemScheduler
+    {
+    public:
+        struct SystemNode
+        {
+            std::string name;
+            const char* profileName; // Interned copy of name, stays valid when m_systems grows
+            SystemAccess access;
+            SystemFn fn;
+            std::vector<SystemIndex> dependencies; // Systems that must finish before this one
+            std::vector<SystemIndex> dependents;
+            wIndex level; // Longest dependency chain leading to this system
+        };
+
+        struct Conflict
+        {
+            SystemIndex first;
+            SystemIndex second;
+            ComponentTypeIndex componentTypeIndex;
+        };
+
+        SystemScheduler(Application& app, JobSystem& jobSystem) noexcept;
+
+        SystemScheduler(const SystemScheduler&) = delete;
+        SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+        SystemIndex AddSystem(std::string_view name, const SystemAccess& access, SystemFn fn);
+
+        // Runs every system once on the JobSystem, waiting for all of them to finish.
+        void RunFrame();
+
+        [[nodiscard]] inline const std::vector<SystemNode>& GetFrameGraph() const noexcept { return m_systems; }
+        [[nodiscard]] inline const std::vector<Conflict>& GetConflicts() const noexcept { return m_conflicts; }
+        [[nodiscard]] inline wIndex GetSystemCount() const noexcept { return m_systems.size(); }
+        [[nodiscard]] inline const SystemNode& GetSystem(SystemIndex systemIndex) const noexcept { W_ASSERT(systemIndex != InvalidSystem && systemIndex <= m_systems.size(), "SystemIndex: {} out of Range! System Count: {}", systemIndex, m_systems.size()); return m_systems[systemIndex - 1]; }
+
+        [[nodiscard]] std::string GetFrameGraphDot() const;
+
+    private:
+        void Spawn(JobCounter& counter, SystemIndex systemIndex);
+        void Execute(JobCounter& counter, SystemIndex systemIndex);
+
+        Application& m_app;
+        JobSystem& m_jobSystem;
+        std::vector<SystemNode> m_systems;
+        std::vector<Conflict> m_conflicts;
+        std::vector<SystemIndex> m_roots;
+
+        std::unique_ptr<std::atomic<wIndex>[]> m_pendingDependencies;
+        wIndex m_pendingDependencyCapacity;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef TUNGSTEN_CORE_TRANSFORM_HIERARCHY_HPP
+#define TUNGSTEN_CORE_TRANSFORM_HIERARCHY_HPP
+
+#include <array>
+#include "TungstenCore/ComponentSystem.hpp"
+#include "TungstenCore/JobSystem.hpp"
+
+namespace wCore
+{
+    // Row major 3x4 affine matrix, the last row is implicitly 0 0 0 1. Points are column vectors.
+    struct TransformMatrix
+    {
+        [[nodiscard]] static constexpr TransformMatrix Identity() noexcept { return { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f } }; }
+        [[nodiscard]] static constexpr TransformMatrix Translation(float x, float y, float z) noexcept { return { { 1.0f, 0.0f, 0.0f, x, 0.0f, 1.0f, 0.0f, y, 0.0f, 0.0f, 1.0f, z } }; }
+
+        // parent * child, applies child first.
+        [[nodiscard]] friend constexpr TransformMatrix operator*(const TransformMatrix& parent, const TransformMatrix& child) noexcept
+        {
+            TransformMatrix result;
+            for (wIndex row = 0; row < 3; ++row)
+            {
+                const float* p = parent.m.data() + row * 4;
+                for (wIndex column = 0; column < 4; ++column)
+                {
+                    result.m[row * 4 + column] = p[0] * child.m[column] + p[1] * child.m[4 + column] + p[2] * child.m[8 + column] + (column == 3 ? p[3] : 0.0f);
+                }
+            }
+            return result;
+        }
+
+        friend constexpr bool operator==(const TransformMatrix&, const TransformMatrix&) = default;
+
+        std::array<float, 12> m;
+    };
+
+    // A node of the transform hierarchy, stored in a dense list. Add it to the ComponentSetup like any other type.
+    // TransformHierarchy keeps every scene's Transforms in depth first order: each subtree is one dense range starting
+    // at its root, so propagation is a single linear pass. Creating Transforms directly appends roots, which keeps the
+    // order, but they must be destroyed through TransformHierarchy::Destroy because a plain removal swaps the last node
+    // into the hole.
+    struct Transform
+    {
+        constexpr Transform() noexcept
+            : local(TransformMatrix::Identity()), world(TransformMatrix::Identity()), parent(InvalidComponent), subtreeSize(1), parentOffset(0) {}
+
+        [[nodiscard]] inline bool IsRoot() const noexcept { return parent == InvalidComponent; }
+        [[nodiscard]] inline wIndex GetSubtreeSize() const noexcept { return subtreeSize; }
+
+        TransformMatrix local;
+        TransformMatrix world; // Written by TransformHierarchy::Propagate
+
+    private:
+        friend class TransformHierarchy;
+        friend class ComponentSetup;
+
+        // Prefab instances are appended at a slot offset, see ComponentSetup::HasSlotRemap
+        inline void RemapSlots(ComponentIndex slotOffset) noexcept { parent += parent != InvalidComponent ? slotOffset : 0; }
+
+        ComponentIndex parent; // Slot of the parent, InvalidComponent for roots
+        wIndex subtreeSize; // This node and all of its descendants
+        wIndex parentOffset; // Dense distance back to the parent, 0 for roots
+    };
+
+    class TransformHierarchy
+    {
+    public:
+        // Nodes per propagation job. Batches only end between root subtrees, so one large subtree stays a single batch.
+        static constexpr wIndex PropagateBatchSize = 1024;
+
+        // Creates a Transform as the last child of parent, or as a root for the default handle.
+        [[nodiscard]] static ComponentHandle<Transform> Create(ComponentSystem& componentSystem, SceneHandle sceneHandle, ComponentHandle<Transform> parent = {});
+
+        // Moves the subtree of child to the end of parent's children, or makes it a root for the default handle. Only
+        // the dense range between the old and the new position is rotated, handles stay valid.
+        static void SetParent(ComponentSystem& componentSystem, ComponentHandle<Transform> child, ComponentHandle<Transform> parent) noexcept;
+        [[nodiscard]] static ComponentHandle<Transform> GetParent(ComponentSystem& componentSystem, ComponentHandle<Transform> child) noexcept;
+
+        // Destroys the transform and its whole subtree.
+        static void Destroy(ComponentSystem& componentSystem, ComponentHandle<Transform> transform);
+
+        // Writes world = parent world * local for every Transform in the scene, root subtrees in parallel.
+        static void Propagate(ComponentSystem& componentSystem, SceneHandle sceneHandle, JobSystem& jobSystem);
+        static void Propagate(ComponentSystem& componentSystem, SceneHandle sceneHandle);
+
+    private:
+        static void PropagateRange(Transform* nodes, wIndex begin, wIndex end) noexcept;
+        // Recomputes the parent offsets in [begin, end) and of the children past end whose parent lies in that range.
+        static void UpdateParentOffsets(Transform* nodes, const ComponentIndex* slotToDense, wIndex begin, wIndex end) noexcept;
+        static void AddToAncestors(Transform* nodes, const ComponentIndex* slotToDense, ComponentIndex parent, std::ptrdiff_t delta) noexcept;
+    };
+}
+
+#endif
\ No newline at end of file
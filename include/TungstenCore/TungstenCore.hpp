@@ -4,6 +4,7 @@
 #include <vector>
 #include "TungstenUtils/TungstenUtils.hpp"
 #include "ComponentSetup.hpp"
+#include "TungstenCore/ComponentView.hpp"
 #include "TungstenCore/Application.hpp"
 
 
@@ -4,47 +4,68 @@
 namespace wCore
 {
     Application::Application()
-        : m_componentSystem(*this)
+        : Application(Config())
     {
     }
 
+    Application::Application(const Config& config)
+        : m_jobSystem(config.jobSystem), m_eventBus(m_jobSystem), m_componentSystem(*this, config.componentSystem),
+        m_commandBuffers(m_componentSystem.GetComponentSetup(), m_jobSystem), m_systemScheduler(*this, m_jobSystem),
+        m_sceneStreamer(m_componentSystem, m_jobSystem, config.sceneStreamer), m_frameLoop(config.frameLoop), m_presentFn(),
+        m_exitRequested(false), m_exitCode(0)
+    {
+        if (config.componentSystem.componentEvents)
+        {
+            m_eventBus.AddChannel<ComponentCreatedEvent>();
+            m_eventBus.AddChannel<ComponentDestroyedEvent>();
+        }
+    }
+
     Application::RunOutput Application::Run()
     {
-        W_DEBUG_LOG_INFO("Hello, From Application.Run!");
+        W_PROFILE_THREAD("Main");
+        W_PROFILE_ZONE("Application::Run");
+        W_DEBUG_LOG_INFO("Running at {} ticks per second{}", 1.0 / m_frameLoop.GetTickSeconds(), m_frameLoop.IsHeadless() ? ", headless" : "");
 
-        W_DEBUG_LOG_INFO("Creating Scene...");
-        SceneHandle sceneIndex = m_componentSystem.CreateScene();
-        W_DEBUG_LOG_INFO("Created Scene At Index: {}", sceneIndex.sceneIndex);
-        SceneHandle sceneIndex1 = m_componentSystem.CreateScene();
-        W_DEBUG_LOG_INFO("Created Scene1 At Index: {}", sceneIndex1.sceneIndex);
+        m_frameLoop.Start();
+        while (!m_exitRequested.load(std::memory_order_acquire) && !m_frameLoop.IsDone())
+        {
+            W_PROFILE_ZONE("Frame");
+            const wIndex ticks = m_frameLoop.BeginFrame();
+            for (wIndex tick = 0; tick < ticks; ++tick)
+            {
+                Tick();
+            }
+            const bool present = m_presentFn && !m_frameLoop.IsHeadless();
+            if (present)
+            {
+                W_PROFILE_ZONE("Application::Present");
+                m_presentFn(*this, m_frameLoop.GetInterpolation());
+            }
+            m_frameLoop.EndFrame(present);
+        }
 
-        std::vector<ComponentHandle<void>> indexes;
-        /*indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(2, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(2, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(2, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(2, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(2, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(2, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(1, sceneIndex.sceneIndex));
-        indexes.emplace_back(m_componentSystem.CreateComponent(2, sceneIndex.sceneIndex));*/
-        W_DEBUG_LOG_INFO("All Created");
+        [[maybe_unused]] const FrameLoop::Stats& stats = m_frameLoop.GetStats();
+        W_DEBUG_LOG_INFO("Ran {} frames and {} ticks, {} catch up, {} dropped, {} overruns", stats.frameCount, stats.tickCount, stats.catchUpTickCount, stats.droppedTickCount, stats.overrunCount);
+        return Application::RunOutput(m_exitCode.load(std::memory_order_relaxed));
+    }
 
-        return Application::RunOutput(0);
+    void Application::Tick()
+    {
+        W_PROFILE_ZONE("Application::Tick");
+        m_componentSystem.AdvanceChangeVersion();
+        m_systemScheduler.RunFrame();
+        {
+            W_PROFILE_ZONE("CommandBuffers::Playback");
+            m_commandBuffers.Playback(m_componentSystem);
+        }
+        {
+            W_PROFILE_ZONE("SceneStreamer::Update");
+            m_sceneStreamer.Update();
+        }
+        // Everything published this tick, including by playback, is read next tick
+        m_eventBus.Swap();
+        m_componentSystem.ReclaimRetiredMemory();
     }
 /*
     uint32_t Application::CreateScene()
@@ -0,0 +1,235 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/ArchetypeStorage.hpp"
+
+namespace wCore
+{
+    ArchetypeStorage::ArchetypeStorage(MemoryResource& chunkMemory) noexcept
+        : m_chunkMemory(chunkMemory), m_archetypes(), m_archetypeLookup(), m_entities(), m_entityFreeList()
+    {
+    }
+
+    ArchetypeStorage::~ArchetypeStorage() noexcept
+    {
+        for (Archetype& archetype : m_archetypes)
+        {
+            for (wIndex chunkIndex = 0; chunkIndex < archetype.GetUsedChunkCount(); ++chunkIndex)
+            {
+                const wIndex rowCount = archetype.GetChunkRowCount(chunkIndex);
+                for (wIndex columnIndex = 0; columnIndex < archetype.columns.size(); ++columnIndex)
+                {
+                    const Column& column = archetype.columns[columnIndex];
+                    std::byte* element = archetype.GetColumn(chunkIndex, columnIndex);
+                    for (wIndex row = 0; row < rowCount; ++row, element += column.size)
+                    {
+                        column.ops->destroy(element);
+                    }
+                }
+            }
+            for (std::byte* chunk : archetype.chunks)
+            {
+                m_chunkMemory.Deallocate(chunk, ArchetypeChunkSize, ArchetypeChunkAlignment);
+            }
+        }
+    }
+
+    std::pair<ArchetypeEntityIndex, ComponentGeneration> ArchetypeStorage::Create(ArchetypeSignature signature, const ComponentSetup& componentSetup, Application& app)
+    {
+        const ArchetypeIndex archetypeIndex = GetOrCreateArchetype(signature, componentSetup);
+
+        ArchetypeEntityIndex entityIndex;
+        if (m_entityFreeList.Empty())
+        {
+            m_entities.emplace_back();
+            entityIndex = m_entities.size();
+        }
+        else
+        {
+            entityIndex = m_entityFreeList.Remove();
+        }
+
+        Archetype& archetype = m_archetypes[archetypeIndex - 1];
+        const wIndex row = PushRow(archetype, entityIndex);
+        for (wIndex columnIndex = 0; columnIndex < archetype.columns.size(); ++columnIndex)
+        {
+            archetype.columns[columnIndex].ops->construct(archetype.GetElement(row, columnIndex), app);
+        }
+
+        EntityRecord& record = m_entities[entityIndex - 1];
+        record.archetypeIndex = archetypeIndex;
+        record.row = row;
+        return { entityIndex, record.generation };
+    }
+
+    void ArchetypeStorage::Destroy(ArchetypeEntityIndex entityIndex) noexcept
+    {
+        EntityRecord& record = m_entities[entityIndex - 1];
+        W_ASSERT(record.archetypeIndex != InvalidArchetype, "ArchetypeEntity: {} already destroyed", entityIndex);
+        Archetype& archetype = m_archetypes[record.archetypeIndex - 1];
+        for (wIndex columnIndex = 0; columnIndex < archetype.columns.size(); ++columnIndex)
+        {
+            archetype.columns[columnIndex].ops->destroy(archetype.GetElement(record.row, columnIndex));
+        }
+        PopRow(archetype, record.row);
+
+        record.archetypeIndex = InvalidArchetype;
+        ++record.generation.generation;
+        m_entityFreeList.Add(entityIndex);
+    }
+
+    void ArchetypeStorage::ChangeSignature(ArchetypeEntityIndex entityIndex, ArchetypeSignature newSignature, const ComponentSetup& componentSetup, Application& app)
+    {
+        EntityRecord& record = m_entities[entityIndex - 1];
+        const ArchetypeIndex oldArchetypeIndex = record.archetypeIndex;
+        if (m_archetypes[oldArchetypeIndex - 1].signature == newSignature)
+        {
+            return;
+        }
+
+        const ArchetypeIndex newArchetypeIndex = GetOrCreateArchetype(newSignature, componentSetup);
+        Archetype& oldArchetype = m_archetypes[oldArchetypeIndex - 1];
+        Archetype& newArchetype = m_archetypes[newArchetypeIndex - 1];
+        const wIndex oldRow = record.row;
+        const wIndex newRow = PushRow(newArchetype, entityIndex);
+
+        const ArchetypeSignature oldSignature = oldArchetype.signature;
+        for (ArchetypeSignature bits = oldSignature | newSignature; bits; bits &= bits - 1)
+        {
+            const wIndex chunkedListIndex = std::countr_zero(bits);
+            const ArchetypeSignature bit = ArchetypeSignature(1) << chunkedListIndex;
+            if (oldSignature & newSignature & bit)
+            {
+                const wIndex oldColumn = oldArchetype.GetColumnIndex(chunkedListIndex);
+                oldArchetype.columns[oldColumn].ops->relocate(newArchetype.GetElement(newRow, newArchetype.GetColumnIndex(chunkedListIndex)), oldArchetype.GetElement(oldRow, oldColumn));
+            }
+            else if (newSignature & bit)
+            {
+                const wIndex newColumn = newArchetype.GetColumnIndex(chunkedListIndex);
+                newArchetype.columns[newColumn].ops->construct(newArchetype.GetElement(newRow, newColumn), app);
+            }
+            else
+            {
+                const wIndex oldColumn = oldArchetype.GetColumnIndex(chunkedListIndex);
+                oldArchetype.columns[oldColumn].ops->destroy(oldArchetype.GetElement(oldRow, oldColumn));
+            }
+        }
+        PopRow(oldArchetype, oldRow);
+
+        record.archetypeIndex = newArchetypeIndex;
+        record.row = newRow;
+    }
+
+    void* ArchetypeStorage::GetComponent(ArchetypeEntityIndex entityIndex, wIndex chunkedListIndex) const noexcept
+    {
+        const EntityRecord& record = m_entities[entityIndex - 1];
+        const Archetype& archetype = m_archetypes[record.archetypeIndex - 1];
+        if (!(archetype.signature & (ArchetypeSignature(1) << chunkedListIndex)))
+        {
+            return nullptr;
+        }
+        return archetype.GetElement(record.row, archetype.GetColumnIndex(chunkedListIndex));
+    }
+
+    wIndex ArchetypeStorage::GetComponentCount(wIndex chunkedListIndex) const noexcept
+    {
+        wIndex count = 0;
+        for (const Archetype& archetype : m_archetypes)
+        {
+            if (archetype.signature & (ArchetypeSignature(1) << chunkedListIndex))
+            {
+                count += archetype.rowCount;
+            }
+        }
+        return count;
+    }
+
+    wIndex ArchetypeStorage::GetComponentCapacity(wIndex chunkedListIndex) const noexcept
+    {
+        wIndex capacity = 0;
+        for (const Archetype& archetype : m_archetypes)
+        {
+            if (archetype.signature & (ArchetypeSignature(1) << chunkedListIndex))
+            {
+                capacity += archetype.GetChunkCount() * archetype.rowsPerChunk;
+            }
+        }
+        return capacity;
+    }
+
+    ArchetypeIndex ArchetypeStorage::GetOrCreateArchetype(ArchetypeSignature signature, const ComponentSetup& componentSetup)
+    {
+        const auto it = m_archetypeLookup.find(signature);
+        if (it != m_archetypeLookup.end())
+        {
+            return it->second;
+        }
+
+        Archetype& archetype = m_archetypes.emplace_back();
+        archetype.signature = signature;
+        archetype.rowCount = 0;
+
+        std::size_t rowSize = sizeof(ArchetypeEntityIndex);
+        for (ArchetypeSignature bits = signature; bits; bits &= bits - 1)
+        {
+            const ComponentSetup::ComponentType& type = componentSetup.m_types[componentSetup.m_chunkedTypes[std::countr_zero(bits)] - 1];
+            W_ASSERT(type.alignment <= ArchetypeChunkAlignment, "Chunked component alignment {} exceeds chunk alignment {}", type.alignment, ArchetypeChunkAlignment);
+            archetype.columns.push_back({ type.chunkedOps, type.size, 0 });
+            rowSize += type.size;
+        }
+
+        // Start from the unpadded estimate and shrink until the aligned columns fit.
+        wIndex rowsPerChunk = ArchetypeChunkSize / rowSize;
+        W_ASSERT(rowsPerChunk, "Archetype row of {} bytes does not fit in a {} byte chunk", rowSize, ArchetypeChunkSize);
+        while (true)
+        {
+            std::size_t offset = rowsPerChunk * sizeof(ArchetypeEntityIndex);
+            wIndex columnIndex = 0;
+            for (ArchetypeSignature bits = signature; bits; bits &= bits - 1, ++columnIndex)
+            {
+                const ComponentSetup::ComponentType& type = componentSetup.m_types[componentSetup.m_chunkedTypes[std::countr_zero(bits)] - 1];
+                offset = wUtils::AlignUp(offset, ArchetypeChunkAlignment);
+                archetype.columns[columnIndex].offset = offset;
+                offset += rowsPerChunk * type.size;
+            }
+            if (offset <= ArchetypeChunkSize)
+            {
+                break;
+            }
+            --rowsPerChunk;
+        }
+        archetype.rowsPerChunk = rowsPerChunk;
+
+        const ArchetypeIndex archetypeIndex = m_archetypes.size();
+        m_archetypeLookup.emplace(signature, archetypeIndex);
+        return archetypeIndex;
+    }
+
+    wIndex ArchetypeStorage::PushRow(Archetype& archetype, ArchetypeEntityIndex entityIndex)
+    {
+        const wIndex row = archetype.rowCount;
+        if (row == archetype.GetChunkCount() * archetype.rowsPerChunk)
+        {
+            archetype.chunks.push_back(static_cast<std::byte*>(
+                m_chunkMemory.Allocate(ArchetypeChunkSize, ArchetypeChunkAlignment)
+            ));
+        }
+        archetype.GetEntities(row / archetype.rowsPerChunk)[row % archetype.rowsPerChunk] = entityIndex;
+        ++archetype.rowCount;
+        return row;
+    }
+
+    void ArchetypeStorage::PopRow(Archetype& archetype, wIndex row) noexcept
+    {
+        // The components at row must already be destroyed or relocated.
+        const wIndex lastRow = --archetype.rowCount;
+        if (row != lastRow)
+        {
+            for (wIndex columnIndex = 0; columnIndex < archetype.columns.size(); ++columnIndex)
+            {
+                archetype.columns[columnIndex].ops->relocate(archetype.GetElement(row, columnIndex), archetype.GetElement(lastRow, columnIndex));
+            }
+            const ArchetypeEntityIndex movedEntity = archetype.GetEntities(lastRow / archetype.rowsPerChunk)[lastRow % archetype.rowsPerChunk];
+            archetype.GetEntities(row / archetype.rowsPerChunk)[row % archetype.rowsPerChunk] = movedEntity;
+            m_entities[movedEntity - 1].row = row;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/CommandBuffer.hpp"
+
+namespace wCore
+{
+    CommandBuffer::CommandBuffer(const ComponentSetup& componentSetup) noexcept
+        : m_componentSetup(&componentSetup), m_commands(), m_sceneNames(), m_reservations(), m_createComponentCount(0),
+        m_createdScenes(), m_createdComponents()
+    {
+    }
+
+    DeferredSceneIndex CommandBuffer::CreateScene(std::string_view name)
+    {
+        m_sceneNames.emplace_back(name);
+        const DeferredSceneIndex deferredSceneIndex = m_sceneNames.size();
+        m_commands.push_back({ CommandType::CreateScene, InvalidComponentType, SceneHandle(InvalidScene, SceneGeneration()), deferredSceneIndex, InvalidComponent, ComponentGeneration(), 0 });
+        return deferredSceneIndex;
+    }
+
+    void CommandBuffer::DestroyScene(SceneHandle sceneHandle)
+    {
+        m_commands.push_back({ CommandType::DestroyScene, InvalidComponentType, sceneHandle, InvalidDeferredScene, InvalidComponent, ComponentGeneration(), 0 });
+    }
+
+    DeferredComponentIndex CommandBuffer::CreateComponent(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle)
+    {
+        W_ASSERT(!m_componentSetup->IsChunkedFromTypeIndex(componentTypeIndex), "Component: {} uses ChunkedStorage, use CreateArchetypeEntity instead", m_componentSetup->GetComponentTypeNameFromTypeIndex(componentTypeIndex));
+        const wIndex reservationIndex = AddReservation(componentTypeIndex, sceneHandle.sceneIndex, InvalidDeferredScene);
+        m_commands.push_back({ CommandType::CreateComponent, componentTypeIndex, sceneHandle, InvalidDeferredScene, InvalidComponent, ComponentGeneration(), reservationIndex });
+        return ++m_createComponentCount;
+    }
+
+    DeferredComponentIndex CommandBuffer::CreateComponent(ComponentTypeIndex componentTypeIndex, DeferredSceneIndex deferredSceneIndex)
+    {
+        W_ASSERT(deferredSceneIndex != InvalidDeferredScene && deferredSceneIndex <= m_sceneNames.size(), "DeferredSceneIndex: {} was not recorded in this CommandBuffer", deferredSceneIndex);
+        W_ASSERT(!m_componentSetup->IsChunkedFromTypeIndex(componentTypeIndex), "Component: {} uses ChunkedStorage, use CreateArchetypeEntity instead", m_componentSetup->GetComponentTypeNameFromTypeIndex(componentTypeIndex));
+        const wIndex reservationIndex = AddReservation(componentTypeIndex, InvalidScene, deferredSceneIndex);
+        m_commands.push_back({ CommandType::CreateComponent, componentTypeIndex, SceneHandle(InvalidScene, SceneGeneration()), deferredSceneIndex, InvalidComponent, ComponentGeneration(), reservationIndex });
+        return ++m_createComponentCount;
+    }
+
+    void CommandBuffer::DestroyComponent(ComponentHandleAny componentHandle)
+    {
+        m_commands.push_back({ CommandType::DestroyComponent, componentHandle.componentTypeIndex, componentHandle.sceneHandle, InvalidDeferredScene, componentHandle.componentIndex, componentHandle.generation, 0 });
+    }
+
+    void CommandBuffer::Playback(ComponentSystem& componentSystem)
+    {
+        m_createdScenes.clear();
+        m_createdComponents.clear();
+        m_createdScenes.reserve(m_sceneNames.size());
+        m_createdComponents.reserve(m_createComponentCount);
+
+        const wIndex freeSceneCount = componentSystem.GetSceneFreeListCount();
+        if (m_sceneNames.size() > freeSceneCount)
+        {
+            componentSystem.ReserveScenes(componentSystem.GetSceneSlotCount() + m_sceneNames.size() - freeSceneCount);
+        }
+
+        for (const Command& command : m_commands)
+        {
+            switch (command.type)
+            {
+            case CommandType::CreateScene:
+                m_createdScenes.push_back(componentSystem.CreateScene(m_sceneNames[command.deferredSceneIndex - 1]));
+                break;
+            case CommandType::DestroyScene:
+                if (componentSystem.SceneExists(command.sceneHandle))
+                {
+                    componentSystem.DestroyScene(command.sceneHandle);
+                }
+                break;
+            case CommandType::CreateComponent:
+            {
+                const SceneHandle sceneHandle = command.deferredSceneIndex != InvalidDeferredScene ? m_createdScenes[command.deferredSceneIndex - 1] : command.sceneHandle;
+                if (!componentSystem.SceneExists(sceneHandle))
+                {
+                    // Keeps the results of later creates at their DeferredComponentIndex
+                    m_createdComponents.push_back(ComponentHandleAny(command.componentTypeIndex, SceneHandle(), InvalidComponent, ComponentGeneration()));
+                    break;
+                }
+                Reservation& reservation = m_reservations[command.reservationIndex];
+                if (reservation.count)
+                {
+                    componentSystem.ReserveComponents(command.componentTypeIndex, sceneHandle.sceneIndex, componentSystem.GetComponentCount(command.componentTypeIndex, sceneHandle.sceneIndex) + reservation.count);
+                    reservation.count = 0;
+                }
+                m_createdComponents.push_back(componentSystem.CreateComponent(command.componentTypeIndex, sceneHandle));
+                break;
+            }
+            case CommandType::DestroyComponent:
+            {
+                const ComponentHandleAny componentHandle(command.componentTypeIndex, command.sceneHandle, command.componentIndex, command.generation);
+                if (componentSystem.ComponentExists(componentHandle))
+                {
+                    componentSystem.DestroyComponent(componentHandle);
+                }
+                break;
+            }
+            }
+        }
+    }
+
+    void CommandBuffer::Clear() noexcept
+    {
+        m_commands.clear();
+        m_sceneNames.clear();
+        m_reservations.clear();
+        m_createComponentCount = 0;
+    }
+
+    wIndex CommandBuffer::AddReservation(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex, DeferredSceneIndex deferredSceneIndex)
+    {
+        // Creates tend to come in runs of the same type, so search from the most recent reservation
+        for (wIndex reservationIndex = m_reservations.size(); reservationIndex--;)
+        {
+            Reservation& reservation = m_reservations[reservationIndex];
+            if (reservation.componentTypeIndex == componentTypeIndex && reservation.sceneIndex == sceneIndex && reservation.deferredSceneIndex == deferredSceneIndex)
+            {
+                ++reservation.count;
+                return reservationIndex;
+            }
+        }
+        m_reservations.push_back({ componentTypeIndex, sceneIndex, deferredSceneIndex, 1 });
+        return m_reservations.size() - 1;
+    }
+
+    CommandBufferSet::CommandBufferSet(const ComponentSetup& componentSetup, const JobSystem& jobSystem)
+        : m_buffers(), m_bufferCount(jobSystem.GetThreadCount())
+    {
+        m_buffers.reserve(m_bufferCount);
+        for (wIndex threadIndex = 0; threadIndex < m_bufferCount; ++threadIndex)
+        {
+            m_buffers.emplace_back(componentSetup);
+        }
+    }
+
+    void CommandBufferSet::Playback(ComponentSystem& componentSystem)
+    {
+        for (PaddedBuffer& paddedBuffer : m_buffers)
+        {
+            if (!paddedBuffer.buffer.Empty())
+            {
+                paddedBuffer.buffer.Playback(componentSystem);
+                paddedBuffer.buffer.Clear();
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -4,13 +4,14 @@
 namespace wCore
 {
     ComponentSetup::ComponentSetup() noexcept
-        : m_names(), m_types(), m_componentListCount(0), m_currentComponentTypeCount(0), m_currentComponentListCount(0)
+        : m_names(), m_types(), m_chunkedTypes(), m_componentListCount(0), m_pageListCount(0)
     {
     }
 
-    void ComponentSetup::CreateCtx::UpdateCurrentComponentListCount(wIndex componentTypeCount, wIndex componentListCount) noexcept
+    void ComponentSetup::CreateCtx::UpdateCurrentComponentListCount(wIndex componentTypeCount, wIndex componentListCount, wIndex pageListCount) noexcept
     {
         currentComponentTypeCount = componentTypeCount;
         currentComponentListCount = componentListCount;
+        currentPageListCount = pageListCount;
     }
 }
\ No newline at end of file
@@ -1,152 +1,802 @@
 #include "wCorePCH.hpp"
 #include "TungstenCore/ComponentSystem.hpp"
+#include "TungstenCore/Application.hpp"
+#include <thread>
 
 namespace wCore
 {
     //static constexpr std::uintptr_t InvalidComponentListTrue = static_cast<std::uintptr_t>(1);
 
     ComponentSystem::ComponentSystem(Application& app) noexcept
+        : ComponentSystem(app, Config())
+    {
+    }
+
+    ComponentSystem::ComponentSystem(Application& app, const Config& config) noexcept
         : m_app(app), m_componentSetup(),
-        m_scenes(nullptr), m_componentListsHot(nullptr), m_pageListsHot(nullptr), m_sceneGenerations(nullptr), m_componentListsCold(nullptr), m_pageListsCold(nullptr),
-        m_sceneSlotCount(0), m_sceneSlotCapacity(0),
-        m_sceneFreeList()
+        m_epochMemory(config.concurrentLookup ? std::make_unique<EpochMemoryResource>(config.memoryResource ? *config.memoryResource : HeapMemoryResource::Get()) : nullptr),
+        m_memoryResource(m_epochMemory ? m_epochMemory.get() : config.memoryResource ? config.memoryResource : &HeapMemoryResource::Get()),
+        m_pagePool(config.pagePool ? std::make_unique<PagePool>(*m_memoryResource) : nullptr),
+        m_pageMemoryResource(m_pagePool ? static_cast<MemoryResource*>(m_pagePool.get()) : m_memoryResource),
+        m_sceneArenasEnabled(config.sceneArenas), m_componentEvents(config.componentEvents), m_sceneArenaBlockSize(config.sceneArenaBlockSize), m_unusedSceneArenas(),
+        m_scenes(nullptr), m_sceneBlockSize(0), m_sceneGenerations(nullptr), m_createCtx(), m_sceneData(nullptr),
+        m_sceneSlotCount(0), m_sceneSlotCapacity(0), m_stagedSceneCount(0),
+        m_sceneFreeList(), m_sceneNames(), m_reallocationHistogram(),
+        m_compactSceneIndex(SceneIndexStart), m_compactTypeIndex(ComponentTypeIndexStart), m_sequence(0), m_writeDepth(0)
     {
+        m_createCtx.changeVersion = ChangeVersionStart;
+        m_componentSetup.m_typeAdded = [this](ComponentTypeIndex componentTypeIndex) { AddLateType(componentTypeIndex); };
     }
 
     ComponentSystem::~ComponentSystem() noexcept
     {
-        /*if (m_componentLists)
+        if (m_scenes)
         {
-            for (SceneIndex sceneIndex = SceneIndexStart; sceneIndex <= m_sceneData.size(); ++sceneIndex)
+            // Destroyed scenes have zeroed headers, so every slot can be cleaned up the same way
+            for (SceneIndex sceneIndex = SceneIndexStart; sceneIndex <= m_sceneSlotCount; ++sceneIndex)
             {
-                const std::size_t sceneStartListIndex = GetSceneStartListIndex(sceneIndex);
-                if (m_componentLists[sceneStartListIndex].begin)
+                DeleteSceneContent(sceneIndex);
+                delete m_sceneData[sceneIndex - 1].arena;
+            }
+            FreeLateLists<ComponentSetup::ComponentListHeaderHot, ComponentSetup::ComponentListHeaderCold>(m_createCtx.lateComponentLists, m_createCtx.lateComponentListCount);
+            FreeLateLists<ComponentSetup::PageListHeaderHot, ComponentSetup::PageListHeaderCold>(m_createCtx.latePageLists, m_createCtx.latePageListCount);
+            m_memoryResource->Deallocate(m_scenes, m_sceneBlockSize, SceneBlockAlignment);
+        }
+        ReleaseUnusedMemory();
+    }
+
+    void ComponentSystem::ReleaseUnusedMemory() noexcept
+    {
+        for (SceneArena* arena : m_unusedSceneArenas)
+        {
+            delete arena;
+        }
+        m_unusedSceneArenas.clear();
+        if (m_pagePool)
+        {
+            m_pagePool->Trim();
+        }
+        ReclaimRetiredMemory();
+    }
+
+    std::size_t ComponentSystem::Compact()
+    {
+        W_PROFILE_ZONE("ComponentSystem::Compact");
+        std::size_t bytesReleased = 0;
+        {
+            const WriteScope writeScope(*this);
+            for (SceneIndex sceneIndex = SceneIndexStart; sceneIndex <= m_sceneSlotCount; ++sceneIndex)
+            {
+                for (ComponentTypeIndex componentTypeIndex = ComponentTypeIndexStart; componentTypeIndex <= m_createCtx.GetCurrentComponentTypeCount(); ++componentTypeIndex)
                 {
-                    DeleteSceneContent(sceneStartListIndex);
+                    bytesReleased += CompactList(componentTypeIndex, sceneIndex);
                 }
             }
-            ::operator delete(m_componentLists, std::align_val_t(alignof(ComponentSetup::PageListHeader)));
-        }*/
+            bytesReleased += CompactSceneBlock();
+        }
+        m_compactSceneIndex = SceneIndexStart;
+        m_compactTypeIndex = ComponentTypeIndexStart;
+        ReleaseUnusedMemory();
+        return bytesReleased;
     }
 
-    void ComponentSystem::ReserveScenes(wIndex minCapacity)
+    std::size_t ComponentSystem::CompactScene(SceneHandle sceneHandle)
     {
-        if (minCapacity > m_sceneSlotCapacity)
+        W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+        W_PROFILE_ZONE("ComponentSystem::CompactScene");
+        std::size_t bytesReleased = 0;
         {
-            ReallocateScenes(minCapacity);
+            const WriteScope writeScope(*this);
+            for (ComponentTypeIndex componentTypeIndex = ComponentTypeIndexStart; componentTypeIndex <= m_createCtx.GetCurrentComponentTypeCount(); ++componentTypeIndex)
+            {
+                bytesReleased += CompactList(componentTypeIndex, sceneHandle.sceneIndex);
+            }
         }
+        ReleaseUnusedMemory();
+        return bytesReleased;
     }
 
-    SceneHandle ComponentSystem::CreateScene(std::string_view name)
+    bool ComponentSystem::Compact(std::chrono::microseconds budget)
     {
-        if (m_sceneFreeList.Empty())
+        W_PROFILE_ZONE("ComponentSystem::Compact");
+        const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + budget;
         {
-            if (m_sceneSlotCount == m_sceneSlotCapacity)
+            const WriteScope writeScope(*this);
+            // Destroyed scenes have zeroed headers and cost nothing, so the cursor never has to skip them
+            for (; m_compactSceneIndex <= m_sceneSlotCount; ++m_compactSceneIndex, m_compactTypeIndex = ComponentTypeIndexStart)
             {
-                ReallocateScenes(CalculateNextCapacity(m_sceneSlotCapacity));
+                while (m_compactTypeIndex <= m_createCtx.GetCurrentComponentTypeCount())
+                {
+                    CompactList(m_compactTypeIndex++, m_compactSceneIndex);
+                    if (std::chrono::steady_clock::now() >= deadline)
+                    {
+                        return false;
+                    }
+                }
             }
+            CompactSceneBlock();
+        }
+        m_compactSceneIndex = SceneIndexStart;
+        m_compactTypeIndex = ComponentTypeIndexStart;
+        ReleaseUnusedMemory();
+        return true;
+    }
 
-            const std::size_t sceneStartComponentIndex = m_sceneSlotCount * m_componentSetup.GetCurrentComponentListCount();
-            const std::size_t sceneStartPageIndex = m_sceneSlotCount * m_componentSetup.GetCurrentPageListCount();
+    std::size_t ComponentSystem::CompactList(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex)
+    {
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+        if (type.IsChunked())
+        {
+            return 0;
+        }
+        const std::size_t bytesReserved = GetComponentListStats(componentTypeIndex, sceneIndex).bytesReserved;
+        // Shrinks are not growth, they stay out of the reallocation histogram
+        ComponentSetup::ComponentAllocator allocator = GetComponentAllocator(sceneIndex);
+        allocator.histogram = nullptr;
+        const bool inArena = m_sceneData[sceneIndex - 1].arena != nullptr;
 
-            std::memset(m_componentListsHot + sceneStartComponentIndex, 0, sizeof(ComponentSetup::ComponentListHeaderHot) * GetCurrentComponentListCount());
-            std::memset(m_pageListsHot + sceneStartPageIndex, 0, sizeof(ComponentSetup::PageListHeaderHot) * GetCurrentPageListCount());
-            std::memset(m_componentListsCold + sceneStartComponentIndex, 0, sizeof(ComponentSetup::ComponentListHeaderCold) * GetCurrentComponentListCount());
-            std::memset(m_pageListsCold + sceneStartPageIndex, 0, sizeof(ComponentSetup::PageListHeaderCold) * GetCurrentPageListCount());
-            std::construct_at(m_sceneData + m_sceneSlotCount);
+        if (type.pageSize)
+        {
+            ComponentSetup::PageListHeaderHot& headerHot = m_createCtx.GetPageListHot(sceneIndex, type.listIndex);
+            ComponentSetup::PageListHeaderCold& headerCold = m_createCtx.GetPageListCold(sceneIndex, type.listIndex);
+            void** const pages = static_cast<void**>(headerHot.data);
+            for (wIndex pageIndex = 0; pageIndex < headerCold.pageCount; ++pageIndex)
+            {
+                const wIndex pageBegin = pageIndex * type.pageSize;
+                const wIndex pageEnd = std::clamp(headerCold.slotCount, pageBegin, pageBegin + type.pageSize);
+                if (pages[pageIndex] && std::none_of(headerHot.generations + pageBegin, headerHot.generations + pageEnd, ComponentSetup::IsPageSlotAlive))
+                {
+                    allocator.pages->Deallocate(pages[pageIndex], type.pageSize * type.size, type.alignment);
+                    pages[pageIndex] = nullptr;
+                }
+            }
 
-            return SceneHandle(m_sceneSlotCount++, *std::construct_at(m_sceneGenerations + m_sceneSlotCount));
+            // Pages past the last slot were never used, the generations of every slot before it must stay
+            const wIndex usedPageCount = wUtils::IntDivCeil(headerCold.slotCount, type.pageSize);
+            if (!inArena && usedPageCount < headerCold.pageCount)
+            {
+                void** newPages = nullptr;
+                ComponentGeneration* newGenerations = nullptr;
+                if (usedPageCount)
+                {
+                    newPages = static_cast<void**>(
+                        allocator.lists->Allocate(usedPageCount * sizeof(void*), alignof(void*))
+                    );
+                    newGenerations = static_cast<ComponentGeneration*>(
+                        allocator.lists->Allocate(usedPageCount * type.pageSize * sizeof(ComponentGeneration), alignof(ComponentGeneration))
+                    );
+                    std::memcpy(newPages, pages, usedPageCount * sizeof(void*));
+                    std::memcpy(newGenerations, headerHot.generations, usedPageCount * type.pageSize * sizeof(ComponentGeneration));
+                }
+                allocator.lists->Deallocate(pages, headerCold.pageCount * sizeof(void*), alignof(void*));
+                allocator.lists->Deallocate(headerHot.generations, headerCold.pageCount * type.pageSize * sizeof(ComponentGeneration), alignof(ComponentGeneration));
+
+                headerHot.data = newPages;
+                headerHot.generations = newGenerations;
+                headerCold.pageCount = usedPageCount;
+            }
         }
-        const SceneIndex sceneIndex = m_sceneFreeList.Remove();
+        else
+        {
+            ComponentSetup::ComponentListHeaderHot& headerHot = m_createCtx.GetComponentListHot(sceneIndex, type.listIndex);
+            ComponentSetup::ComponentListHeaderCold& headerCold = m_createCtx.GetComponentListCold(sceneIndex, type.listIndex);
+            // Free slots keep their generations, so the block can only shrink to the slot count
+            if (!inArena && headerCold.capacity > headerCold.slotCount)
+            {
+                if (headerCold.slotCount)
+                {
+                    type.reallocateComponents(headerHot, headerCold, headerCold.slotCount, allocator);
+                }
+                else
+                {
+                    allocator.lists->Deallocate(headerHot.dense, ComponentSetup::GetComponentBlockLayout(type.size, headerCold.capacity).size, ComponentSetup::GetComponentBlockAlignment(type.alignment));
+                    headerHot = {};
+                    headerCold.capacity = 0;
+                }
+            }
+        }
+        return bytesReserved - GetComponentListStats(componentTypeIndex, sceneIndex).bytesReserved;
+    }
 
-        // Reset the memory
-        const std::size_t sceneStartComponentIndex = (sceneIndex - 1) * m_componentSetup.GetCurrentComponentListCount();
-        const std::size_t sceneStartPageIndex = (sceneIndex - 1) * m_componentSetup.GetCurrentComponentListCount();
+    std::size_t ComponentSystem::CompactSceneBlock()
+    {
+        const wIndex capacity = std::max<wIndex>(m_sceneSlotCount, 1);
+        // Late lists are folded into the stride even if the capacity is already tight
+        const bool hasLateLists = m_createCtx.lateComponentListCount || m_createCtx.latePageListCount;
+        if (!m_scenes || (m_sceneSlotCapacity <= capacity && !hasLateLists))
+        {
+            return 0;
+        }
+        const std::size_t sceneBlockSize = m_sceneBlockSize;
+        const std::size_t lateListsSize = GetLateListsSize();
+        ReallocateScenes(std::min(capacity, m_sceneSlotCapacity));
+        return sceneBlockSize + lateListsSize > m_sceneBlockSize ? sceneBlockSize + lateListsSize - m_sceneBlockSize : 0;
+    }
 
-        std::memset(m_componentListsHot + sceneStartComponentIndex, 0, sizeof(ComponentSetup::ComponentListHeaderHot) * GetCurrentComponentListCount());
-        std::memset(m_pageListsHot + sceneStartPageIndex, 0, sizeof(ComponentSetup::PageListHeaderHot) * GetCurrentPageListCount());
-        std::memset(m_componentListsCold + sceneStartComponentIndex, 0, sizeof(ComponentSetup::ComponentListHeaderCold) * GetCurrentComponentListCount());
-        std::memset(m_pageListsCold + sceneStartPageIndex, 0, sizeof(ComponentSetup::PageListHeaderCold) * GetCurrentPageListCount());
-        std::construct_at(m_sceneData + sceneIndex - 1);
+    void ComponentSystem::ReserveScenes(wIndex minCapacity)
+    {
+        if (minCapacity > m_sceneSlotCapacity)
+        {
+            const WriteScope writeScope(*this);
+            ReallocateScenes(minCapacity);
+        }
+    }
+
+    SceneHandle ComponentSystem::CreateScene(std::string_view name)
+    {
+        W_PROFILE_ZONE("ComponentSystem::CreateScene");
+        const WriteScope writeScope(*this);
+        const SceneIndex sceneIndex = ClaimSceneSlot();
+
+        // Reset the memory
+        ClearSceneHeaders(sceneIndex);
+        SceneData& sceneData = *std::construct_at(m_sceneData + sceneIndex - 1);
+        sceneData.arena = AcquireSceneArena();
 
         return SceneHandle(sceneIndex, m_sceneGenerations[sceneIndex - 1]);
     }
 
-    /*void ComponentSystem::DestroyScene(wIndex sceneIndex)
+    SceneHandle ComponentSystem::CloneScene(SceneHandle sceneHandle, std::string_view name)
+    {
+        W_PROFILE_ZONE("ComponentSystem::CloneScene");
+        W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+        const WriteScope writeScope(*this);
+        // The lists of a new scene are empty, so the single instance starts at the first slot
+        const SceneHandle clone = CreateScene(name);
+        InstantiatePrefab(sceneHandle, clone, 1);
+        return clone;
+    }
+
+    PrefabInstances ComponentSystem::InstantiatePrefab(SceneHandle prefabSceneHandle, SceneHandle sceneHandle, wIndex count)
     {
-        const std::size_t sceneStartListIndex = GetSceneStartListIndex(sceneIndex);
-        ComponentSetup::ListHeader& firstElement = m_componentLists[sceneStartListIndex];
-        if (firstElement.begin)
+        W_PROFILE_ZONE("ComponentSystem::InstantiatePrefab");
+        W_ASSERT(SceneExists(prefabSceneHandle), "Prefab Scene: {} does not exist", prefabSceneHandle.sceneIndex);
+        W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+        const WriteScope writeScope(*this);
+        const ComponentSetup::ComponentAllocator allocator = GetComponentAllocator(sceneHandle.sceneIndex);
+
+        PrefabInstances instances{ &m_componentSetup, sceneHandle, count, std::vector<PrefabInstances::Range>(m_componentSetup.GetComponentTypeCount()), InvalidEntity, 0 };
+        for (ComponentTypeIndex componentTypeIndex = ComponentTypeIndexStart; componentTypeIndex <= m_componentSetup.GetComponentTypeCount(); ++componentTypeIndex)
+        {
+            const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+            if (type.IsChunked())
+            {
+                W_ASSERT(!GetComponentCount(componentTypeIndex, prefabSceneHandle.sceneIndex), "Prefab Scene: {} has Component: {}, which uses ChunkedStorage and can not be instantiated", prefabSceneHandle.sceneIndex, m_componentSetup.GetComponentTypeNameFromTypeIndex(componentTypeIndex));
+                continue;
+            }
+            PrefabInstances::Range& range = instances.ranges[componentTypeIndex - 1];
+            range.prefabSlotCount = type.pageSize ? m_createCtx.GetPageListCold(prefabSceneHandle.sceneIndex, type.listIndex).slotCount : m_createCtx.GetComponentListCold(prefabSceneHandle.sceneIndex, type.listIndex).slotCount;
+            range.firstSlot = type.instantiate(prefabSceneHandle.sceneIndex, sceneHandle.sceneIndex, count, m_createCtx, allocator);
+            if (type.sortList)
+            {
+                // The copies carry their keys, so the appended tail is merged in right away
+                type.sortList(sceneHandle.sceneIndex, m_createCtx);
+            }
+            if (m_componentEvents)
+            {
+                PublishCreatedSlots(componentTypeIndex, sceneHandle, range.firstSlot);
+            }
+        }
+
+        if (const EntityTable* prefabEntities = GetEntityTable(prefabSceneHandle.sceneIndex))
         {
-            DeleteSceneContent(sceneStartListIndex);
-            firstElement.begin = nullptr;
-            m_sceneFreeList.push_back(sceneIndex);
+            EntityTable*& entities = m_sceneData[sceneHandle.sceneIndex - 1].entities;
+            if (!entities)
+            {
+                entities = new EntityTable();
+            }
+            instances.prefabEntitySlotCount = prefabEntities->GetEntitySlotCount();
+            instances.firstEntity = entities->Instantiate(*prefabEntities, count, [&instances](ComponentTypeIndex componentTypeIndex, ComponentIndex prefabComponentIndex, wIndex instance)
+            {
+                const PrefabInstances::Range& range = instances.ranges[componentTypeIndex - 1];
+                return range.firstSlot + instance * range.prefabSlotCount + prefabComponentIndex - 1;
+            });
         }
-    }*/
+        return instances;
+    }
+
+    void ComponentSystem::DestroyScene(SceneHandle sceneHandle) noexcept
+    {
+        W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+        const WriteScope writeScope(*this);
+        const SceneIndex sceneIndex = sceneHandle.sceneIndex;
+        DeleteSceneContent(sceneIndex);
+        ClearSceneHeaders(sceneIndex);
+        m_sceneData[sceneIndex - 1].archetypes = nullptr;
+        m_sceneData[sceneIndex - 1].entities = nullptr;
+        ReleaseSceneArena(m_sceneData[sceneIndex - 1].arena);
+        m_sceneData[sceneIndex - 1].arena = nullptr;
+
+        ++m_sceneGenerations[sceneIndex - 1].generation;
+        m_sceneFreeList.Add(sceneIndex);
+    }
 
     void ComponentSystem::ReserveComponents(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex, wIndex minCapacity)
     {
-        const ComponentSetup::ComponentType type = m_componentSetup.m_types[componentTypeIndex - 1];
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+        W_ASSERT(!type.IsChunked(), "Component: {} uses ChunkedStorage, reserve through its archetype instead", m_componentSetup.GetComponentTypeNameFromTypeIndex(componentTypeIndex));
+        const WriteScope writeScope(*this);
+        ReserveComponents(type, m_createCtx, sceneIndex, minCapacity, GetComponentAllocator(sceneIndex));
+    }
+
+    void ComponentSystem::ReserveComponents(const ComponentSetup::ComponentType& type, ComponentSetup::CreateCtx& createCtx, SceneIndex sceneIndex, wIndex minCapacity, const ComponentSetup::ComponentAllocator& allocator)
+    {
         if (type.pageSize)
         {
-            const std::size_t sceneStartPageIndex = (sceneIndex - 1) * m_createCtx.GetCurrentPageListCount();
-            const std::size_t pageListHeaderIndex = sceneStartPageIndex + type.listIndex;
-            ComponentSetup::PageListHeaderCold& pageListHeaderCold = m_createCtx.pageListsCold[pageListHeaderIndex];
+            ComponentSetup::PageListHeaderCold& pageListHeaderCold = createCtx.GetPageListCold(sceneIndex, type.listIndex);
             if (minCapacity > pageListHeaderCold.pageCount * type.pageSize)
             {
                 const wIndex minPageCount = wUtils::IntDivCeil(minCapacity, type.pageSize);
-                type.reallocatePages(m_createCtx.pageListsHot[pageListHeaderIndex], pageListHeaderCold, minPageCount);
+                type.reallocatePages(createCtx.GetPageListHot(sceneIndex, type.listIndex), pageListHeaderCold, minPageCount, allocator);
             }
         }
         else
         {
-            const std::size_t sceneStartComponentIndex = (sceneIndex - 1) * m_createCtx.GetCurrentComponentListCount();
-            const std::size_t componentListHeaderIndex = sceneStartComponentIndex + type.listIndex - 1;
-            ComponentSetup::ComponentListHeaderCold& componentListHeaderCold = m_createCtx.componentListsCold[componentListHeaderIndex];
+            ComponentSetup::ComponentListHeaderCold& componentListHeaderCold = createCtx.GetComponentListCold(sceneIndex, type.listIndex);
             if (minCapacity > componentListHeaderCold.capacity)
             {
-                type.reallocateComponents(m_createCtx.componentListsHot[componentListHeaderIndex], componentListHeaderCold, minCapacity);
+                type.reallocateComponents(createCtx.GetComponentListHot(sceneIndex, type.listIndex), componentListHeaderCold, minCapacity, allocator);
             }
         }
     }
 
     ComponentHandleAny ComponentSystem::CreateComponent(ComponentTypeIndex componentTypeIndex, SceneHandle scene)
     {
-        const ComponentSetup::ComponentType type = m_componentSetup.m_types[componentTypeIndex - 1];
-        auto [componentIndex, generation] = type.create(scene.sceneIndex, m_createCtx, m_app);
-        return ComponentHandleAny(componentTypeIndex, scene, componentIndex, generation);
+        W_ASSERT(SceneExists(scene), "Scene: {} does not exist", scene.sceneIndex);
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+        W_ASSERT(!type.IsChunked(), "Component: {} uses ChunkedStorage, use CreateArchetypeEntity instead", m_componentSetup.GetComponentTypeNameFromTypeIndex(componentTypeIndex));
+        const WriteScope writeScope(*this);
+        auto [componentIndex, generation] = type.create(scene.sceneIndex, m_createCtx, GetComponentAllocator(scene.sceneIndex), m_app);
+        const ComponentHandleAny handle(componentTypeIndex, scene, componentIndex, generation);
+        if (m_componentEvents)
+        {
+            m_app.GetEventBus().Publish<ComponentCreatedEvent>(handle);
+        }
+        return handle;
+    }
+
+    void ComponentSystem::DestroyComponent(ComponentHandleAny componentHandle)
+    {
+        W_ASSERT(ComponentExists(componentHandle), "Component: {} of type {} does not exist", componentHandle.componentIndex, m_componentSetup.GetComponentTypeNameFromTypeIndex(componentHandle.componentTypeIndex));
+        const WriteScope writeScope(*this);
+        if (EntityTable* entities = GetEntityTable(componentHandle.sceneHandle.sceneIndex))
+        {
+            entities->UnlinkSlot(componentHandle.componentTypeIndex, componentHandle.componentIndex);
+        }
+        if (m_componentEvents)
+        {
+            m_app.GetEventBus().Publish<ComponentDestroyedEvent>(componentHandle);
+        }
+        m_componentSetup.m_types[componentHandle.componentTypeIndex - 1].remove(componentHandle.sceneHandle.sceneIndex, componentHandle.componentIndex, m_createCtx);
+    }
+
+    void ComponentSystem::CreateComponents(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle, wIndex count, ComponentIndex* outIndices, std::size_t outStride)
+    {
+        W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+        W_ASSERT(!type.IsChunked(), "Component: {} uses ChunkedStorage, use CreateArchetypeEntity instead", m_componentSetup.GetComponentTypeNameFromTypeIndex(componentTypeIndex));
+        if (m_componentEvents && !outIndices)
+        {
+            // The events need the slots
+            std::vector<ComponentIndex> componentIndices(count);
+            CreateComponents(componentTypeIndex, sceneHandle, count, componentIndices.data());
+            return;
+        }
+        const WriteScope writeScope(*this);
+        type.createBatch(sceneHandle.sceneIndex, count, outIndices, outStride, m_createCtx, GetComponentAllocator(sceneHandle.sceneIndex), m_app);
+        if (m_componentEvents)
+        {
+            const std::byte* out = reinterpret_cast<const std::byte*>(outIndices);
+            for (wIndex i = 0; i < count; ++i)
+            {
+                m_app.GetEventBus().Publish<ComponentCreatedEvent>(GetSlotHandle(componentTypeIndex, sceneHandle, ComponentSetup::ReadComponentIndex(out, outStride, i)));
+            }
+        }
+    }
+
+    void ComponentSystem::DestroyComponents(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle, const ComponentIndex* componentIndices, wIndex count, std::size_t stride)
+    {
+        W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+        const WriteScope writeScope(*this);
+        if (EntityTable* entities = GetEntityTable(sceneHandle.sceneIndex))
+        {
+            const std::byte* in = reinterpret_cast<const std::byte*>(componentIndices);
+            for (wIndex i = 0; i < count; ++i)
+            {
+                entities->UnlinkSlot(componentTypeIndex, ComponentSetup::ReadComponentIndex(in, stride, i));
+            }
+        }
+        if (m_componentEvents)
+        {
+            const std::byte* in = reinterpret_cast<const std::byte*>(componentIndices);
+            for (wIndex i = 0; i < count; ++i)
+            {
+                m_app.GetEventBus().Publish<ComponentDestroyedEvent>(GetSlotHandle(componentTypeIndex, sceneHandle, ComponentSetup::ReadComponentIndex(in, stride, i)));
+            }
+        }
+        m_componentSetup.m_types[componentTypeIndex - 1].removeBatch(sceneHandle.sceneIndex, componentIndices, stride, count, m_createCtx);
     }
 
-    /*wIndex ComponentSystem::GetComponentCount(ComponentTypeIndex componentTypeIndex, wIndex sceneIndex) const
+    void ComponentSystem::SortComponents(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle)
     {
-        const ComponentSetup::ListHeader& header = GetComponentListHeader(sceneIndex, componentTypeIndex);
-        return (header.End<std::byte>() - header.Begin<std::byte>()) / m_componentSetup.m_types[componentTypeIndex - 1].size;
+        W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+        W_ASSERT(type.sortList, "Component: {} has no sort key", m_componentSetup.GetComponentTypeNameFromTypeIndex(componentTypeIndex));
+        const WriteScope writeScope(*this);
+        type.sortList(sceneHandle.sceneIndex, m_createCtx);
     }
 
-    wIndex ComponentSystem::GetComponentCapacity(ComponentTypeIndex componentTypeIndex, wIndex sceneIndex) const
+    void ComponentSystem::SortComponent(ComponentHandleAny componentHandle) noexcept
     {
-        const ComponentSetup::ListHeader& header = GetComponentListHeader(sceneIndex, componentTypeIndex);
-        return (header.Capacity<std::byte>() - header.Begin<std::byte>()) / m_componentSetup.m_types[componentTypeIndex - 1].size;
-    }*/
+        W_ASSERT(ComponentExists(componentHandle), "Component: {} of type {} does not exist", componentHandle.componentIndex, m_componentSetup.GetComponentTypeNameFromTypeIndex(componentHandle.componentTypeIndex));
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentHandle.componentTypeIndex - 1];
+        W_ASSERT(type.sortComponent, "Component: {} has no sort key", m_componentSetup.GetComponentTypeNameFromTypeIndex(componentHandle.componentTypeIndex));
+        const WriteScope writeScope(*this);
+        type.sortComponent(componentHandle.sceneHandle.sceneIndex, componentHandle.componentIndex, m_createCtx);
+    }
+
+    bool ComponentSystem::ComponentExists(ComponentHandleAny componentHandle) const noexcept
+    {
+        if (!SceneExists(componentHandle.sceneHandle) || componentHandle.componentIndex == InvalidComponent)
+        {
+            return false;
+        }
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentHandle.componentTypeIndex - 1];
+        const SceneIndex sceneIndex = componentHandle.sceneHandle.sceneIndex;
+        if (type.pageSize)
+        {
+            return componentHandle.componentIndex <= m_createCtx.GetPageListCold(sceneIndex, type.listIndex).slotCount
+                && m_createCtx.GetPageListHot(sceneIndex, type.listIndex).generations[componentHandle.componentIndex - 1] == componentHandle.generation;
+        }
+        return componentHandle.componentIndex <= m_createCtx.GetComponentListCold(sceneIndex, type.listIndex).slotCount
+            && m_createCtx.GetComponentListHot(sceneIndex, type.listIndex).generations[componentHandle.componentIndex - 1] == componentHandle.generation;
+    }
+
+    void* ComponentSystem::TryGet(ComponentHandleAny componentHandle) const noexcept
+    {
+        W_ASSERT(m_epochMemory && m_epochMemory->IsReading(), "TryGet needs Config::concurrentLookup and a ConcurrentReadGuard");
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentHandle.componentTypeIndex - 1];
+        W_ASSERT(!type.IsChunked(), "Component: {} uses ChunkedStorage and can not be looked up concurrently", m_componentSetup.GetComponentTypeNameFromTypeIndex(componentHandle.componentTypeIndex));
+        if (componentHandle.sceneHandle.sceneIndex == InvalidScene || componentHandle.componentIndex == InvalidComponent)
+        {
+            return nullptr;
+        }
+
+        for (;;)
+        {
+            const uint64_t sequence = m_sequence.load(std::memory_order_acquire);
+            if (sequence & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            void* component = LoadComponent(type, componentHandle, sequence);
+            if (ValidateSequence(sequence))
+            {
+                return component;
+            }
+        }
+    }
+
+    bool ComponentSystem::ValidateSequence(uint64_t sequence) const noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return m_sequence.load(std::memory_order_relaxed) == sequence;
+    }
+
+    void* ComponentSystem::LoadComponent(const ComponentSetup::ComponentType& type, ComponentHandleAny componentHandle, uint64_t sequence) const noexcept
+    {
+        // Every array is validated together with its bound before it is indexed. Arrays replaced meanwhile are retired,
+        // not freed, so they stay readable until the guard ends. nullptr after a failed validation is retried by TryGet.
+        const SceneIndex sceneIndex = componentHandle.sceneHandle.sceneIndex;
+        const wIndex sceneSlotCount = LoadRacy(m_sceneSlotCount);
+        const SceneGeneration* sceneGenerations = LoadRacy(m_sceneGenerations);
+        if (!ValidateSequence(sequence) || sceneIndex > sceneSlotCount || !(LoadRacy(sceneGenerations[sceneIndex - 1]) == componentHandle.sceneHandle.generation))
+        {
+            return nullptr;
+        }
+
+        const wIndex slotIndex = componentHandle.componentIndex - 1;
+        if (type.pageSize)
+        {
+            const auto [pageListHot, pageListCold] = LoadListHeaders(m_createCtx.pageListsHot, m_createCtx.pageListsCold, m_createCtx.latePageLists, m_createCtx.currentPageListCount, m_createCtx.latePageListCount, sceneIndex, type.listIndex, sequence);
+            if (!pageListHot)
+            {
+                return nullptr;
+            }
+            const wIndex slotCount = LoadRacy(pageListCold->slotCount);
+            void* pages = LoadRacy(pageListHot->data);
+            const ComponentGeneration* generations = LoadRacy(pageListHot->generations);
+            if (!ValidateSequence(sequence) || componentHandle.componentIndex > slotCount || !(LoadRacy(generations[slotIndex]) == componentHandle.generation))
+            {
+                return nullptr;
+            }
+            std::byte* const page = static_cast<std::byte*>(LoadRacy(static_cast<void* const*>(pages)[slotIndex / type.pageSize]));
+            if (!page)
+            {
+                return nullptr;
+            }
+            return page + slotIndex % type.pageSize * type.size;
+        }
+
+        const auto [componentListHot, componentListCold] = LoadListHeaders(m_createCtx.componentListsHot, m_createCtx.componentListsCold, m_createCtx.lateComponentLists, m_createCtx.currentComponentListCount, m_createCtx.lateComponentListCount, sceneIndex, type.listIndex, sequence);
+        if (!componentListHot)
+        {
+            return nullptr;
+        }
+        const wIndex slotCount = LoadRacy(componentListCold->slotCount);
+        void* dense = LoadRacy(componentListHot->dense);
+        const ComponentIndex* slotToDense = LoadRacy(componentListHot->slotToDense);
+        const ComponentGeneration* generations = LoadRacy(componentListHot->generations);
+        if (!ValidateSequence(sequence) || componentHandle.componentIndex > slotCount || !(LoadRacy(generations[slotIndex]) == componentHandle.generation))
+        {
+            return nullptr;
+        }
+        // slotToDense lives in the same block as dense, so the position is in range of the block it was read from
+        const ComponentIndex densePosition = LoadRacy(slotToDense[slotIndex]);
+        return densePosition ? static_cast<std::byte*>(dense) + (densePosition - 1) * type.size : nullptr;
+    }
+
+    wIndex ComponentSystem::GetComponentCount(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex) const
+    {
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+        if (type.IsChunked())
+        {
+            const ArchetypeStorage* storage = GetArchetypeStorage(sceneIndex);
+            return storage ? storage->GetComponentCount(type.listIndex) : 0;
+        }
+        if (type.pageSize)
+        {
+            const ComponentSetup::PageListHeaderCold& headerCold = m_createCtx.GetPageListCold(sceneIndex, type.listIndex);
+            return headerCold.slotCount - headerCold.freeList.Count();
+        }
+        return m_createCtx.GetComponentListCold(sceneIndex, type.listIndex).denseCount;
+    }
+
+    wIndex ComponentSystem::GetComponentCapacity(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex) const
+    {
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+        if (type.IsChunked())
+        {
+            const ArchetypeStorage* storage = GetArchetypeStorage(sceneIndex);
+            return storage ? storage->GetComponentCapacity(type.listIndex) : 0;
+        }
+        if (type.pageSize)
+        {
+            return m_createCtx.GetPageListCold(sceneIndex, type.listIndex).pageCount * type.pageSize;
+        }
+        return m_createCtx.GetComponentListCold(sceneIndex, type.listIndex).capacity;
+    }
+
+    ComponentListStats ComponentSystem::GetComponentListStats(ComponentTypeIndex componentTypeIndex, SceneIndex sceneIndex) const noexcept
+    {
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+        ComponentListStats stats = {};
+        if (type.IsChunked())
+        {
+            if (const ArchetypeStorage* storage = GetArchetypeStorage(sceneIndex))
+            {
+                stats.liveCount = storage->GetComponentCount(type.listIndex);
+                stats.capacity = storage->GetComponentCapacity(type.listIndex);
+                stats.bytesReserved = stats.capacity * type.size;
+            }
+        }
+        else if (type.pageSize)
+        {
+            const ComponentSetup::PageListHeaderCold& headerCold = m_createCtx.GetPageListCold(sceneIndex, type.listIndex);
+            stats.freeListCount = headerCold.freeList.Count();
+            stats.liveCount = headerCold.slotCount - stats.freeListCount;
+            stats.capacity = headerCold.pageCount * type.pageSize;
+            stats.slotCount = headerCold.slotCount;
+            stats.pageCount = headerCold.pageCount;
+            const void* const* pages = static_cast<const void* const*>(m_createCtx.GetPageListHot(sceneIndex, type.listIndex).data);
+            stats.residentPageCount = static_cast<wIndex>(std::count_if(pages, pages + headerCold.pageCount, [](const void* page) { return page != nullptr; }));
+            stats.bytesReserved = stats.residentPageCount * type.pageSize * type.size + stats.capacity * sizeof(ComponentGeneration) + stats.pageCount * sizeof(void*);
+        }
+        else
+        {
+            const ComponentSetup::ComponentListHeaderCold& headerCold = m_createCtx.GetComponentListCold(sceneIndex, type.listIndex);
+            stats.liveCount = headerCold.denseCount;
+            stats.capacity = headerCold.capacity;
+            stats.slotCount = headerCold.slotCount;
+            stats.freeListCount = headerCold.freeList.Count();
+            stats.bytesReserved = headerCold.capacity ? ComponentSetup::GetComponentBlockLayout(type.size, headerCold.capacity).size : 0;
+        }
+        stats.bytesUsed = stats.liveCount * type.size;
+        return stats;
+    }
+
+    SceneStats ComponentSystem::GetSceneStats(SceneIndex sceneIndex) const noexcept
+    {
+        SceneStats stats = {};
+        for (ComponentTypeIndex componentTypeIndex = ComponentTypeIndexStart; componentTypeIndex <= m_createCtx.GetCurrentComponentTypeCount(); ++componentTypeIndex)
+        {
+            const ComponentListStats listStats = GetComponentListStats(componentTypeIndex, sceneIndex);
+            stats.componentCount += listStats.liveCount;
+            stats.bytesReserved += listStats.bytesReserved;
+            stats.bytesUsed += listStats.bytesUsed;
+        }
+        if (const SceneArena* arena = m_sceneData[sceneIndex - 1].arena)
+        {
+            stats.arenaBytesReserved = arena->GetBytesReserved();
+        }
+        return stats;
+    }
+
+    ReallocationHistogram::Buckets ComponentSystem::GetReallocationHistogram(ComponentTypeIndex componentTypeIndex) const noexcept
+    {
+        if (!m_reallocationHistogram || componentTypeIndex == InvalidComponentType || componentTypeIndex > m_reallocationHistogram->GetComponentTypeCount())
+        {
+            return {};
+        }
+        return m_reallocationHistogram->Get(componentTypeIndex);
+    }
+
+    ArchetypeEntityHandle ComponentSystem::CreateArchetypeEntity(SceneHandle sceneHandle, ArchetypeSignature signature)
+    {
+        W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+        ArchetypeStorage*& storage = m_sceneData[sceneHandle.sceneIndex - 1].archetypes;
+        if (!storage)
+        {
+            storage = new ArchetypeStorage(*m_pageMemoryResource);
+        }
+        auto [entityIndex, generation] = storage->Create(signature, m_componentSetup, m_app);
+        return ArchetypeEntityHandle(sceneHandle, entityIndex, generation);
+    }
+
+    void ComponentSystem::DestroyArchetypeEntity(ArchetypeEntityHandle entityHandle) noexcept
+    {
+        W_ASSERT(ArchetypeEntityExists(entityHandle), "ArchetypeEntity: {} does not exist", entityHandle.entityIndex);
+        GetArchetypeStorage(entityHandle.sceneHandle.sceneIndex)->Destroy(entityHandle.entityIndex);
+    }
+
+    bool ComponentSystem::ArchetypeEntityExists(ArchetypeEntityHandle entityHandle) const noexcept
+    {
+        if (!SceneExists(entityHandle.sceneHandle))
+        {
+            return false;
+        }
+        const ArchetypeStorage* storage = GetArchetypeStorage(entityHandle.sceneHandle.sceneIndex);
+        return storage && storage->EntityExists(entityHandle.entityIndex, entityHandle.generation);
+    }
+
+    EntityHandle ComponentSystem::CreateEntity(SceneHandle sceneHandle)
+    {
+        W_ASSERT(SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+        EntityTable*& entities = m_sceneData[sceneHandle.sceneIndex - 1].entities;
+        if (!entities)
+        {
+            entities = new EntityTable();
+        }
+        auto [entityIndex, generation] = entities->Create();
+        return EntityHandle(sceneHandle, entityIndex, generation);
+    }
+
+    void ComponentSystem::DestroyEntity(EntityHandle entityHandle)
+    {
+        W_ASSERT(EntityExists(entityHandle), "Entity: {} does not exist", entityHandle.entityIndex);
+        const WriteScope writeScope(*this);
+        EntityTable& entities = *GetEntityTable(entityHandle.sceneHandle.sceneIndex);
+        entities.EachComponentType(entityHandle.entityIndex, [this, &entities, entityHandle](ComponentTypeIndex componentTypeIndex)
+        {
+            const ComponentIndex componentIndex = entities.GetSlot(entityHandle.entityIndex, componentTypeIndex);
+            entities.Unlink(entityHandle.entityIndex, componentTypeIndex);
+            if (m_componentEvents)
+            {
+                m_app.GetEventBus().Publish<ComponentDestroyedEvent>(GetSlotHandle(componentTypeIndex, entityHandle.sceneHandle, componentIndex));
+            }
+            m_componentSetup.m_types[componentTypeIndex - 1].remove(entityHandle.sceneHandle.sceneIndex, componentIndex, m_createCtx);
+        });
+        entities.Destroy(entityHandle.entityIndex);
+    }
+
+    bool ComponentSystem::EntityExists(EntityHandle entityHandle) const noexcept
+    {
+        if (!SceneExists(entityHandle.sceneHandle))
+        {
+            return false;
+        }
+        const EntityTable* entities = GetEntityTable(entityHandle.sceneHandle.sceneIndex);
+        return entities && entities->EntityExists(entityHandle.entityIndex, entityHandle.generation);
+    }
+
+    ComponentHandleAny ComponentSystem::AddComponent(ComponentTypeIndex componentTypeIndex, EntityHandle entityHandle)
+    {
+        W_ASSERT(EntityExists(entityHandle), "Entity: {} does not exist", entityHandle.entityIndex);
+        EntityTable& entities = *GetEntityTable(entityHandle.sceneHandle.sceneIndex);
+        W_ASSERT(!entities.Has(entityHandle.entityIndex, componentTypeIndex), "Entity: {} already has Component: {}", entityHandle.entityIndex, m_componentSetup.GetComponentTypeNameFromTypeIndex(componentTypeIndex));
+        const ComponentHandleAny handle = CreateComponent(componentTypeIndex, entityHandle.sceneHandle);
+        entities.Link(entityHandle.entityIndex, componentTypeIndex, handle.componentIndex);
+        return handle;
+    }
+
+    void ComponentSystem::RemoveComponent(ComponentTypeIndex componentTypeIndex, EntityHandle entityHandle)
+    {
+        W_ASSERT(EntityExists(entityHandle), "Entity: {} does not exist", entityHandle.entityIndex);
+        EntityTable& entities = *GetEntityTable(entityHandle.sceneHandle.sceneIndex);
+        W_ASSERT(entities.Has(entityHandle.entityIndex, componentTypeIndex), "Entity: {} has no Component: {}", entityHandle.entityIndex, m_componentSetup.GetComponentTypeNameFromTypeIndex(componentTypeIndex));
+        const WriteScope writeScope(*this);
+        const ComponentIndex componentIndex = entities.GetSlot(entityHandle.entityIndex, componentTypeIndex);
+        entities.Unlink(entityHandle.entityIndex, componentTypeIndex);
+        if (m_componentEvents)
+        {
+            m_app.GetEventBus().Publish<ComponentDestroyedEvent>(GetSlotHandle(componentTypeIndex, entityHandle.sceneHandle, componentIndex));
+        }
+        m_componentSetup.m_types[componentTypeIndex - 1].remove(entityHandle.sceneHandle.sceneIndex, componentIndex, m_createCtx);
+    }
+
+    ComponentHandleAny ComponentSystem::GetSlotHandle(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle, ComponentIndex componentIndex) const noexcept
+    {
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+        const ComponentGeneration generation = type.pageSize
+            ? m_createCtx.GetPageListHot(sceneHandle.sceneIndex, type.listIndex).generations[componentIndex - 1]
+            : m_createCtx.GetComponentListHot(sceneHandle.sceneIndex, type.listIndex).generations[componentIndex - 1];
+        return ComponentHandleAny(componentTypeIndex, sceneHandle, componentIndex, generation);
+    }
+
+    void ComponentSystem::PublishCreatedSlots(ComponentTypeIndex componentTypeIndex, SceneHandle sceneHandle, ComponentIndex firstSlot)
+    {
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+        EventBus& eventBus = m_app.GetEventBus();
+        if (type.pageSize)
+        {
+            const ComponentSetup::PageListHeaderHot& headerHot = m_createCtx.GetPageListHot(sceneHandle.sceneIndex, type.listIndex);
+            const wIndex slotCount = m_createCtx.GetPageListCold(sceneHandle.sceneIndex, type.listIndex).slotCount;
+            for (ComponentIndex componentIndex = firstSlot; componentIndex <= slotCount; ++componentIndex)
+            {
+                if (ComponentSetup::IsPageSlotAlive(headerHot.generations[componentIndex - 1]))
+                {
+                    eventBus.Publish<ComponentCreatedEvent>(ComponentHandleAny(componentTypeIndex, sceneHandle, componentIndex, headerHot.generations[componentIndex - 1]));
+                }
+            }
+        }
+        else
+        {
+            const ComponentSetup::ComponentListHeaderHot& headerHot = m_createCtx.GetComponentListHot(sceneHandle.sceneIndex, type.listIndex);
+            const wIndex slotCount = m_createCtx.GetComponentListCold(sceneHandle.sceneIndex, type.listIndex).slotCount;
+            for (ComponentIndex componentIndex = firstSlot; componentIndex <= slotCount; ++componentIndex)
+            {
+                if (headerHot.slotToDense[componentIndex - 1])
+                {
+                    eventBus.Publish<ComponentCreatedEvent>(ComponentHandleAny(componentTypeIndex, sceneHandle, componentIndex, headerHot.generations[componentIndex - 1]));
+                }
+            }
+        }
+    }
+
+    void ComponentSystem::PublishCreatedScene(SceneHandle sceneHandle)
+    {
+        for (ComponentTypeIndex componentTypeIndex = ComponentTypeIndexStart; componentTypeIndex <= m_componentSetup.GetComponentTypeCount(); ++componentTypeIndex)
+        {
+            if (!m_componentSetup.m_types[componentTypeIndex - 1].IsChunked())
+            {
+                PublishCreatedSlots(componentTypeIndex, sceneHandle, ComponentIndexStart);
+            }
+        }
+    }
 
     void ComponentSystem::ReallocateScenes(wIndex newCapacity)
     {
+        W_PROFILE_ZONE("ComponentSystem::ReallocateScenes");
         m_sceneSlotCapacity = newCapacity;
 
         if (!m_scenes) // TODO: Check if this if should be !
         {
-            m_createCtx.UpdateCurrentComponentListCount(m_componentSetup.GetComponentTypeCount(), m_componentSetup.m_componentListCount);
+            m_reallocationHistogram = std::make_unique<ReallocationHistogram>(m_componentSetup.GetComponentTypeCount());
         }
 
+        // Lists of types added since the last reallocation join the stride here
+        const wIndex componentListCount = m_componentSetup.m_componentListCount;
+        const wIndex pageListCount = m_componentSetup.m_pageListCount;
         std::size_t offset = 0;
 
         offset = wUtils::AlignUp(offset, alignof(ComponentSetup::ComponentListHeaderHot));
         const std::size_t componentListHotOffset = offset;
-        offset += m_createCtx.GetCurrentComponentListCount() * newCapacity * sizeof(ComponentSetup::ComponentListHeaderHot);
+        offset += componentListCount * newCapacity * sizeof(ComponentSetup::ComponentListHeaderHot);
 
         offset = wUtils::AlignUp(offset, alignof(ComponentSetup::PageListHeaderHot));
         const std::size_t pageListHotOffset = offset;
-        offset += m_createCtx.GetCurrentPageListCount() * newCapacity * sizeof(ComponentSetup::PageListHeaderHot);
+        offset += pageListCount * newCapacity * sizeof(ComponentSetup::PageListHeaderHot);
 
         offset = wUtils::AlignUp(offset, alignof(SceneGeneration));
         const std::size_t sceneGenerationOffset = offset;
@@ -154,21 +804,20 @@ namespace wCore
 
         offset = wUtils::AlignUp(offset, alignof(ComponentSetup::ComponentListHeaderCold));
         const std::size_t componentListColdOffset = offset;
-        offset += m_createCtx.GetCurrentComponentListCount() * newCapacity * sizeof(ComponentSetup::ComponentListHeaderCold);
+        offset += componentListCount * newCapacity * sizeof(ComponentSetup::ComponentListHeaderCold);
 
         offset = wUtils::AlignUp(offset, alignof(ComponentSetup::PageListHeaderCold));
         const std::size_t pageListColdOffset = offset;
-        offset += m_createCtx.GetCurrentPageListCount() * newCapacity * sizeof(ComponentSetup::PageListHeaderCold);
+        offset += pageListCount * newCapacity * sizeof(ComponentSetup::PageListHeaderCold);
 
         offset = wUtils::AlignUp(offset, alignof(SceneData));
         const std::size_t sceneDataOffset = offset;
         offset += newCapacity * sizeof(SceneData);
 
-        constexpr std::size_t alignment = wUtils::MaxAlignOf<ComponentSetup::ComponentListHeaderHot, ComponentSetup::PageListHeaderHot, SceneGeneration, ComponentSetup::ComponentListHeaderCold, ComponentSetup::PageListHeaderCold, SceneData>;
         if (m_scenes)
         {
             std::byte* newScenes = static_cast<std::byte*>(
-                ::operator new(offset, std::align_val_t(alignment))
+                m_memoryResource->Allocate(offset, SceneBlockAlignment)
             );
 
             ComponentSetup::ComponentListHeaderHot* newComponentListsHot = reinterpret_cast<ComponentSetup::ComponentListHeaderHot*>(newScenes + componentListHotOffset);
@@ -178,26 +827,53 @@ namespace wCore
             ComponentSetup::PageListHeaderCold* newPageListsCold = reinterpret_cast<ComponentSetup::PageListHeaderCold*>(newScenes + pageListColdOffset);
             SceneData* newSceneData = reinterpret_cast<SceneData*>(newScenes + sceneDataOffset);
 
+            if (m_sceneSlotCount && (m_createCtx.lateComponentListCount || m_createCtx.latePageListCount))
+            {
+                // The stride widens, so every scene's headers move to a new offset
+                for (SceneIndex sceneIndex = SceneIndexStart; sceneIndex <= m_sceneSlotCount; ++sceneIndex)
+                {
+                    for (wIndex listIndex = 0; listIndex < componentListCount; ++listIndex)
+                    {
+                        const std::size_t headerIndex = (sceneIndex - 1) * componentListCount + listIndex;
+                        std::memcpy(newComponentListsHot + headerIndex, &m_createCtx.GetComponentListHot(sceneIndex, listIndex), sizeof(ComponentSetup::ComponentListHeaderHot));
+                        std::memcpy(newComponentListsCold + headerIndex, &m_createCtx.GetComponentListCold(sceneIndex, listIndex), sizeof(ComponentSetup::ComponentListHeaderCold));
+                    }
+                    for (wIndex listIndex = 0; listIndex < pageListCount; ++listIndex)
+                    {
+                        const std::size_t headerIndex = (sceneIndex - 1) * pageListCount + listIndex;
+                        std::memcpy(newPageListsHot + headerIndex, &m_createCtx.GetPageListHot(sceneIndex, listIndex), sizeof(ComponentSetup::PageListHeaderHot));
+                        std::memcpy(newPageListsCold + headerIndex, &m_createCtx.GetPageListCold(sceneIndex, listIndex), sizeof(ComponentSetup::PageListHeaderCold));
+                    }
+                }
+            }
+            else if (m_sceneSlotCount)
+            {
+                std::memcpy(newComponentListsHot, m_createCtx.componentListsHot, m_sceneSlotCount * componentListCount * sizeof(ComponentSetup::ComponentListHeaderHot));
+                std::memcpy(newPageListsHot, m_createCtx.pageListsHot, m_sceneSlotCount * pageListCount * sizeof(ComponentSetup::PageListHeaderHot));
+                std::memcpy(newComponentListsCold, m_createCtx.componentListsCold, m_sceneSlotCount * componentListCount * sizeof(ComponentSetup::ComponentListHeaderCold));
+                std::memcpy(newPageListsCold, m_createCtx.pageListsCold, m_sceneSlotCount * pageListCount * sizeof(ComponentSetup::PageListHeaderCold));
+            }
             if (m_sceneSlotCount)
             {
-                std::memcpy(newComponentListsHot, m_createCtx.componentListsHot, m_sceneSlotCount * m_createCtx.GetCurrentComponentListCount() * sizeof(ComponentSetup::ComponentListHeaderHot));
-                std::memcpy(newPageListsHot, m_createCtx.pageListsHot, m_sceneSlotCount * m_createCtx.GetCurrentPageListCount() * sizeof(ComponentSetup::PageListHeaderHot));
                 std::memcpy(newSceneGenerations, m_sceneGenerations, m_sceneSlotCount * sizeof(SceneGeneration));
-                std::memcpy(newComponentListsCold, m_createCtx.componentListsCold, m_sceneSlotCount * m_createCtx.GetCurrentComponentListCount() * sizeof(ComponentSetup::ComponentListHeaderCold));
-                std::memcpy(newPageListsCold, m_createCtx.pageListsCold, m_sceneSlotCount * m_createCtx.GetCurrentPageListCount() * sizeof(ComponentSetup::ComponentListHeaderCold));
                 std::memcpy(newSceneData, m_sceneData, m_sceneSlotCount * sizeof(SceneData));
             }
 
-            ::operator delete(m_scenes, std::align_val_t(alignment));
+            FreeLateLists<ComponentSetup::ComponentListHeaderHot, ComponentSetup::ComponentListHeaderCold>(m_createCtx.lateComponentLists, m_createCtx.lateComponentListCount);
+            FreeLateLists<ComponentSetup::PageListHeaderHot, ComponentSetup::PageListHeaderCold>(m_createCtx.latePageLists, m_createCtx.latePageListCount);
+            m_memoryResource->Deallocate(m_scenes, m_sceneBlockSize, SceneBlockAlignment);
 
             m_scenes = newScenes;
         }
         else
         {
             m_scenes = static_cast<std::byte*>(
-                ::operator new(offset, std::align_val_t(alignment))
+                m_memoryResource->Allocate(offset, SceneBlockAlignment)
             );
         }
+        m_sceneBlockSize = offset;
+        m_createCtx.UpdateCurrentComponentListCount(m_componentSetup.GetComponentTypeCount(), componentListCount, pageListCount);
+        m_createCtx.lateSceneCapacity = newCapacity;
 
         m_createCtx.componentListsHot = reinterpret_cast<ComponentSetup::ComponentListHeaderHot*>(m_scenes + componentListHotOffset);
         m_createCtx.pageListsHot = reinterpret_cast<ComponentSetup::PageListHeaderHot*>(m_scenes + pageListHotOffset);
@@ -207,22 +883,250 @@ namespace wCore
         m_sceneData = reinterpret_cast<SceneData*>(m_scenes + sceneDataOffset);
     }
 
-    /*void ComponentSystem::DeleteSceneContent(std::size_t sceneStartListIndex) noexcept
+    void ComponentSystem::AddLateType(ComponentTypeIndex componentTypeIndex)
+    {
+        W_ASSERT(!m_stagedSceneCount, "Component types can not be added while {} staged scenes are pending", m_stagedSceneCount);
+        // Staged scenes are the only other recorders, so the histogram can grow here
+        if (m_reallocationHistogram)
+        {
+            m_reallocationHistogram->Resize(m_componentSetup.GetComponentTypeCount());
+        }
+        // Before the first scene the scene block is laid out with every type
+        if (!m_scenes)
+        {
+            return;
+        }
+        const ComponentSetup::ComponentType& type = m_componentSetup.m_types[componentTypeIndex - 1];
+        const WriteScope writeScope(*this);
+        if (type.IsPaged())
+        {
+            W_ASSERT(type.listIndex == m_createCtx.GetPageListCount(), "Paged list {} was not added last", type.listIndex);
+            AddLateList<ComponentSetup::PageListHeaderHot, ComponentSetup::PageListHeaderCold>(m_createCtx.latePageLists, m_createCtx.latePageListCount);
+        }
+        else if (!type.IsChunked())
+        {
+            W_ASSERT(type.listIndex == m_createCtx.GetComponentListCount(), "Component list {} was not added last", type.listIndex);
+            AddLateList<ComponentSetup::ComponentListHeaderHot, ComponentSetup::ComponentListHeaderCold>(m_createCtx.lateComponentLists, m_createCtx.lateComponentListCount);
+        }
+        m_createCtx.currentComponentTypeCount = componentTypeIndex;
+    }
+
+    template<typename Hot, typename Cold>
+    void ComponentSystem::AddLateList(void**& lateLists, wIndex& lateListCount)
+    {
+        // Only the new list is touched, zeroed headers are empty lists that fill on first use
+        const std::size_t lateListSize = ComponentSetup::CreateCtx::GetLateListSize<Hot, Cold>(m_createCtx.lateSceneCapacity);
+        void* lateList = m_memoryResource->Allocate(lateListSize, SceneBlockAlignment);
+        std::memset(lateList, 0, lateListSize);
+
+        void** newLateLists = static_cast<void**>(
+            m_memoryResource->Allocate((lateListCount + 1) * sizeof(void*), alignof(void*))
+        );
+        if (lateLists)
+        {
+            std::memcpy(newLateLists, lateLists, lateListCount * sizeof(void*));
+            m_memoryResource->Deallocate(lateLists, lateListCount * sizeof(void*), alignof(void*));
+        }
+        newLateLists[lateListCount] = lateList;
+        lateLists = newLateLists;
+        ++lateListCount;
+    }
+
+    template<typename Hot, typename Cold>
+    void ComponentSystem::FreeLateLists(void**& lateLists, wIndex& lateListCount) noexcept
+    {
+        if (!lateLists)
+        {
+            return;
+        }
+        for (wIndex lateIndex = 0; lateIndex < lateListCount; ++lateIndex)
+        {
+            m_memoryResource->Deallocate(lateLists[lateIndex], ComponentSetup::CreateCtx::GetLateListSize<Hot, Cold>(m_createCtx.lateSceneCapacity), SceneBlockAlignment);
+        }
+        m_memoryResource->Deallocate(lateLists, lateListCount * sizeof(void*), alignof(void*));
+        lateLists = nullptr;
+        lateListCount = 0;
+    }
+
+    std::size_t ComponentSystem::GetLateListsSize() const noexcept
+    {
+        const std::size_t componentListsSize = m_createCtx.lateComponentListCount * ComponentSetup::CreateCtx::GetLateListSize<ComponentSetup::ComponentListHeaderHot, ComponentSetup::ComponentListHeaderCold>(m_createCtx.lateSceneCapacity);
+        const std::size_t pageListsSize = m_createCtx.latePageListCount * ComponentSetup::CreateCtx::GetLateListSize<ComponentSetup::PageListHeaderHot, ComponentSetup::PageListHeaderCold>(m_createCtx.lateSceneCapacity);
+        return componentListsSize + pageListsSize;
+    }
+
+    void ComponentSystem::ClearSceneHeaders(SceneIndex sceneIndex) noexcept
+    {
+        const std::size_t sceneStartComponentIndex = m_createCtx.GetComponentListHeaderIndex(sceneIndex, 0);
+        const std::size_t sceneStartPageIndex = m_createCtx.GetPageListHeaderIndex(sceneIndex, 0);
+        std::memset(m_createCtx.componentListsHot + sceneStartComponentIndex, 0, sizeof(ComponentSetup::ComponentListHeaderHot) * m_createCtx.GetCurrentComponentListCount());
+        std::memset(m_createCtx.pageListsHot + sceneStartPageIndex, 0, sizeof(ComponentSetup::PageListHeaderHot) * m_createCtx.GetCurrentPageListCount());
+        std::memset(m_createCtx.componentListsCold + sceneStartComponentIndex, 0, sizeof(ComponentSetup::ComponentListHeaderCold) * m_createCtx.GetCurrentComponentListCount());
+        std::memset(m_createCtx.pageListsCold + sceneStartPageIndex, 0, sizeof(ComponentSetup::PageListHeaderCold) * m_createCtx.GetCurrentPageListCount());
+        for (wIndex listIndex = m_createCtx.GetCurrentComponentListCount(); listIndex < m_createCtx.GetComponentListCount(); ++listIndex)
+        {
+            std::memset(&m_createCtx.GetComponentListHot(sceneIndex, listIndex), 0, sizeof(ComponentSetup::ComponentListHeaderHot));
+            std::memset(&m_createCtx.GetComponentListCold(sceneIndex, listIndex), 0, sizeof(ComponentSetup::ComponentListHeaderCold));
+        }
+        for (wIndex listIndex = m_createCtx.GetCurrentPageListCount(); listIndex < m_createCtx.GetPageListCount(); ++listIndex)
+        {
+            std::memset(&m_createCtx.GetPageListHot(sceneIndex, listIndex), 0, sizeof(ComponentSetup::PageListHeaderHot));
+            std::memset(&m_createCtx.GetPageListCold(sceneIndex, listIndex), 0, sizeof(ComponentSetup::PageListHeaderCold));
+        }
+    }
+
+    SceneIndex ComponentSystem::ClaimSceneSlot()
+    {
+        if (!m_sceneFreeList.Empty())
+        {
+            return m_sceneFreeList.Remove();
+        }
+        if (m_sceneSlotCount == m_sceneSlotCapacity)
+        {
+            ReallocateScenes(CalculateNextCapacity(m_sceneSlotCapacity));
+        }
+        const SceneIndex sceneIndex = ++m_sceneSlotCount;
+        std::construct_at(m_sceneGenerations + sceneIndex - 1);
+        return sceneIndex;
+    }
+
+    SceneArena* ComponentSystem::AcquireSceneArena()
     {
-        DestroyKnownList<Component>(m_componentLists[sceneStartListIndex + ComponentListOffset]);
-        DestroyKnownList<std::string>(m_componentLists[sceneStartListIndex + ComponentNameListOffset]);
-        for (wIndex componentTypeIndex = ComponentTypeIndexStart; componentTypeIndex <= m_currentComponentTypeCount; ++componentTypeIndex)
+        if (!m_sceneArenasEnabled)
         {
-            DestroyComponentList(sceneStartListIndex, componentTypeIndex);
+            return nullptr;
         }
+        if (m_unusedSceneArenas.empty())
+        {
+            return new SceneArena(*m_memoryResource, m_sceneArenaBlockSize);
+        }
+        SceneArena* arena = m_unusedSceneArenas.back();
+        m_unusedSceneArenas.pop_back();
+        return arena;
     }
 
-    void ComponentSystem::DestroyComponentList(std::size_t sceneStartListIndex, ComponentTypeIndex componentTypeIndex)
+    void ComponentSystem::ReleaseSceneArena(SceneArena* arena) noexcept
     {
-        ComponentSetup::ListHeader& header = m_componentLists[sceneStartListIndex + GetComponentListOffset(componentTypeIndex)];
-        if (header.begin != m_componentSetup.m_emptySentinals[componentTypeIndex - 1])
+        if (arena)
         {
-            m_componentSetup.m_types[componentTypeIndex - 1].destroy(header);
+            // Everything in the arena was released by the caller, so rewinding it is enough
+            arena->Reset();
+            m_unusedSceneArenas.push_back(arena);
         }
-    }*/
+    }
+
+    void ComponentSystem::DeleteSceneContent(SceneIndex sceneIndex) noexcept
+    {
+        DeleteListContent(m_componentSetup, m_createCtx, sceneIndex, GetComponentAllocator(sceneIndex));
+        delete m_sceneData[sceneIndex - 1].archetypes;
+        delete m_sceneData[sceneIndex - 1].entities;
+    }
+
+    void ComponentSystem::DeleteListContent(const ComponentSetup& componentSetup, ComponentSetup::CreateCtx& createCtx, SceneIndex sceneIndex, const ComponentSetup::ComponentAllocator& allocator) noexcept
+    {
+        for (const ComponentSetup::ComponentType& type : componentSetup.m_types)
+        {
+            if (type.IsChunked())
+            {
+                continue;
+            }
+            if (type.pageSize)
+            {
+                type.pageDestroy(createCtx.GetPageListHot(sceneIndex, type.listIndex), createCtx.GetPageListCold(sceneIndex, type.listIndex), allocator);
+            }
+            else
+            {
+                type.componentDestroy(createCtx.GetComponentListHot(sceneIndex, type.listIndex), createCtx.GetComponentListCold(sceneIndex, type.listIndex), allocator);
+            }
+        }
+    }
+
+    std::unique_ptr<StagedScene> ComponentSystem::CreateStagedScene()
+    {
+        // The list counts are fixed when the scene block is first allocated
+        if (!m_scenes)
+        {
+            ReallocateScenes(CalculateNextCapacity(m_sceneSlotCapacity));
+        }
+        SceneArena* arena = AcquireSceneArena();
+        // The PagePool is not thread safe, staged pages come from the upstream resource and join the pool once freed where it has room
+        const ComponentSetup::ComponentAllocator allocator = { arena ? static_cast<MemoryResource*>(arena) : m_memoryResource, m_memoryResource, m_reallocationHistogram.get() };
+        ++m_stagedSceneCount;
+        return std::unique_ptr<StagedScene>(new StagedScene(m_componentSetup, m_app, *this, m_createCtx, allocator, arena));
+    }
+
+    SceneHandle ComponentSystem::CommitStagedScene(StagedScene& stagedScene)
+    {
+        W_ASSERT(stagedScene.m_componentSystem == this, "StagedScene was already committed or discarded, or belongs to another ComponentSystem");
+        const WriteScope writeScope(*this);
+        const SceneIndex sceneIndex = ClaimSceneSlot();
+
+        // Splice the prepared headers into the slot, the lists themselves do not move
+        const wIndex componentListCount = m_createCtx.GetComponentListCount();
+        const wIndex pageListCount = m_createCtx.GetPageListCount();
+        W_ASSERT(componentListCount == stagedScene.m_componentListsHot.size() && pageListCount == stagedScene.m_pageListsHot.size(), "Component types were added while the scene was staged");
+        for (wIndex listIndex = 0; listIndex < componentListCount; ++listIndex)
+        {
+            ComponentSetup::ComponentListHeaderHot& headerHot = m_createCtx.GetComponentListHot(sceneIndex, listIndex);
+            ComponentSetup::ComponentListHeaderCold& headerCold = m_createCtx.GetComponentListCold(sceneIndex, listIndex);
+            std::memcpy(&headerHot, &stagedScene.m_componentListsHot[listIndex], sizeof(ComponentSetup::ComponentListHeaderHot));
+            std::memcpy(&headerCold, &stagedScene.m_componentListsCold[listIndex], sizeof(ComponentSetup::ComponentListHeaderCold));
+            // Staged writes count as written now, for readers that compare against versions of this ComponentSystem
+            ComponentSetup::StampBlocks(headerHot, 0, headerCold.denseCount, m_createCtx.changeVersion);
+        }
+        for (wIndex listIndex = 0; listIndex < pageListCount; ++listIndex)
+        {
+            std::memcpy(&m_createCtx.GetPageListHot(sceneIndex, listIndex), &stagedScene.m_pageListsHot[listIndex], sizeof(ComponentSetup::PageListHeaderHot));
+            std::memcpy(&m_createCtx.GetPageListCold(sceneIndex, listIndex), &stagedScene.m_pageListsCold[listIndex], sizeof(ComponentSetup::PageListHeaderCold));
+        }
+
+        SceneData& sceneData = *std::construct_at(m_sceneData + sceneIndex - 1);
+        sceneData.arena = stagedScene.m_arena;
+
+        stagedScene.m_componentSystem = nullptr;
+        stagedScene.m_arena = nullptr;
+        --m_stagedSceneCount;
+        const SceneHandle sceneHandle(sceneIndex, m_sceneGenerations[sceneIndex - 1]);
+        if (m_componentEvents)
+        {
+            PublishCreatedScene(sceneHandle);
+        }
+        return sceneHandle;
+    }
+
+    void ComponentSystem::DiscardStagedScene(StagedScene& stagedScene) noexcept
+    {
+        W_ASSERT(stagedScene.m_componentSystem == this, "StagedScene was already committed or discarded, or belongs to another ComponentSystem");
+        DeleteListContent(m_componentSetup, stagedScene.m_createCtx, SceneIndexStart, stagedScene.m_allocator);
+        ReleaseSceneArena(stagedScene.m_arena);
+        stagedScene.m_componentSystem = nullptr;
+        stagedScene.m_arena = nullptr;
+        --m_stagedSceneCount;
+    }
+
+    StagedScene::StagedScene(const ComponentSetup& componentSetup, Application& app, ComponentSystem& componentSystem, const ComponentSetup::CreateCtx& layout, const ComponentSetup::ComponentAllocator& allocator, SceneArena* arena)
+        : m_componentSetup(&componentSetup), m_app(&app), m_componentSystem(&componentSystem), m_createCtx(layout),
+        m_componentListsHot(layout.GetComponentListCount()), m_pageListsHot(layout.GetPageListCount()),
+        m_componentListsCold(layout.GetComponentListCount()), m_pageListsCold(layout.GetPageListCount()),
+        m_allocator(allocator), m_arena(arena)
+    {
+        // One scene with every list in its stride, late lists included
+        m_createCtx.UpdateCurrentComponentListCount(layout.GetCurrentComponentTypeCount(), layout.GetComponentListCount(), layout.GetPageListCount());
+        m_createCtx.lateComponentLists = nullptr;
+        m_createCtx.latePageLists = nullptr;
+        m_createCtx.lateComponentListCount = 0;
+        m_createCtx.latePageListCount = 0;
+        m_createCtx.componentListsHot = m_componentListsHot.data();
+        m_createCtx.pageListsHot = m_pageListsHot.data();
+        m_createCtx.componentListsCold = m_componentListsCold.data();
+        m_createCtx.pageListsCold = m_pageListsCold.data();
+    }
+
+    StagedScene::~StagedScene() noexcept
+    {
+        if (m_componentSystem)
+        {
+            m_componentSystem->DiscardStagedScene(*this);
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/EntityTable.hpp"
+
+namespace wCore
+{
+    EntityTable::EntityTable() noexcept
+        : m_generations(), m_signatures(), m_links(), m_freeList(), m_signatureWordCount(1)
+    {
+    }
+
+    std::pair<EntityIndex, ComponentGeneration> EntityTable::Create()
+    {
+        EntityIndex entityIndex;
+        if (m_freeList.Empty())
+        {
+            m_generations.emplace_back();
+            m_signatures.resize(m_generations.size() * m_signatureWordCount);
+            entityIndex = m_generations.size();
+        }
+        else
+        {
+            entityIndex = m_freeList.Remove();
+        }
+        ComponentGeneration& generation = m_generations[entityIndex - 1];
+        ++generation.generation;
+        return { entityIndex, generation };
+    }
+
+    void EntityTable::Destroy(EntityIndex entityIndex) noexcept
+    {
+        ComponentGeneration& generation = m_generations[entityIndex - 1];
+        W_ASSERT(IsAlive(generation), "Entity: {} already destroyed", entityIndex);
+        const uint64_t* signature = m_signatures.data() + (entityIndex - 1) * m_signatureWordCount;
+        W_ASSERT(std::all_of(signature, signature + m_signatureWordCount, [](uint64_t word) { return !word; }), "Entity: {} still has linked components", entityIndex);
+        ++generation.generation;
+        m_freeList.Add(entityIndex);
+    }
+
+    void EntityTable::Link(EntityIndex entityIndex, ComponentTypeIndex componentTypeIndex, ComponentIndex componentIndex)
+    {
+        const wIndex bit = componentTypeIndex - 1;
+        if (bit >= m_signatureWordCount * SignatureWordBits)
+        {
+            WidenSignatures(bit / SignatureWordBits + 1);
+        }
+        if (componentTypeIndex > m_links.size())
+        {
+            m_links.resize(componentTypeIndex);
+        }
+
+        TypeLinks& links = m_links[componentTypeIndex - 1];
+        if (links.entityToSlot.size() < m_generations.size())
+        {
+            links.entityToSlot.resize(m_generations.size(), InvalidComponent);
+        }
+        if (links.slotToEntity.size() < componentIndex)
+        {
+            links.slotToEntity.resize(componentIndex, InvalidEntity);
+        }
+        links.entityToSlot[entityIndex - 1] = componentIndex;
+        links.slotToEntity[componentIndex - 1] = entityIndex;
+        m_signatures[(entityIndex - 1) * m_signatureWordCount + bit / SignatureWordBits] |= uint64_t(1) << (bit % SignatureWordBits);
+    }
+
+    void EntityTable::Unlink(EntityIndex entityIndex, ComponentTypeIndex componentTypeIndex) noexcept
+    {
+        const wIndex bit = componentTypeIndex - 1;
+        TypeLinks& links = m_links[componentTypeIndex - 1];
+        links.slotToEntity[links.entityToSlot[entityIndex - 1] - 1] = InvalidEntity;
+        links.entityToSlot[entityIndex - 1] = InvalidComponent;
+        m_signatures[(entityIndex - 1) * m_signatureWordCount + bit / SignatureWordBits] &= ~(uint64_t(1) << (bit % SignatureWordBits));
+    }
+
+    void EntityTable::UnlinkSlot(ComponentTypeIndex componentTypeIndex, ComponentIndex componentIndex) noexcept
+    {
+        const EntityIndex entityIndex = GetOwner(componentTypeIndex, componentIndex);
+        if (entityIndex != InvalidEntity)
+        {
+            Unlink(entityIndex, componentTypeIndex);
+        }
+    }
+
+    void EntityTable::WidenSignatures(wIndex signatureWordCount)
+    {
+        std::vector<uint64_t> signatures(m_generations.size() * signatureWordCount);
+        for (wIndex entitySlot = 0; entitySlot < m_generations.size(); ++entitySlot)
+        {
+            std::copy_n(m_signatures.data() + entitySlot * m_signatureWordCount, m_signatureWordCount, signatures.data() + entitySlot * signatureWordCount);
+        }
+        m_signatures = std::move(signatures);
+        m_signatureWordCount = signatureWordCount;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/EventBus.hpp"
+#include "TungstenCore/Profiler.hpp"
+
+namespace wCore
+{
+    EventBus::EventBus(const JobSystem& jobSystem)
+        : m_channels(), m_segmentCount(jobSystem.GetThreadCount())
+    {
+    }
+
+    EventBus::~EventBus() noexcept = default;
+
+    void EventBus::Swap() noexcept
+    {
+        W_PROFILE_ZONE("EventBus::Swap");
+        for (const std::unique_ptr<ChannelBase>& channel : m_channels)
+        {
+            channel->Swap();
+        }
+    }
+
+    void EventBus::Clear() noexcept
+    {
+        for (const std::unique_ptr<ChannelBase>& channel : m_channels)
+        {
+            channel->Clear();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/FrameLoop.hpp"
+#include "TungstenCore/Profiler.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace wCore
+{
+    static std::chrono::nanoseconds GetPeriod(double rate) noexcept
+    {
+        return rate > 0.0 ? std::chrono::nanoseconds(static_cast<int64_t>(1e9 / rate + 0.5)) : std::chrono::nanoseconds(0);
+    }
+
+    FrameLoop::FrameLoop(const Config& config) noexcept
+        : m_config(config), m_tickDuration(GetPeriod(config.tickRate)), m_frameDuration(config.headless ? std::chrono::nanoseconds(0) : GetPeriod(config.frameRate)),
+        m_accumulator(0), m_frameBegin(), m_nextFrame(), m_lastFrameTime(0), m_stats(), m_history()
+    {
+        W_ASSERT(m_tickDuration.count() > 0, "FrameLoop tick rate must be positive");
+        W_ASSERT(config.maxTicksPerFrame, "FrameLoop must run at least one tick per frame");
+    }
+
+    void FrameLoop::Start() noexcept
+    {
+        m_frameBegin = Clock::now();
+        m_nextFrame = m_frameBegin;
+        m_accumulator = m_tickDuration;
+        m_lastFrameTime = std::chrono::nanoseconds(0);
+    }
+
+    wIndex FrameLoop::BeginFrame() noexcept
+    {
+        const Clock::time_point now = Clock::now();
+        m_lastFrameTime = now - m_frameBegin;
+        m_accumulator += m_lastFrameTime;
+        m_frameBegin = now;
+
+        wIndex ticks = static_cast<wIndex>(m_accumulator / m_tickDuration);
+        if (ticks > m_config.maxTicksPerFrame)
+        {
+            m_stats.droppedTickCount += ticks - m_config.maxTicksPerFrame;
+            ticks = m_config.maxTicksPerFrame;
+            m_accumulator %= m_tickDuration;
+        }
+        else
+        {
+            m_accumulator -= ticks * m_tickDuration;
+        }
+        m_stats.tickCount += ticks;
+        m_stats.catchUpTickCount += ticks > 1 ? ticks - 1 : 0;
+        return ticks;
+    }
+
+    void FrameLoop::EndFrame(bool presented) noexcept
+    {
+        const Clock::time_point now = Clock::now();
+        const std::chrono::nanoseconds work = now - m_frameBegin;
+        m_history[m_stats.frameCount % HistorySize] = { work, m_lastFrameTime };
+        ++m_stats.frameCount;
+        if (work > GetFrameBudget())
+        {
+            ++m_stats.overrunCount;
+        }
+
+        W_PROFILE_ZONE("FrameLoop::Wait");
+        if (m_config.headless || (!presented && !m_frameDuration.count()))
+        {
+            // Nothing else paces the frames, wake up when the accumulator holds the next tick
+            WaitUntil(m_frameBegin + (m_tickDuration - m_accumulator), m_config.spinThreshold);
+        }
+        else if (m_frameDuration.count())
+        {
+            // Deadlines are absolute so waits do not drift, a frame that is late by a whole period starts over from now
+            m_nextFrame += m_frameDuration;
+            if (m_nextFrame + m_frameDuration < now)
+            {
+                m_nextFrame = now;
+            }
+            WaitUntil(m_nextFrame, m_config.spinThreshold);
+        }
+    }
+
+    std::chrono::nanoseconds FrameLoop::GetWorkTimePercentile(double percentile) const
+    {
+        return GetPercentile(&FrameSample::work, percentile);
+    }
+
+    std::chrono::nanoseconds FrameLoop::GetFrameTimePercentile(double percentile) const
+    {
+        return GetPercentile(&FrameSample::frame, percentile);
+    }
+
+    std::chrono::nanoseconds FrameLoop::GetPercentile(std::chrono::nanoseconds FrameSample::* member, double percentile) const
+    {
+        const wIndex count = static_cast<wIndex>(std::min<uint64_t>(m_stats.frameCount, HistorySize));
+        if (!count)
+        {
+            return std::chrono::nanoseconds(0);
+        }
+        std::vector<std::chrono::nanoseconds> samples(count);
+        for (wIndex i = 0; i < count; ++i)
+        {
+            samples[i] = m_history[i].*member;
+        }
+        const wIndex rank = static_cast<wIndex>(std::clamp(percentile, 0.0, 100.0) / 100.0 * (count - 1) + 0.5);
+        std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+        return samples[rank];
+    }
+
+    void FrameLoop::ResetStats() noexcept
+    {
+        m_stats = Stats();
+    }
+
+    void FrameLoop::WaitUntil(Clock::time_point deadline, std::chrono::nanoseconds spinThreshold) noexcept
+    {
+        const Clock::time_point now = Clock::now();
+        if (deadline - now > spinThreshold)
+        {
+            std::this_thread::sleep_until(deadline - spinThreshold);
+        }
+        while (Clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,318 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/JobSystem.hpp"
+#include "TungstenCore/Profiler.hpp"
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace wCore
+{
+    namespace
+    {
+        constexpr wIndex SpinCountBeforeSleep = 64;
+        constexpr wIndex JobRingSize = 2 * JobQueueCapacity;
+
+        thread_local const JobSystem* t_jobSystem = nullptr;
+        thread_local wIndex t_workerIndex = 0;
+    }
+
+    WorkStealingQueue::WorkStealingQueue() noexcept
+        : m_top(0), m_bottom(0)
+    {
+        for (std::atomic<Job*>& job : m_jobs)
+        {
+            job.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    bool WorkStealingQueue::Push(Job* job) noexcept
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= static_cast<int64_t>(JobQueueCapacity))
+        {
+            return false;
+        }
+        m_jobs[bottom & (JobQueueCapacity - 1)].store(job, std::memory_order_relaxed);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    Job* WorkStealingQueue::Pop() noexcept
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_seq_cst);
+        if (top > bottom)
+        {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = m_jobs[bottom & (JobQueueCapacity - 1)].load(std::memory_order_relaxed);
+        if (top == bottom)
+        {
+            // Last job, race the thieves for it.
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                job = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* WorkStealingQueue::Steal() noexcept
+    {
+        int64_t top = m_top.load(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+        if (top >= bottom)
+        {
+            return nullptr;
+        }
+
+        Job* job = m_jobs[top & (JobQueueCapacity - 1)].load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        return job;
+    }
+
+    JobSystem::JobSystem()
+        : JobSystem(Config())
+    {
+    }
+
+    JobSystem::JobSystem(const Config& config)
+        : m_workerData(std::make_unique<WorkerData[]>(config.workerCount + 1)), m_queueCount(config.workerCount + 1),
+        m_ownerThread(std::this_thread::get_id()),
+        m_externalMutex(), m_externalJobs(),
+        m_queuedJobs(0), m_sleepingWorkers(0), m_sleepMutex(), m_sleepCondition(), m_stopping(false), m_workers()
+    {
+        for (wIndex queueIndex = 0; queueIndex < m_queueCount; ++queueIndex)
+        {
+            m_workerData[queueIndex].jobs = std::make_unique<Job[]>(JobRingSize);
+            m_workerData[queueIndex].nextJob = 0;
+        }
+
+        if (config.pinWorkers)
+        {
+            PinCurrentThread(config.firstCore);
+        }
+
+        m_workers.reserve(config.workerCount);
+        for (wIndex workerIndex = 1; workerIndex <= config.workerCount; ++workerIndex)
+        {
+            m_workers.emplace_back([this, workerIndex, config]
+            {
+                if (config.pinWorkers)
+                {
+                    PinCurrentThread(config.firstCore + workerIndex);
+                }
+                WorkerLoop(workerIndex);
+            });
+        }
+    }
+
+    JobSystem::~JobSystem() noexcept
+    {
+        {
+            std::lock_guard lock(m_sleepMutex);
+            m_stopping.store(true, std::memory_order_release);
+        }
+        m_sleepCondition.notify_all();
+        for (std::thread& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    void JobSystem::Wait(const JobCounter& counter) noexcept
+    {
+        const wIndex queueIndex = GetCurrentQueueIndex();
+        while (!counter.IsDone())
+        {
+            if (!TryRunOne(queueIndex))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    wIndex JobSystem::GetCurrentWorkerIndex() noexcept
+    {
+        return t_workerIndex;
+    }
+
+    wIndex JobSystem::DefaultWorkerCount() noexcept
+    {
+        const wIndex hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    wIndex JobSystem::GetCurrentQueueIndex() const noexcept
+    {
+        if (t_jobSystem == this)
+        {
+            return t_workerIndex;
+        }
+        return std::this_thread::get_id() == m_ownerThread ? 0 : NoQueue;
+    }
+
+    Job* JobSystem::AllocateJob(wIndex queueIndex)
+    {
+        if (queueIndex != NoQueue)
+        {
+            // One pass over the ring, jobs waiting on nested jobs stay in use, so deep fork join can fill all of it
+            WorkerData& workerData = m_workerData[queueIndex];
+            for (wIndex probe = 0; probe < JobRingSize; ++probe)
+            {
+                Job* job = &workerData.jobs[workerData.nextJob++ & (JobRingSize - 1)];
+                if (!job->inUse.load(std::memory_order_acquire))
+                {
+                    job->inUse.store(true, std::memory_order_relaxed);
+                    job->heapAllocated = false;
+                    return job;
+                }
+            }
+        }
+        Job* job = new Job;
+        job->heapAllocated = true;
+        return job;
+    }
+
+    void JobSystem::Submit(wIndex queueIndex, Job* job)
+    {
+        job->counter->m_count.fetch_add(1, std::memory_order_relaxed);
+
+        if (queueIndex == NoQueue)
+        {
+            std::lock_guard lock(m_externalMutex);
+            m_externalJobs.push_back(job);
+        }
+        else if (!m_workerData[queueIndex].queue.Push(job))
+        {
+            // Queue is full, run it right away rather than fail.
+            Execute(*job);
+            return;
+        }
+
+        m_queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+        if (m_sleepingWorkers.load(std::memory_order_seq_cst))
+        {
+            std::lock_guard lock(m_sleepMutex);
+            m_sleepCondition.notify_one();
+        }
+    }
+
+    void JobSystem::WorkerLoop(wIndex workerIndex) noexcept
+    {
+        t_jobSystem = this;
+        t_workerIndex = workerIndex;
+        W_PROFILE_THREAD("Worker " + std::to_string(workerIndex));
+
+        wIndex idleSpins = 0;
+        while (!m_stopping.load(std::memory_order_acquire))
+        {
+            if (TryRunOne(workerIndex))
+            {
+                idleSpins = 0;
+                continue;
+            }
+
+            if (++idleSpins < SpinCountBeforeSleep)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock lock(m_sleepMutex);
+            m_sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+            m_sleepCondition.wait(lock, [this] { return m_queuedJobs.load(std::memory_order_seq_cst) || m_stopping.load(std::memory_order_acquire); });
+            m_sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+            idleSpins = 0;
+        }
+    }
+
+    bool JobSystem::TryRunOne(wIndex queueIndex) noexcept
+    {
+        if (Job* job = FindJob(queueIndex))
+        {
+            Execute(*job);
+            return true;
+        }
+        return false;
+    }
+
+    Job* JobSystem::FindJob(wIndex queueIndex) noexcept
+    {
+        Job* job = nullptr;
+        if (queueIndex != NoQueue)
+        {
+            job = m_workerData[queueIndex].queue.Pop();
+        }
+
+        const wIndex startIndex = queueIndex == NoQueue ? 0 : queueIndex + 1;
+        for (wIndex offset = 0; !job && offset < m_queueCount; ++offset)
+        {
+            const wIndex victimIndex = (startIndex + offset) % m_queueCount;
+            if (victimIndex != queueIndex)
+            {
+                job = m_workerData[victimIndex].queue.Steal();
+            }
+        }
+
+        if (!job)
+        {
+            std::lock_guard lock(m_externalMutex);
+            if (!m_externalJobs.empty())
+            {
+                job = m_externalJobs.front();
+                m_externalJobs.pop_front();
+            }
+        }
+
+        if (job)
+        {
+            m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    void JobSystem::Execute(Job& job) noexcept
+    {
+        {
+            W_PROFILE_ZONE("Job");
+            job.invoke(job);
+        }
+        JobCounter* counter = job.counter;
+        if (job.heapAllocated)
+        {
+            delete &job;
+        }
+        else
+        {
+            job.inUse.store(false, std::memory_order_release);
+        }
+        counter->m_count.fetch_sub(1, std::memory_order_release);
+    }
+
+    void JobSystem::PinCurrentThread(wIndex core) noexcept
+    {
+#if defined(__linux__)
+        const wIndex coreCount = std::max(std::thread::hardware_concurrency(), 1u);
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(core % coreCount, &cpuSet);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet))
+        {
+            W_DEBUG_LOG_INFO("Failed to pin thread to core {}", core % coreCount);
+        }
+#else
+        (void)core;
+#endif
+    }
+}
\ No newline at end of file
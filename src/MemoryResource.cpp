@@ -0,0 +1,334 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/MemoryResource.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace wCore
+{
+    namespace
+    {
+        struct ReaderSlotPool
+        {
+            std::mutex mutex;
+            std::vector<wIndex> freeSlots; // Reserved for every slot, so returning one never allocates
+            wIndex nextSlot = 0;
+        };
+
+        // Leaked on purpose, threads that exit after static destruction still return their slot
+        ReaderSlotPool& GetReaderSlotPool()
+        {
+            static ReaderSlotPool* s_pool = []
+            {
+                ReaderSlotPool* pool = new ReaderSlotPool();
+                pool->freeSlots.reserve(EpochMemoryResource::MaxReaderThreads);
+                return pool;
+            }();
+            return *s_pool;
+        }
+
+        struct ThreadReaderSlot
+        {
+            ThreadReaderSlot() noexcept
+            {
+                ReaderSlotPool& pool = GetReaderSlotPool();
+                const std::lock_guard lock(pool.mutex);
+                if (!pool.freeSlots.empty())
+                {
+                    slot = pool.freeSlots.back();
+                    pool.freeSlots.pop_back();
+                    return;
+                }
+                slot = pool.nextSlot++;
+                W_ASSERT(slot < EpochMemoryResource::MaxReaderThreads, "More than {} threads read through an EpochMemoryResource at the same time", EpochMemoryResource::MaxReaderThreads);
+                if (slot >= EpochMemoryResource::MaxReaderThreads)
+                {
+                    // Every reader array ends here, going on would write past it
+                    std::abort();
+                }
+            }
+
+            // The thread is done reading, so its epoch in every resource is 0 and the next owner starts clean
+            ~ThreadReaderSlot() noexcept
+            {
+                ReaderSlotPool& pool = GetReaderSlotPool();
+                const std::lock_guard lock(pool.mutex);
+                pool.freeSlots.push_back(slot);
+            }
+
+            ThreadReaderSlot(const ThreadReaderSlot&) = delete;
+            ThreadReaderSlot& operator=(const ThreadReaderSlot&) = delete;
+
+            wIndex slot;
+        };
+    }
+
+    void* HeapMemoryResource::Allocate(std::size_t size, std::size_t alignment)
+    {
+        return ::operator new(size, std::align_val_t(alignment));
+    }
+
+    void HeapMemoryResource::Deallocate(void* memory, std::size_t, std::size_t alignment) noexcept
+    {
+        ::operator delete(memory, std::align_val_t(alignment));
+    }
+
+    HeapMemoryResource& HeapMemoryResource::Get() noexcept
+    {
+        static HeapMemoryResource s_heap;
+        return s_heap;
+    }
+
+    SceneArena::SceneArena(MemoryResource& upstream, std::size_t blockSize) noexcept
+        : m_upstream(upstream), m_blockSize(blockSize), m_blocks(), m_currentBlock(0), m_currentOffset(0), m_usedBeforeCurrent(0)
+    {
+    }
+
+    SceneArena::~SceneArena() noexcept
+    {
+        Release();
+    }
+
+    void* SceneArena::Allocate(std::size_t size, std::size_t alignment)
+    {
+        W_ASSERT(alignment <= BlockAlignment, "SceneArena alignment {} exceeds block alignment {}", alignment, BlockAlignment);
+        while (m_currentBlock < m_blocks.size())
+        {
+            const Block& block = m_blocks[m_currentBlock];
+            const std::size_t offset = wUtils::AlignUp(m_currentOffset, alignment);
+            if (offset + size <= block.size)
+            {
+                m_currentOffset = offset + size;
+                return block.memory + offset;
+            }
+            // Blocks kept from before a Reset may be too small, skip them
+            m_usedBeforeCurrent += m_currentOffset;
+            m_currentOffset = 0;
+            ++m_currentBlock;
+        }
+
+        const std::size_t blockSize = std::max(m_blockSize, wUtils::AlignUp(size, BlockAlignment));
+        m_blocks.push_back({ static_cast<std::byte*>(m_upstream.Allocate(blockSize, BlockAlignment)), blockSize });
+        m_currentBlock = m_blocks.size() - 1;
+        m_currentOffset = size;
+        return m_blocks.back().memory;
+    }
+
+    void SceneArena::Reset() noexcept
+    {
+        m_currentBlock = 0;
+        m_currentOffset = 0;
+        m_usedBeforeCurrent = 0;
+    }
+
+    void SceneArena::Release() noexcept
+    {
+        for (const Block& block : m_blocks)
+        {
+            m_upstream.Deallocate(block.memory, block.size, BlockAlignment);
+        }
+        m_blocks.clear();
+        Reset();
+    }
+
+    std::size_t SceneArena::GetBytesReserved() const noexcept
+    {
+        std::size_t bytes = 0;
+        for (const Block& block : m_blocks)
+        {
+            bytes += block.size;
+        }
+        return bytes;
+    }
+
+    std::size_t SceneArena::GetBytesUsed() const noexcept
+    {
+        return m_usedBeforeCurrent + m_currentOffset;
+    }
+
+    PagePool::PagePool(MemoryResource& upstream) noexcept
+        : m_upstream(upstream), m_buckets()
+    {
+    }
+
+    PagePool::~PagePool() noexcept
+    {
+        Trim();
+    }
+
+    void* PagePool::Allocate(std::size_t size, std::size_t alignment)
+    {
+        Bucket& bucket = GetBucket(size, alignment);
+        if (bucket.pages.empty())
+        {
+            const std::size_t requiredCapacity = bucket.outstanding + 1;
+            if (bucket.pages.capacity() < requiredCapacity)
+            {
+                bucket.pages.reserve(std::max(requiredCapacity, bucket.pages.capacity() * 2));
+            }
+            void* page = m_upstream.Allocate(size, alignment);
+            ++bucket.outstanding;
+            return page;
+        }
+        void* page = bucket.pages.back();
+        bucket.pages.pop_back();
+        ++bucket.outstanding;
+        return page;
+    }
+
+    void PagePool::Deallocate(void* memory, std::size_t size, std::size_t alignment) noexcept
+    {
+        Bucket* bucket = FindBucket(size, alignment);
+        // Only pages that were not handed out here can find the bucket missing or full
+        if (!bucket || bucket->pages.size() == bucket->pages.capacity())
+        {
+            m_upstream.Deallocate(memory, size, alignment);
+            return;
+        }
+        bucket->pages.push_back(memory);
+        bucket->outstanding -= bucket->outstanding != 0;
+    }
+
+    void PagePool::Trim() noexcept
+    {
+        for (Bucket& bucket : m_buckets)
+        {
+            for (void* page : bucket.pages)
+            {
+                m_upstream.Deallocate(page, bucket.size, bucket.alignment);
+            }
+            bucket.pages.clear();
+        }
+    }
+
+    wIndex PagePool::GetCachedPageCount() const noexcept
+    {
+        wIndex count = 0;
+        for (const Bucket& bucket : m_buckets)
+        {
+            count += bucket.pages.size();
+        }
+        return count;
+    }
+
+    std::size_t PagePool::GetCachedBytes() const noexcept
+    {
+        std::size_t bytes = 0;
+        for (const Bucket& bucket : m_buckets)
+        {
+            bytes += bucket.pages.size() * bucket.size;
+        }
+        return bytes;
+    }
+
+    PagePool::Bucket& PagePool::GetBucket(std::size_t size, std::size_t alignment)
+    {
+        if (Bucket* bucket = FindBucket(size, alignment))
+        {
+            return *bucket;
+        }
+        return m_buckets.emplace_back(Bucket{ size, alignment, {}, 0 });
+    }
+
+    PagePool::Bucket* PagePool::FindBucket(std::size_t size, std::size_t alignment) noexcept
+    {
+        // Only a handful of distinct page sizes exist, one per paged type
+        for (Bucket& bucket : m_buckets)
+        {
+            if (bucket.size == size && bucket.alignment == alignment)
+            {
+                return &bucket;
+            }
+        }
+        return nullptr;
+    }
+
+    EpochMemoryResource::EpochMemoryResource(MemoryResource& upstream)
+        : m_upstream(upstream), m_epoch(1), m_readers(std::make_unique<ReaderSlot[]>(MaxReaderThreads)), m_retiredMutex(), m_retired()
+    {
+    }
+
+    EpochMemoryResource::~EpochMemoryResource() noexcept
+    {
+        for (const Retired& retired : m_retired)
+        {
+            m_upstream.Deallocate(retired.memory, retired.size, retired.alignment);
+        }
+    }
+
+    void* EpochMemoryResource::Allocate(std::size_t size, std::size_t alignment)
+    {
+        return m_upstream.Allocate(size, alignment);
+    }
+
+    void EpochMemoryResource::Deallocate(void* memory, std::size_t size, std::size_t alignment) noexcept
+    {
+        const std::lock_guard lock(m_retiredMutex);
+        m_retired.push_back({ memory, size, alignment, m_epoch.load(std::memory_order_relaxed) });
+    }
+
+    void EpochMemoryResource::EnterRead() noexcept
+    {
+        ReaderSlot& slot = m_readers[GetThreadSlot()];
+        if (slot.depth++)
+        {
+            return;
+        }
+        slot.epoch.store(m_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        // Pairs with the fence in Reclaim: either the writer sees this reader or this reader sees the new pointers
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    void EpochMemoryResource::ExitRead() noexcept
+    {
+        ReaderSlot& slot = m_readers[GetThreadSlot()];
+        W_ASSERT(slot.depth, "ExitRead without EnterRead");
+        if (!--slot.depth)
+        {
+            slot.epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    bool EpochMemoryResource::IsReading() const noexcept
+    {
+        return m_readers[GetThreadSlot()].depth;
+    }
+
+    void EpochMemoryResource::Reclaim() noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t oldestReader = m_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+        for (wIndex slotIndex = 0; slotIndex < MaxReaderThreads; ++slotIndex)
+        {
+            const uint64_t readerEpoch = m_readers[slotIndex].epoch.load(std::memory_order_seq_cst);
+            if (readerEpoch)
+            {
+                oldestReader = std::min(oldestReader, readerEpoch);
+            }
+        }
+
+        const std::lock_guard lock(m_retiredMutex);
+        std::erase_if(m_retired, [this, oldestReader](const Retired& retired)
+        {
+            if (retired.epoch < oldestReader)
+            {
+                m_upstream.Deallocate(retired.memory, retired.size, retired.alignment);
+                return true;
+            }
+            return false;
+        });
+    }
+
+    wIndex EpochMemoryResource::GetRetiredCount() const noexcept
+    {
+        const std::lock_guard lock(m_retiredMutex);
+        return m_retired.size();
+    }
+
+    wIndex EpochMemoryResource::GetThreadSlot() noexcept
+    {
+        thread_local const ThreadReaderSlot t_slot;
+        return t_slot.slot;
+    }
+}
\ No newline at end of file
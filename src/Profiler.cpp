@@ -0,0 +1,116 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/Profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <unordered_set>
+
+namespace wCore
+{
+    static void WriteEscaped(std::ofstream& file, std::string_view text)
+    {
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                file << '\\';
+            }
+            if (static_cast<unsigned char>(c) >= 0x20)
+            {
+                file << c;
+            }
+        }
+    }
+
+    // Leaked on purpose, threads that exit after static destruction may still record
+    std::mutex& Profiler::GetMutex() noexcept
+    {
+        static std::mutex* s_mutex = new std::mutex();
+        return *s_mutex;
+    }
+
+    std::vector<Profiler::ThreadBuffer*>& Profiler::GetThreadBuffers() noexcept
+    {
+        static std::vector<ThreadBuffer*>* s_buffers = new std::vector<ThreadBuffer*>();
+        return *s_buffers;
+    }
+
+    const char* Profiler::InternName(std::string_view name)
+    {
+        static std::unordered_set<std::string>* s_names = new std::unordered_set<std::string>();
+        const std::lock_guard lock(GetMutex());
+        return s_names->emplace(name).first->c_str();
+    }
+
+    void Profiler::SetThreadName(std::string_view name)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        const std::lock_guard lock(GetMutex());
+        buffer.name = name;
+    }
+
+    Profiler::ThreadBuffer* Profiler::RegisterThread()
+    {
+        ThreadBuffer* buffer = new ThreadBuffer{ std::make_unique<Event[]>(ThreadEventCapacity), 0, 0, {} };
+        const std::lock_guard lock(GetMutex());
+        std::vector<ThreadBuffer*>& buffers = GetThreadBuffers();
+        if (buffers.empty())
+        {
+            s_calibrationTicks = Now();
+            s_calibrationNanoseconds = GetSteadyNanoseconds();
+        }
+        buffer->threadId = buffers.size() + 1;
+        buffer->name = "Thread " + std::to_string(buffer->threadId);
+        buffers.push_back(buffer);
+        return buffer;
+    }
+
+    bool Profiler::WriteChromeTrace(const std::filesystem::path& path)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        const std::lock_guard lock(GetMutex());
+        const uint64_t ticks = Now();
+        const uint64_t nanoseconds = GetSteadyNanoseconds();
+        const double nanosecondsPerTick = ticks > s_calibrationTicks ? static_cast<double>(nanoseconds - s_calibrationNanoseconds) / static_cast<double>(ticks - s_calibrationTicks) : 1.0;
+        const auto toMicroseconds = [nanosecondsPerTick](uint64_t tick) { return static_cast<double>(static_cast<int64_t>(tick - s_calibrationTicks)) * nanosecondsPerTick / 1000.0; };
+
+        // Chrome traces count in microseconds, three decimals keep nanosecond resolution
+        file << std::fixed << std::setprecision(3);
+        file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        for (const ThreadBuffer* threadBuffer : GetThreadBuffers())
+        {
+            const ThreadBuffer& buffer = *threadBuffer;
+            file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.threadId << ",\"args\":{\"name\":\"";
+            WriteEscaped(file, buffer.name);
+            file << "\"}}";
+            first = false;
+
+            const uint64_t written = buffer.written.load(std::memory_order_acquire);
+            for (uint64_t eventIndex = written - std::min<uint64_t>(written, ThreadEventCapacity); eventIndex < written; ++eventIndex)
+            {
+                const Event& event = buffer.events[eventIndex % ThreadEventCapacity];
+                file << ",\n{\"name\":\"";
+                WriteEscaped(file, event.name);
+                file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.threadId << ",\"ts\":" << toMicroseconds(event.begin) << ",\"dur\":" << static_cast<double>(event.end - event.begin) * nanosecondsPerTick / 1000.0 << '}';
+            }
+        }
+        file << "\n]}\n";
+        return static_cast<bool>(file);
+    }
+
+    void Profiler::Clear() noexcept
+    {
+        const std::lock_guard lock(GetMutex());
+        for (ThreadBuffer* buffer : GetThreadBuffers())
+        {
+            buffer->written.store(0, std::memory_order_relaxed);
+        }
+    }
+}
\ No newline at end of file
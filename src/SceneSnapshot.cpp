@@ -0,0 +1,480 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/SceneSnapshot.hpp"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define TUNGSTEN_CORE_SNAPSHOT_MMAP 1
+#endif
+
+namespace wCore
+{
+    namespace
+    {
+        constexpr uint32_t SnapshotMagic = 0x504E5357; // "WSNP"
+        constexpr uint32_t ByteOrderMark = 0x01020304;
+
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t byteOrderMark;
+            uint32_t indexSize;
+            uint32_t generationSize;
+            uint32_t listCount;
+            uint64_t fileSize;
+        };
+
+        // pageSize is 0 for dense lists. Offsets are from the start of the file.
+        struct ListRecord
+        {
+            uint64_t nameOffset;
+            uint64_t nameLength;
+            uint64_t size;
+            uint64_t alignment;
+            uint64_t pageSize;
+            uint64_t slotCount;
+            uint64_t denseCount;
+            uint64_t freeCount;
+            uint64_t dataOffset;
+            uint64_t dataSize;
+            uint64_t generationsOffset; // Paged lists only
+        };
+
+        class MappedFile
+        {
+        public:
+            explicit MappedFile(const std::filesystem::path& path) noexcept
+            {
+#if defined(TUNGSTEN_CORE_SNAPSHOT_MMAP)
+                const int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                {
+                    return;
+                }
+                struct stat info;
+                if (::fstat(fd, &info) == 0)
+                {
+                    m_size = static_cast<std::size_t>(info.st_size);
+                    m_open = true;
+                    if (m_size)
+                    {
+                        void* mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                        if (mapping == MAP_FAILED)
+                        {
+                            m_open = false;
+                            m_size = 0;
+                        }
+                        else
+                        {
+                            m_data = static_cast<const std::byte*>(mapping);
+                        }
+                    }
+                }
+                ::close(fd);
+#else
+                std::ifstream file(path, std::ios::binary | std::ios::ate);
+                if (!file)
+                {
+                    return;
+                }
+                m_buffer.resize(static_cast<std::size_t>(file.tellg()));
+                file.seekg(0);
+                m_open = static_cast<bool>(file.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size()));
+                m_data = m_buffer.data();
+                m_size = m_buffer.size();
+#endif
+            }
+
+            ~MappedFile() noexcept
+            {
+#if defined(TUNGSTEN_CORE_SNAPSHOT_MMAP)
+                if (m_data)
+                {
+                    ::munmap(const_cast<std::byte*>(m_data), m_size);
+                }
+#endif
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            [[nodiscard]] inline bool IsOpen() const noexcept { return m_open; }
+            [[nodiscard]] inline std::span<const std::byte> GetData() const noexcept { return { m_data, m_size }; }
+
+        private:
+            const std::byte* m_data = nullptr;
+            std::size_t m_size = 0;
+            bool m_open = false;
+#if !defined(TUNGSTEN_CORE_SNAPSHOT_MMAP)
+            std::vector<std::byte> m_buffer;
+#endif
+        };
+
+        // The data is not required to be aligned, so every read goes through memcpy.
+        template<typename T>
+        [[nodiscard]] inline T Read(const std::byte* data, std::size_t offset) noexcept
+        {
+            T value;
+            std::memcpy(&value, data + offset, sizeof(T));
+            return value;
+        }
+
+        [[nodiscard]] inline bool InRange(std::span<const std::byte> data, uint64_t offset, uint64_t size) noexcept
+        {
+            return offset <= data.size() && size <= data.size() - offset;
+        }
+
+        void WritePadding(std::ofstream& file, std::size_t& position, std::size_t target)
+        {
+            static constexpr std::byte s_zeros[SceneSnapshot::SectionAlignment] = {};
+            while (position < target)
+            {
+                const std::size_t count = std::min(target - position, sizeof(s_zeros));
+                file.write(reinterpret_cast<const char*>(s_zeros), count);
+                position += count;
+            }
+        }
+
+        void WriteBytes(std::ofstream& file, std::size_t& position, const void* data, std::size_t size)
+        {
+            if (size)
+            {
+                file.write(static_cast<const char*>(data), size);
+                position += size;
+            }
+        }
+    }
+
+    SnapshotResult SceneSnapshot::Save(const ComponentSystem& componentSystem, SceneHandle sceneHandle, const std::filesystem::path& path)
+    {
+        W_ASSERT(componentSystem.SceneExists(sceneHandle), "Scene: {} does not exist", sceneHandle.sceneIndex);
+        const ComponentSetup& componentSetup = componentSystem.m_componentSetup;
+        const ComponentSetup::CreateCtx& createCtx = componentSystem.m_createCtx;
+        const SceneIndex sceneIndex = sceneHandle.sceneIndex;
+
+        std::vector<ListRecord> records;
+        std::vector<ComponentTypeIndex> recordTypes;
+        for (ComponentTypeIndex componentTypeIndex = ComponentTypeIndexStart; componentTypeIndex <= componentSetup.GetComponentTypeCount(); ++componentTypeIndex)
+        {
+            const ComponentSetup::ComponentType& type = componentSetup.m_types[componentTypeIndex - 1];
+            ListRecord record = {};
+            if (type.IsChunked())
+            {
+                if (componentSystem.GetComponentCount(componentTypeIndex, sceneIndex))
+                {
+                    W_DEBUG_LOG_INFO("Scene: {} can not be saved, Component: {} uses ChunkedStorage", sceneIndex, componentSetup.GetComponentTypeNameFromTypeIndex(componentTypeIndex));
+                    return SnapshotResult::UnsupportedType;
+                }
+                continue;
+            }
+            if (type.pageSize)
+            {
+                const ComponentSetup::PageListHeaderCold& headerCold = createCtx.GetPageListCold(sceneIndex, type.listIndex);
+                record.slotCount = headerCold.slotCount;
+                record.freeCount = headerCold.freeList.Count();
+                record.dataSize = headerCold.slotCount * type.size;
+            }
+            else
+            {
+                const ComponentSetup::ComponentListHeaderCold& headerCold = createCtx.GetComponentListCold(sceneIndex, type.listIndex);
+                record.slotCount = headerCold.slotCount;
+                record.denseCount = headerCold.denseCount;
+                record.freeCount = headerCold.freeList.Count();
+                record.dataSize = ComponentSetup::GetComponentBlockLayout(type.size, headerCold.slotCount).size;
+            }
+            if (!record.slotCount)
+            {
+                continue;
+            }
+            if (!type.triviallyCopyable)
+            {
+                W_DEBUG_LOG_INFO("Scene: {} can not be saved, Component: {} is not trivially copyable", sceneIndex, componentSetup.GetComponentTypeNameFromTypeIndex(componentTypeIndex));
+                return SnapshotResult::UnsupportedType;
+            }
+            record.nameLength = componentSetup.GetComponentTypeNameFromTypeIndex(componentTypeIndex).size();
+            record.size = type.size;
+            record.alignment = type.alignment;
+            record.pageSize = type.pageSize;
+            records.push_back(record);
+            recordTypes.push_back(componentTypeIndex);
+        }
+
+        // Lay out the file: header, records, names, then every section on its own alignment boundary
+        std::size_t offset = sizeof(FileHeader) + records.size() * sizeof(ListRecord);
+        for (ListRecord& record : records)
+        {
+            record.nameOffset = offset;
+            offset += record.nameLength;
+        }
+        for (ListRecord& record : records)
+        {
+            offset = wUtils::AlignUp(offset, SectionAlignment);
+            record.dataOffset = offset;
+            offset += record.dataSize;
+            if (record.pageSize)
+            {
+                offset = wUtils::AlignUp(offset, SectionAlignment);
+                record.generationsOffset = offset;
+                offset += record.slotCount * sizeof(ComponentGeneration);
+            }
+        }
+
+        FileHeader header = {};
+        header.magic = SnapshotMagic;
+        header.version = Version;
+        header.byteOrderMark = ByteOrderMark;
+        header.indexSize = sizeof(ComponentIndex);
+        header.generationSize = sizeof(ComponentGeneration);
+        header.listCount = static_cast<uint32_t>(records.size());
+        header.fileSize = offset;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return SnapshotResult::FileError;
+        }
+
+        std::size_t position = 0;
+        WriteBytes(file, position, &header, sizeof(header));
+        WriteBytes(file, position, records.data(), records.size() * sizeof(ListRecord));
+        for (ComponentTypeIndex componentTypeIndex : recordTypes)
+        {
+            const std::string_view name = componentSetup.GetComponentTypeNameFromTypeIndex(componentTypeIndex);
+            WriteBytes(file, position, name.data(), name.size());
+        }
+
+        for (wIndex recordIndex = 0; recordIndex < records.size(); ++recordIndex)
+        {
+            const ListRecord& record = records[recordIndex];
+            const ComponentSetup::ComponentType& type = componentSetup.m_types[recordTypes[recordIndex] - 1];
+            WritePadding(file, position, record.dataOffset);
+            if (type.pageSize)
+            {
+                const ComponentSetup::PageListHeaderHot& headerHot = createCtx.GetPageListHot(sceneIndex, type.listIndex);
+                const std::byte* const* pages = static_cast<const std::byte* const*>(headerHot.data);
+                for (wIndex slotIndex = 0, pageIndex = 0; slotIndex < record.slotCount; slotIndex += type.pageSize, ++pageIndex)
+                {
+                    const std::size_t pageBytes = std::min<std::size_t>(record.slotCount - slotIndex, type.pageSize) * type.size;
+                    if (pages[pageIndex])
+                    {
+                        WriteBytes(file, position, pages[pageIndex], pageBytes);
+                    }
+                    else
+                    {
+                        // Released by ComponentSystem::Compact, none of its slots is live
+                        WritePadding(file, position, position + pageBytes);
+                    }
+                }
+                WritePadding(file, position, record.generationsOffset);
+                WriteBytes(file, position, headerHot.generations, record.slotCount * sizeof(ComponentGeneration));
+            }
+            else
+            {
+                // Written in the block layout of a list whose capacity is its slot count, so loading is one memcpy
+                const ComponentSetup::ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(sceneIndex, type.listIndex);
+                const ComponentSetup::ComponentBlockLayout layout = ComponentSetup::GetComponentBlockLayout(type.size, record.slotCount);
+                WriteBytes(file, position, headerHot.dense, record.denseCount * type.size);
+                WritePadding(file, position, record.dataOffset + layout.slotToDenseOffset);
+                WriteBytes(file, position, headerHot.slotToDense, record.slotCount * sizeof(ComponentIndex));
+                WritePadding(file, position, record.dataOffset + layout.denseToSlotOffset);
+                WriteBytes(file, position, headerHot.denseToSlot, record.denseCount * sizeof(ComponentIndex));
+                WritePadding(file, position, record.dataOffset + layout.generationsOffset);
+                WriteBytes(file, position, headerHot.generations, record.slotCount * sizeof(ComponentGeneration));
+                WritePadding(file, position, record.dataOffset + layout.size);
+            }
+        }
+
+        file.flush();
+        return file ? SnapshotResult::Success : SnapshotResult::FileError;
+    }
+
+    std::pair<SnapshotResult, SceneHandle> SceneSnapshot::Load(ComponentSystem& componentSystem, const std::filesystem::path& path, std::string_view sceneName)
+    {
+        const MappedFile file(path);
+        if (!file.IsOpen())
+        {
+            return { SnapshotResult::FileError, SceneHandle() };
+        }
+        return Load(componentSystem, file.GetData(), sceneName);
+    }
+
+    std::pair<SnapshotResult, SceneHandle> SceneSnapshot::Load(ComponentSystem& componentSystem, std::span<const std::byte> data, std::string_view sceneName)
+    {
+        // Everything is checked up front, so a scene is only created for a snapshot that loads completely
+        if (const SnapshotResult result = Validate(componentSystem, data); result != SnapshotResult::Success)
+        {
+            return { result, SceneHandle() };
+        }
+
+        const ComponentSystem::WriteScope writeScope(componentSystem);
+        ComponentSetup& componentSetup = componentSystem.m_componentSetup;
+        ComponentSetup::CreateCtx& createCtx = componentSystem.m_createCtx;
+        const SceneHandle sceneHandle = componentSystem.CreateScene(sceneName);
+        const SceneIndex sceneIndex = sceneHandle.sceneIndex;
+        const ComponentSetup::ComponentAllocator allocator = componentSystem.GetComponentAllocator(sceneIndex);
+
+        const FileHeader header = Read<FileHeader>(data.data(), 0);
+        for (wIndex recordIndex = 0; recordIndex < header.listCount; ++recordIndex)
+        {
+            const ListRecord record = Read<ListRecord>(data.data(), sizeof(FileHeader) + recordIndex * sizeof(ListRecord));
+            const std::string_view name(reinterpret_cast<const char*>(data.data() + record.nameOffset), record.nameLength);
+            const auto nameIt = std::find(componentSetup.m_names.begin(), componentSetup.m_names.end(), name);
+            const ComponentSetup::ComponentType& type = componentSetup.m_types[nameIt - componentSetup.m_names.begin()];
+            const std::byte* const source = data.data() + record.dataOffset;
+
+            if (type.pageSize)
+            {
+                ComponentSetup::PageListHeaderHot& headerHot = createCtx.GetPageListHot(sceneIndex, type.listIndex);
+                ComponentSetup::PageListHeaderCold& headerCold = createCtx.GetPageListCold(sceneIndex, type.listIndex);
+                type.reallocatePages(headerHot, headerCold, wUtils::IntDivCeil(static_cast<wIndex>(record.slotCount), type.pageSize), allocator);
+
+                std::byte* const* pages = static_cast<std::byte* const*>(headerHot.data);
+                for (wIndex slotIndex = 0, pageIndex = 0; slotIndex < record.slotCount; slotIndex += type.pageSize, ++pageIndex)
+                {
+                    std::memcpy(pages[pageIndex], source + slotIndex * type.size, std::min<std::size_t>(record.slotCount - slotIndex, type.pageSize) * type.size);
+                }
+                std::memcpy(static_cast<void*>(headerHot.generations), data.data() + record.generationsOffset, record.slotCount * sizeof(ComponentGeneration));
+                headerCold.slotCount = record.slotCount;
+
+                headerCold.freeList.Reserve(record.freeCount);
+                for (ComponentIndex componentIndex = ComponentIndexStart; componentIndex <= headerCold.slotCount; ++componentIndex)
+                {
+                    if (!ComponentSetup::IsPageSlotAlive(headerHot.generations[componentIndex - 1]))
+                    {
+                        headerCold.freeList.Add(componentIndex);
+                    }
+                }
+            }
+            else
+            {
+                ComponentSetup::ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(sceneIndex, type.listIndex);
+                ComponentSetup::ComponentListHeaderCold& headerCold = createCtx.GetComponentListCold(sceneIndex, type.listIndex);
+                type.reallocateComponents(headerHot, headerCold, record.slotCount, allocator);
+
+                std::memcpy(headerHot.dense, source, record.dataSize);
+                headerCold.slotCount = record.slotCount;
+                headerCold.denseCount = record.denseCount;
+                ComponentSetup::StampBlocks(headerHot, 0, headerCold.denseCount, createCtx.changeVersion);
+
+                headerCold.freeList.Reserve(record.freeCount);
+                for (ComponentIndex componentIndex = ComponentIndexStart; componentIndex <= headerCold.slotCount; ++componentIndex)
+                {
+                    if (!headerHot.slotToDense[componentIndex - 1])
+                    {
+                        headerCold.freeList.Add(componentIndex);
+                    }
+                }
+            }
+        }
+
+        if (componentSystem.m_componentEvents)
+        {
+            componentSystem.PublishCreatedScene(sceneHandle);
+        }
+        return { SnapshotResult::Success, sceneHandle };
+    }
+
+    SnapshotResult SceneSnapshot::Validate(const ComponentSystem& componentSystem, std::span<const std::byte> data)
+    {
+        if (data.size() < sizeof(FileHeader))
+        {
+            return SnapshotResult::InvalidFormat;
+        }
+        const FileHeader header = Read<FileHeader>(data.data(), 0);
+        if (header.magic != SnapshotMagic || header.byteOrderMark != ByteOrderMark)
+        {
+            return SnapshotResult::InvalidFormat;
+        }
+        if (header.version != Version)
+        {
+            return SnapshotResult::VersionMismatch;
+        }
+        if (header.indexSize != sizeof(ComponentIndex) || header.generationSize != sizeof(ComponentGeneration) || header.fileSize != data.size()
+            || !InRange(data, sizeof(FileHeader), uint64_t(header.listCount) * sizeof(ListRecord)))
+        {
+            return SnapshotResult::InvalidFormat;
+        }
+
+        const ComponentSetup& componentSetup = componentSystem.m_componentSetup;
+        std::vector<bool> seenTypes(componentSetup.GetComponentTypeCount());
+        for (wIndex recordIndex = 0; recordIndex < header.listCount; ++recordIndex)
+        {
+            const ListRecord record = Read<ListRecord>(data.data(), sizeof(FileHeader) + recordIndex * sizeof(ListRecord));
+            if (!InRange(data, record.nameOffset, record.nameLength))
+            {
+                return SnapshotResult::InvalidFormat;
+            }
+
+            const std::string_view name(reinterpret_cast<const char*>(data.data() + record.nameOffset), record.nameLength);
+            const auto nameIt = std::find(componentSetup.m_names.begin(), componentSetup.m_names.end(), name);
+            if (nameIt == componentSetup.m_names.end())
+            {
+                W_DEBUG_LOG_INFO("Snapshot contains Component: {} which is not added to ComponentSetup", name);
+                return SnapshotResult::TypeMismatch;
+            }
+            const wIndex typeOffset = nameIt - componentSetup.m_names.begin();
+            const ComponentSetup::ComponentType& type = componentSetup.m_types[typeOffset];
+            if (type.IsChunked() || type.size != record.size || type.alignment != record.alignment || type.pageSize != record.pageSize)
+            {
+                W_DEBUG_LOG_INFO("Snapshot Component: {} has size {} alignment {} page size {}, ComponentSetup has size {} alignment {} page size {}", name, record.size, record.alignment, record.pageSize, type.size, type.alignment, type.pageSize);
+                return SnapshotResult::TypeMismatch;
+            }
+            if (!type.triviallyCopyable)
+            {
+                return SnapshotResult::UnsupportedType;
+            }
+            if (seenTypes[typeOffset] || !record.slotCount || record.slotCount > data.size() || record.dataOffset % SectionAlignment)
+            {
+                return SnapshotResult::InvalidFormat;
+            }
+            seenTypes[typeOffset] = true;
+
+            // Sizes are recomputed from the counts so a valid header can not describe sections that overlap the file end
+            const std::byte* const source = data.data() + record.dataOffset;
+            wIndex freeCount = 0;
+            if (type.pageSize)
+            {
+                if (record.denseCount || record.dataSize != record.slotCount * type.size || record.generationsOffset % SectionAlignment
+                    || !InRange(data, record.dataOffset, record.dataSize) || !InRange(data, record.generationsOffset, record.slotCount * sizeof(ComponentGeneration)))
+                {
+                    return SnapshotResult::InvalidFormat;
+                }
+                for (wIndex slotIndex = 0; slotIndex < record.slotCount; ++slotIndex)
+                {
+                    freeCount += !ComponentSetup::IsPageSlotAlive(Read<ComponentGeneration>(data.data(), record.generationsOffset + slotIndex * sizeof(ComponentGeneration)));
+                }
+            }
+            else
+            {
+                const ComponentSetup::ComponentBlockLayout layout = ComponentSetup::GetComponentBlockLayout(type.size, record.slotCount);
+                if (record.denseCount > record.slotCount || record.dataSize != layout.size || !InRange(data, record.dataOffset, record.dataSize))
+                {
+                    return SnapshotResult::InvalidFormat;
+                }
+                // Every live slot must point at a dense position that points back at it
+                for (wIndex slotIndex = 0; slotIndex < record.slotCount; ++slotIndex)
+                {
+                    const ComponentIndex densePosition = Read<ComponentIndex>(source, layout.slotToDenseOffset + slotIndex * sizeof(ComponentIndex));
+                    if (!densePosition)
+                    {
+                        ++freeCount;
+                    }
+                    else if (densePosition > record.denseCount || Read<ComponentIndex>(source, layout.denseToSlotOffset + (densePosition - 1) * sizeof(ComponentIndex)) != slotIndex + 1)
+                    {
+                        return SnapshotResult::InvalidFormat;
+                    }
+                }
+            }
+            if (freeCount != record.freeCount || (!type.pageSize && record.slotCount - freeCount != record.denseCount))
+            {
+                return SnapshotResult::InvalidFormat;
+            }
+        }
+        return SnapshotResult::Success;
+    }
+}
\ No newline at end of file
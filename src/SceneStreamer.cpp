@@ -0,0 +1,92 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/SceneStreamer.hpp"
+
+namespace wCore
+{
+    SceneStreamer::SceneStreamer(ComponentSystem& componentSystem, JobSystem& jobSystem, const Config& config) noexcept
+        : m_componentSystem(componentSystem), m_jobSystem(jobSystem), m_config(config), m_streams()
+    {
+    }
+
+    SceneStreamer::~SceneStreamer() noexcept
+    {
+        for (const std::shared_ptr<SceneStream>& stream : m_streams)
+        {
+            stream->Cancel();
+            m_jobSystem.Wait(stream->m_counter);
+            Finish(*stream);
+        }
+    }
+
+    std::shared_ptr<SceneStream> SceneStreamer::Stream(SceneBuildFn build)
+    {
+        std::shared_ptr<SceneStream> stream(new SceneStream(m_componentSystem.CreateStagedScene(), std::move(build)));
+        m_streams.push_back(stream);
+        m_jobSystem.Spawn(stream->m_counter, [stream = stream.get()] { Build(*stream); });
+        return stream;
+    }
+
+    void SceneStreamer::Update(std::chrono::microseconds budget)
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (!m_jobSystem.GetWorkerCount())
+        {
+            for (const std::shared_ptr<SceneStream>& stream : m_streams)
+            {
+                if (!stream->m_counter.IsDone())
+                {
+                    m_jobSystem.Wait(stream->m_counter);
+                    break;
+                }
+            }
+        }
+
+        wIndex finishedCount = 0;
+        for (const std::shared_ptr<SceneStream>& stream : m_streams)
+        {
+            // Later builds wait so scenes commit in request order
+            if (!stream->m_counter.IsDone())
+            {
+                break;
+            }
+            if (finishedCount && std::chrono::steady_clock::now() - start >= budget)
+            {
+                break;
+            }
+            Finish(*stream);
+            ++finishedCount;
+        }
+
+        if (finishedCount)
+        {
+            std::erase_if(m_streams, [](const std::shared_ptr<SceneStream>& stream) { return stream->IsDone(); });
+        }
+    }
+
+    void SceneStreamer::Build(SceneStream& stream)
+    {
+        if (!stream.IsCancelRequested())
+        {
+            stream.m_state.store(SceneStream::State::Building, std::memory_order_release);
+            stream.m_build(*stream.m_stagedScene, stream);
+        }
+        // Captures of the build function are released on the worker
+        stream.m_build = nullptr;
+        stream.m_state.store(SceneStream::State::Ready, std::memory_order_release);
+    }
+
+    void SceneStreamer::Finish(SceneStream& stream)
+    {
+        if (stream.IsCancelRequested())
+        {
+            m_componentSystem.DiscardStagedScene(*stream.m_stagedScene);
+            stream.m_stagedScene.reset();
+            stream.m_state.store(SceneStream::State::Cancelled, std::memory_order_release);
+            return;
+        }
+        stream.m_scene = m_componentSystem.CommitStagedScene(*stream.m_stagedScene);
+        stream.m_stagedScene.reset();
+        stream.m_progress.store(1.0f, std::memory_order_relaxed);
+        stream.m_state.store(SceneStream::State::Committed, std::memory_order_release);
+    }
+}
\ No newline at end of file
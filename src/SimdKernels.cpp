@@ -0,0 +1,413 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/SimdKernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+#if defined(TUNGSTEN_CORE_SIMD_X86)
+    #include <immintrin.h>
+    #define W_SIMD_TARGET(features) __attribute__((target(features)))
+#endif
+
+namespace wCore
+{
+    namespace
+    {
+        std::atomic<SimdLevel> s_maxLevel = SimdLevel::AVX512;
+
+        [[nodiscard]] SimdLevel DetectLevel() noexcept
+        {
+#if defined(TUNGSTEN_CORE_SIMD_X86)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+            {
+                return SimdLevel::AVX512;
+            }
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            {
+                return SimdLevel::AVX2;
+            }
+            if (__builtin_cpu_supports("sse4.1"))
+            {
+                return SimdLevel::SSE41;
+            }
+#endif
+            return SimdLevel::Scalar;
+        }
+
+        // The scalar kernels work on [begin, end), the vector kernels finish their tails with them.
+        inline void MultiplyAddRange(float* values, const float* deltas, float scale, wIndex begin, wIndex end) noexcept
+        {
+            for (wIndex i = begin; i < end; ++i)
+            {
+                values[i] += deltas[i] * scale;
+            }
+        }
+
+        inline void UpdateAabbsRange(const float* centers, const float* halfExtents, float* mins, float* maxs, wIndex begin, wIndex end) noexcept
+        {
+            for (wIndex i = begin; i < end; ++i)
+            {
+                mins[i] = centers[i] - halfExtents[i];
+                maxs[i] = centers[i] + halfExtents[i];
+            }
+        }
+
+        // Comparisons are written so NaN culls, like the ordered vector compares.
+        inline wIndex CullSpheresRange(const float* x, const float* y, const float* z, const float* radii, std::size_t stride, wIndex begin, wIndex end, const Frustum& frustum, wIndex* outIndices, wIndex outCount) noexcept
+        {
+            for (wIndex i = begin; i < end; ++i)
+            {
+                const std::size_t offset = i * stride;
+                bool inside = true;
+                for (const std::array<float, 4>& plane : frustum.planes)
+                {
+                    inside &= plane[0] * x[offset] + plane[1] * y[offset] + plane[2] * z[offset] + plane[3] >= -radii[offset];
+                }
+                if (inside)
+                {
+                    outIndices[outCount++] = i;
+                }
+            }
+            return outCount;
+        }
+
+        inline wIndex CullDistanceRange(const float* x, const float* y, const float* z, std::size_t stride, wIndex begin, wIndex end, const std::array<float, 3>& center, float maxDistance, wIndex* outIndices, wIndex outCount) noexcept
+        {
+            const float maxDistanceSquared = maxDistance * maxDistance;
+            for (wIndex i = begin; i < end; ++i)
+            {
+                const std::size_t offset = i * stride;
+                const float dx = x[offset] - center[0];
+                const float dy = y[offset] - center[1];
+                const float dz = z[offset] - center[2];
+                if (dx * dx + dy * dy + dz * dz <= maxDistanceSquared)
+                {
+                    outIndices[outCount++] = i;
+                }
+            }
+            return outCount;
+        }
+
+        // Appends base + the index of every set bit of mask.
+        inline wIndex WriteIndices(uint32_t mask, wIndex base, wIndex* outIndices, wIndex outCount) noexcept
+        {
+            for (; mask; mask &= mask - 1)
+            {
+                outIndices[outCount++] = base + std::countr_zero(mask);
+            }
+            return outCount;
+        }
+
+        void MultiplyAddScalar(float* values, const float* deltas, float scale, wIndex count) noexcept { MultiplyAddRange(values, deltas, scale, 0, count); }
+        void UpdateAabbsScalar(const float* centers, const float* halfExtents, float* mins, float* maxs, wIndex count) noexcept { UpdateAabbsRange(centers, halfExtents, mins, maxs, 0, count); }
+        wIndex CullSpheresScalar(const float* x, const float* y, const float* z, const float* radii, std::size_t stride, wIndex count, const Frustum& frustum, wIndex* outIndices) noexcept { return CullSpheresRange(x, y, z, radii, stride, 0, count, frustum, outIndices, 0); }
+        wIndex CullDistanceScalar(const float* x, const float* y, const float* z, std::size_t stride, wIndex count, const std::array<float, 3>& center, float maxDistance, wIndex* outIndices) noexcept { return CullDistanceRange(x, y, z, stride, 0, count, center, maxDistance, outIndices, 0); }
+
+#if defined(TUNGSTEN_CORE_SIMD_X86)
+        // SSE4.1, 4 lanes. There is no gather, strided lanes are loaded one by one.
+        W_SIMD_TARGET("sse4.1") inline __m128 Load4(const float* p, std::size_t stride) noexcept
+        {
+            return stride == 1 ? _mm_loadu_ps(p) : _mm_setr_ps(p[0], p[stride], p[2 * stride], p[3 * stride]);
+        }
+
+        W_SIMD_TARGET("sse4.1") void MultiplyAddSSE41(float* values, const float* deltas, float scale, wIndex count) noexcept
+        {
+            const __m128 scaleLanes = _mm_set1_ps(scale);
+            wIndex i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                _mm_storeu_ps(values + i, _mm_add_ps(_mm_loadu_ps(values + i), _mm_mul_ps(_mm_loadu_ps(deltas + i), scaleLanes)));
+            }
+            MultiplyAddRange(values, deltas, scale, i, count);
+        }
+
+        W_SIMD_TARGET("sse4.1") void UpdateAabbsSSE41(const float* centers, const float* halfExtents, float* mins, float* maxs, wIndex count) noexcept
+        {
+            wIndex i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128 center = _mm_loadu_ps(centers + i);
+                const __m128 halfExtent = _mm_loadu_ps(halfExtents + i);
+                _mm_storeu_ps(mins + i, _mm_sub_ps(center, halfExtent));
+                _mm_storeu_ps(maxs + i, _mm_add_ps(center, halfExtent));
+            }
+            UpdateAabbsRange(centers, halfExtents, mins, maxs, i, count);
+        }
+
+        W_SIMD_TARGET("sse4.1") wIndex CullSpheresSSE41(const float* x, const float* y, const float* z, const float* radii, std::size_t stride, wIndex count, const Frustum& frustum, wIndex* outIndices) noexcept
+        {
+            __m128 planes[6][4];
+            for (wIndex planeIndex = 0; planeIndex < 6; ++planeIndex)
+            {
+                for (wIndex component = 0; component < 4; ++component)
+                {
+                    planes[planeIndex][component] = _mm_set1_ps(frustum.planes[planeIndex][component]);
+                }
+            }
+            wIndex outCount = 0;
+            wIndex i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const std::size_t offset = i * stride;
+                const __m128 px = Load4(x + offset, stride);
+                const __m128 py = Load4(y + offset, stride);
+                const __m128 pz = Load4(z + offset, stride);
+                const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), Load4(radii + offset, stride));
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (const auto& plane : planes)
+                {
+                    const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, plane[0]), _mm_mul_ps(py, plane[1])), _mm_add_ps(_mm_mul_ps(pz, plane[2]), plane[3]));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+                }
+                outCount = WriteIndices(static_cast<uint32_t>(_mm_movemask_ps(inside)), i, outIndices, outCount);
+            }
+            return CullSpheresRange(x, y, z, radii, stride, i, count, frustum, outIndices, outCount);
+        }
+
+        W_SIMD_TARGET("sse4.1") wIndex CullDistanceSSE41(const float* x, const float* y, const float* z, std::size_t stride, wIndex count, const std::array<float, 3>& center, float maxDistance, wIndex* outIndices) noexcept
+        {
+            const __m128 cx = _mm_set1_ps(center[0]);
+            const __m128 cy = _mm_set1_ps(center[1]);
+            const __m128 cz = _mm_set1_ps(center[2]);
+            const __m128 maxDistanceSquared = _mm_set1_ps(maxDistance * maxDistance);
+            wIndex outCount = 0;
+            wIndex i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const std::size_t offset = i * stride;
+                const __m128 dx = _mm_sub_ps(Load4(x + offset, stride), cx);
+                const __m128 dy = _mm_sub_ps(Load4(y + offset, stride), cy);
+                const __m128 dz = _mm_sub_ps(Load4(z + offset, stride), cz);
+                const __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                outCount = WriteIndices(static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(distanceSquared, maxDistanceSquared))), i, outIndices, outCount);
+            }
+            return CullDistanceRange(x, y, z, stride, i, count, center, maxDistance, outIndices, outCount);
+        }
+
+        // AVX2 with FMA, 8 lanes
+        W_SIMD_TARGET("avx2,fma") inline __m256 Load8(const float* p, std::size_t stride, __m256i offsets) noexcept
+        {
+            return stride == 1 ? _mm256_loadu_ps(p) : _mm256_i32gather_ps(p, offsets, sizeof(float));
+        }
+
+        W_SIMD_TARGET("avx2,fma") void MultiplyAddAVX2(float* values, const float* deltas, float scale, wIndex count) noexcept
+        {
+            const __m256 scaleLanes = _mm256_set1_ps(scale);
+            wIndex i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                _mm256_storeu_ps(values + i, _mm256_fmadd_ps(_mm256_loadu_ps(deltas + i), scaleLanes, _mm256_loadu_ps(values + i)));
+            }
+            MultiplyAddRange(values, deltas, scale, i, count);
+        }
+
+        W_SIMD_TARGET("avx2,fma") void UpdateAabbsAVX2(const float* centers, const float* halfExtents, float* mins, float* maxs, wIndex count) noexcept
+        {
+            wIndex i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256 center = _mm256_loadu_ps(centers + i);
+                const __m256 halfExtent = _mm256_loadu_ps(halfExtents + i);
+                _mm256_storeu_ps(mins + i, _mm256_sub_ps(center, halfExtent));
+                _mm256_storeu_ps(maxs + i, _mm256_add_ps(center, halfExtent));
+            }
+            UpdateAabbsRange(centers, halfExtents, mins, maxs, i, count);
+        }
+
+        W_SIMD_TARGET("avx2,fma") wIndex CullSpheresAVX2(const float* x, const float* y, const float* z, const float* radii, std::size_t stride, wIndex count, const Frustum& frustum, wIndex* outIndices) noexcept
+        {
+            __m256 planes[6][4];
+            for (wIndex planeIndex = 0; planeIndex < 6; ++planeIndex)
+            {
+                for (wIndex component = 0; component < 4; ++component)
+                {
+                    planes[planeIndex][component] = _mm256_set1_ps(frustum.planes[planeIndex][component]);
+                }
+            }
+            const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(stride)));
+            wIndex outCount = 0;
+            wIndex i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const std::size_t offset = i * stride;
+                const __m256 px = Load8(x + offset, stride, offsets);
+                const __m256 py = Load8(y + offset, stride, offsets);
+                const __m256 pz = Load8(z + offset, stride, offsets);
+                const __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), Load8(radii + offset, stride, offsets));
+                __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (const auto& plane : planes)
+                {
+                    const __m256 distance = _mm256_fmadd_ps(px, plane[0], _mm256_fmadd_ps(py, plane[1], _mm256_fmadd_ps(pz, plane[2], plane[3])));
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+                }
+                outCount = WriteIndices(static_cast<uint32_t>(_mm256_movemask_ps(inside)), i, outIndices, outCount);
+            }
+            return CullSpheresRange(x, y, z, radii, stride, i, count, frustum, outIndices, outCount);
+        }
+
+        W_SIMD_TARGET("avx2,fma") wIndex CullDistanceAVX2(const float* x, const float* y, const float* z, std::size_t stride, wIndex count, const std::array<float, 3>& center, float maxDistance, wIndex* outIndices) noexcept
+        {
+            const __m256 cx = _mm256_set1_ps(center[0]);
+            const __m256 cy = _mm256_set1_ps(center[1]);
+            const __m256 cz = _mm256_set1_ps(center[2]);
+            const __m256 maxDistanceSquared = _mm256_set1_ps(maxDistance * maxDistance);
+            const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(stride)));
+            wIndex outCount = 0;
+            wIndex i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const std::size_t offset = i * stride;
+                const __m256 dx = _mm256_sub_ps(Load8(x + offset, stride, offsets), cx);
+                const __m256 dy = _mm256_sub_ps(Load8(y + offset, stride, offsets), cy);
+                const __m256 dz = _mm256_sub_ps(Load8(z + offset, stride, offsets), cz);
+                const __m256 distanceSquared = _mm256_fmadd_ps(dx, dx, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dz, dz)));
+                outCount = WriteIndices(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(distanceSquared, maxDistanceSquared, _CMP_LE_OQ))), i, outIndices, outCount);
+            }
+            return CullDistanceRange(x, y, z, stride, i, count, center, maxDistance, outIndices, outCount);
+        }
+
+        // AVX-512F, 16 lanes. The tails use masked loads and stores instead of the scalar kernels.
+        W_SIMD_TARGET("avx512f") inline __m512 Load16(const float* p, std::size_t stride, __m512i offsets) noexcept
+        {
+            return stride == 1 ? _mm512_loadu_ps(p) : _mm512_mask_i32gather_ps(_mm512_setzero_ps(), static_cast<__mmask16>(0xFFFF), offsets, p, sizeof(float));
+        }
+
+        W_SIMD_TARGET("avx512f") inline __mmask16 GetTailMask(wIndex remaining) noexcept
+        {
+            return remaining >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << remaining) - 1);
+        }
+
+        W_SIMD_TARGET("avx512f") void MultiplyAddAVX512(float* values, const float* deltas, float scale, wIndex count) noexcept
+        {
+            const __m512 scaleLanes = _mm512_set1_ps(scale);
+            for (wIndex i = 0; i < count; i += 16)
+            {
+                const __mmask16 mask = GetTailMask(count - i);
+                _mm512_mask_storeu_ps(values + i, mask, _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, deltas + i), scaleLanes, _mm512_maskz_loadu_ps(mask, values + i)));
+            }
+        }
+
+        W_SIMD_TARGET("avx512f") void UpdateAabbsAVX512(const float* centers, const float* halfExtents, float* mins, float* maxs, wIndex count) noexcept
+        {
+            for (wIndex i = 0; i < count; i += 16)
+            {
+                const __mmask16 mask = GetTailMask(count - i);
+                const __m512 center = _mm512_maskz_loadu_ps(mask, centers + i);
+                const __m512 halfExtent = _mm512_maskz_loadu_ps(mask, halfExtents + i);
+                _mm512_mask_storeu_ps(mins + i, mask, _mm512_sub_ps(center, halfExtent));
+                _mm512_mask_storeu_ps(maxs + i, mask, _mm512_add_ps(center, halfExtent));
+            }
+        }
+
+        W_SIMD_TARGET("avx512f") wIndex CullSpheresAVX512(const float* x, const float* y, const float* z, const float* radii, std::size_t stride, wIndex count, const Frustum& frustum, wIndex* outIndices) noexcept
+        {
+            __m512 planes[6][4];
+            for (wIndex planeIndex = 0; planeIndex < 6; ++planeIndex)
+            {
+                for (wIndex component = 0; component < 4; ++component)
+                {
+                    planes[planeIndex][component] = _mm512_set1_ps(frustum.planes[planeIndex][component]);
+                }
+            }
+            const __m512i offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(static_cast<int>(stride)));
+            wIndex outCount = 0;
+            wIndex i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                const std::size_t offset = i * stride;
+                const __m512 px = Load16(x + offset, stride, offsets);
+                const __m512 py = Load16(y + offset, stride, offsets);
+                const __m512 pz = Load16(z + offset, stride, offsets);
+                const __m512 negativeRadius = _mm512_sub_ps(_mm512_setzero_ps(), Load16(radii + offset, stride, offsets));
+                __mmask16 inside = 0xFFFF;
+                for (const auto& plane : planes)
+                {
+                    const __m512 distance = _mm512_fmadd_ps(px, plane[0], _mm512_fmadd_ps(py, plane[1], _mm512_fmadd_ps(pz, plane[2], plane[3])));
+                    inside = _mm512_mask_cmp_ps_mask(inside, distance, negativeRadius, _CMP_GE_OQ);
+                }
+                outCount = WriteIndices(inside, i, outIndices, outCount);
+            }
+            // Gathers have no cheap masked tail for every stride, the scalar kernel finishes
+            return CullSpheresRange(x, y, z, radii, stride, i, count, frustum, outIndices, outCount);
+        }
+
+        W_SIMD_TARGET("avx512f") wIndex CullDistanceAVX512(const float* x, const float* y, const float* z, std::size_t stride, wIndex count, const std::array<float, 3>& center, float maxDistance, wIndex* outIndices) noexcept
+        {
+            const __m512 cx = _mm512_set1_ps(center[0]);
+            const __m512 cy = _mm512_set1_ps(center[1]);
+            const __m512 cz = _mm512_set1_ps(center[2]);
+            const __m512 maxDistanceSquared = _mm512_set1_ps(maxDistance * maxDistance);
+            const __m512i offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(static_cast<int>(stride)));
+            wIndex outCount = 0;
+            wIndex i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                const std::size_t offset = i * stride;
+                const __m512 dx = _mm512_sub_ps(Load16(x + offset, stride, offsets), cx);
+                const __m512 dy = _mm512_sub_ps(Load16(y + offset, stride, offsets), cy);
+                const __m512 dz = _mm512_sub_ps(Load16(z + offset, stride, offsets), cz);
+                const __m512 distanceSquared = _mm512_fmadd_ps(dx, dx, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dz, dz)));
+                outCount = WriteIndices(_mm512_cmp_ps_mask(distanceSquared, maxDistanceSquared, _CMP_LE_OQ), i, outIndices, outCount);
+            }
+            return CullDistanceRange(x, y, z, stride, i, count, center, maxDistance, outIndices, outCount);
+        }
+#endif
+    }
+
+    SimdLevel SimdKernels::GetSupportedLevel() noexcept
+    {
+        static const SimdLevel s_supportedLevel = DetectLevel();
+        return s_supportedLevel;
+    }
+
+    SimdLevel SimdKernels::GetLevel() noexcept
+    {
+        return std::min(GetSupportedLevel(), s_maxLevel.load(std::memory_order_relaxed));
+    }
+
+    void SimdKernels::SetMaxLevel(SimdLevel level) noexcept
+    {
+        s_maxLevel.store(level, std::memory_order_relaxed);
+    }
+
+    const SimdKernels::Kernels& SimdKernels::GetKernels() noexcept
+    {
+        return GetKernels(GetLevel());
+    }
+
+    const SimdKernels::Kernels& SimdKernels::GetKernels(SimdLevel level) noexcept
+    {
+        static constexpr Kernels s_kernels[] =
+        {
+            { &MultiplyAddScalar, &UpdateAabbsScalar, &CullSpheresScalar, &CullDistanceScalar },
+#if defined(TUNGSTEN_CORE_SIMD_X86)
+            { &MultiplyAddSSE41, &UpdateAabbsSSE41, &CullSpheresSSE41, &CullDistanceSSE41 },
+            { &MultiplyAddAVX2, &UpdateAabbsAVX2, &CullSpheresAVX2, &CullDistanceAVX2 },
+            { &MultiplyAddAVX512, &UpdateAabbsAVX512, &CullSpheresAVX512, &CullDistanceAVX512 }
+#endif
+        };
+        return s_kernels[std::min<std::size_t>(static_cast<std::size_t>(level), std::size(s_kernels) - 1)];
+    }
+
+    void SimdKernels::MultiplyAdd(float* values, const float* deltas, float scale, wIndex count) noexcept
+    {
+        GetKernels().multiplyAdd(values, deltas, scale, count);
+    }
+
+    void SimdKernels::UpdateAabbs(const float* centers, const float* halfExtents, float* mins, float* maxs, wIndex count) noexcept
+    {
+        GetKernels().updateAabbs(centers, halfExtents, mins, maxs, count);
+    }
+
+    wIndex SimdKernels::CullSpheres(const float* x, const float* y, const float* z, const float* radii, std::size_t stride, wIndex count, const Frustum& frustum, wIndex* outIndices) noexcept
+    {
+        return GetKernels().cullSpheres(x, y, z, radii, stride, count, frustum, outIndices);
+    }
+
+    wIndex SimdKernels::CullDistance(const float* x, const float* y, const float* z, std::size_t stride, wIndex count, const std::array<float, 3>& center, float maxDistance, wIndex* outIndices) noexcept
+    {
+        return GetKernels().cullDistance(x, y, z, stride, count, center, maxDistance, outIndices);
+    }
+}
\ No newline at end of file
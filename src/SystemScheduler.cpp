@@ -0,0 +1,148 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/SystemScheduler.hpp"
+
+namespace wCore
+{
+    SystemAccess& SystemAccess::Read(ComponentTypeIndex componentTypeIndex)
+    {
+        W_ASSERT(componentTypeIndex != InvalidComponentType, "ComponentTypeIndex {} is Invalid", InvalidComponentType);
+        m_reads.emplace_back(componentTypeIndex);
+        return *this;
+    }
+
+    SystemAccess& SystemAccess::Write(ComponentTypeIndex componentTypeIndex)
+    {
+        W_ASSERT(componentTypeIndex != InvalidComponentType, "ComponentTypeIndex {} is Invalid", InvalidComponentType);
+        m_writes.emplace_back(componentTypeIndex);
+        return *this;
+    }
+
+    SystemAccess& SystemAccess::After(SystemIndex systemIndex)
+    {
+        W_ASSERT(systemIndex != InvalidSystem, "SystemIndex {} is Invalid", InvalidSystem);
+        m_after.emplace_back(systemIndex);
+        return *this;
+    }
+
+    ComponentTypeIndex SystemAccess::FindConflict(const SystemAccess& other) const noexcept
+    {
+        for (const ComponentTypeIndex write : m_writes)
+        {
+            if (std::find(other.m_writes.begin(), other.m_writes.end(), write) != other.m_writes.end() ||
+                std::find(other.m_reads.begin(), other.m_reads.end(), write) != other.m_reads.end())
+            {
+                return write;
+            }
+        }
+        for (const ComponentTypeIndex write : other.m_writes)
+        {
+            if (std::find(m_reads.begin(), m_reads.end(), write) != m_reads.end())
+            {
+                return write;
+            }
+        }
+        return InvalidComponentType;
+    }
+
+    SystemScheduler::SystemScheduler(Application& app, JobSystem& jobSystem) noexcept
+        : m_app(app), m_jobSystem(jobSystem), m_systems(), m_conflicts(), m_roots(),
+        m_pendingDependencies(), m_pendingDependencyCapacity(0)
+    {
+    }
+
+    SystemIndex SystemScheduler::AddSystem(std::string_view name, const SystemAccess& access, SystemFn fn)
+    {
+        const SystemIndex systemIndex = m_systems.size() + 1;
+        SystemNode& node = m_systems.emplace_back(SystemNode{ std::string(name), Profiler::InternName(name), access, std::move(fn), {}, {}, 0 });
+
+        for (SystemIndex otherIndex = SystemIndexStart; otherIndex < systemIndex; ++otherIndex)
+        {
+            SystemNode& other = m_systems[otherIndex - 1];
+            const ComponentTypeIndex conflict = access.FindConflict(other.access);
+            const bool explicitOrder = std::find(access.GetAfter().begin(), access.GetAfter().end(), otherIndex) != access.GetAfter().end();
+            if (conflict != InvalidComponentType)
+            {
+                m_conflicts.push_back({ otherIndex, systemIndex, conflict });
+                W_DEBUG_LOG_INFO("System: {} runs after System: {}, both access ComponentTypeIndex: {}", node.name, other.name, conflict);
+            }
+            if (conflict != InvalidComponentType || explicitOrder)
+            {
+                node.dependencies.emplace_back(otherIndex);
+                other.dependents.emplace_back(systemIndex);
+                node.level = std::max(node.level, other.level + 1);
+            }
+        }
+        W_ASSERT(std::all_of(access.GetAfter().begin(), access.GetAfter().end(), [systemIndex](SystemIndex after) { return after < systemIndex; }), "System: {} can only run after systems that were added before it", node.name);
+
+        if (node.dependencies.empty())
+        {
+            m_roots.emplace_back(systemIndex);
+        }
+        return systemIndex;
+    }
+
+    void SystemScheduler::RunFrame()
+    {
+        const wIndex systemCount = m_systems.size();
+        if (!systemCount)
+        {
+            return;
+        }
+
+        if (m_pendingDependencyCapacity < systemCount)
+        {
+            m_pendingDependencies = std::make_unique<std::atomic<wIndex>[]>(systemCount);
+            m_pendingDependencyCapacity = systemCount;
+        }
+        for (SystemIndex systemIndex = SystemIndexStart; systemIndex <= systemCount; ++systemIndex)
+        {
+            m_pendingDependencies[systemIndex - 1].store(m_systems[systemIndex - 1].dependencies.size(), std::memory_order_relaxed);
+        }
+
+        JobCounter counter;
+        for (const SystemIndex root : m_roots)
+        {
+            Spawn(counter, root);
+        }
+        m_jobSystem.Wait(counter);
+    }
+
+    std::string SystemScheduler::GetFrameGraphDot() const
+    {
+        std::string dot = "digraph FrameGraph {\n";
+        for (SystemIndex systemIndex = SystemIndexStart; systemIndex <= m_systems.size(); ++systemIndex)
+        {
+            const SystemNode& node = m_systems[systemIndex - 1];
+            dot += "    s" + std::to_string(systemIndex) + " [label=\"" + node.name + " (level " + std::to_string(node.level) + ")\"];\n";
+            for (const SystemIndex dependent : node.dependents)
+            {
+                dot += "    s" + std::to_string(systemIndex) + " -> s" + std::to_string(dependent) + ";\n";
+            }
+        }
+        dot += "}\n";
+        return dot;
+    }
+
+    void SystemScheduler::Spawn(JobCounter& counter, SystemIndex systemIndex)
+    {
+        m_jobSystem.Spawn(counter, [this, &counter, systemIndex] { Execute(counter, systemIndex); });
+    }
+
+    void SystemScheduler::Execute(JobCounter& counter, SystemIndex systemIndex)
+    {
+        const SystemNode& node = m_systems[systemIndex - 1];
+        {
+            W_PROFILE_ZONE(node.profileName);
+            node.fn(m_app);
+        }
+
+        // Dependents are spawned before this job finishes, so the counter can not reach zero early.
+        for (const SystemIndex dependent : node.dependents)
+        {
+            if (m_pendingDependencies[dependent - 1].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                Spawn(counter, dependent);
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "wCorePCH.hpp"
+#include "TungstenCore/TransformHierarchy.hpp"
+
+#include <algorithm>
+
+namespace wCore
+{
+    ComponentHandle<Transform> TransformHierarchy::Create(ComponentSystem& componentSystem, SceneHandle sceneHandle, ComponentHandle<Transform> parent)
+    {
+        // New components are appended, which makes them roots at the end of the order
+        const ComponentHandle<Transform> transform = componentSystem.CreateComponent<Transform>(sceneHandle);
+        if (parent.componentIndex != InvalidComponent)
+        {
+            SetParent(componentSystem, transform, parent);
+        }
+        return transform;
+    }
+
+    void TransformHierarchy::SetParent(ComponentSystem& componentSystem, ComponentHandle<Transform> child, ComponentHandle<Transform> parent) noexcept
+    {
+        W_ASSERT(componentSystem.ComponentExists(child), "Transform: {} does not exist", child.componentIndex);
+        W_ASSERT(parent.componentIndex == InvalidComponent || (componentSystem.ComponentExists(parent) && parent.sceneHandle.sceneIndex == child.sceneHandle.sceneIndex), "Parent Transform: {} does not exist in the scene of the child", parent.componentIndex);
+        const ComponentSystem::WriteScope writeScope(componentSystem);
+
+        ComponentSetup::CreateCtx& createCtx = componentSystem.m_createCtx;
+        const wIndex listIndex = ComponentSetup::StaticComponentID<Transform>::GetListIndex();
+        ComponentSetup::ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(child.sceneHandle.sceneIndex, listIndex);
+        Transform* const nodes = static_cast<Transform*>(headerHot.dense);
+        ComponentIndex* const slotToDense = headerHot.slotToDense;
+        ComponentIndex* const denseToSlot = headerHot.denseToSlot;
+
+        const wIndex begin = slotToDense[child.componentIndex - 1] - 1;
+        const wIndex count = nodes[begin].subtreeSize;
+        wIndex target = createCtx.GetComponentListCold(child.sceneHandle.sceneIndex, listIndex).denseCount;
+        if (parent.componentIndex != InvalidComponent)
+        {
+            const wIndex parentPosition = slotToDense[parent.componentIndex - 1] - 1;
+            W_ASSERT(parentPosition < begin || parentPosition >= begin + count, "Transform: {} can not be parented into its own subtree", child.componentIndex);
+            target = parentPosition + nodes[parentPosition].subtreeSize;
+        }
+
+        AddToAncestors(nodes, slotToDense, nodes[begin].parent, -static_cast<std::ptrdiff_t>(count));
+
+        // Rotate the subtree to the end of the new parent's range, everything in between shifts by count
+        wIndex rangeBegin = begin;
+        wIndex rangeEnd = begin + 1;
+        wIndex newBegin = begin;
+        if (target < begin)
+        {
+            rangeBegin = target;
+            rangeEnd = begin + count;
+            newBegin = target;
+            std::rotate(nodes + target, nodes + begin, nodes + begin + count);
+            std::rotate(denseToSlot + target, denseToSlot + begin, denseToSlot + begin + count);
+        }
+        else if (target > begin + count)
+        {
+            rangeEnd = target;
+            newBegin = target - count;
+            std::rotate(nodes + begin, nodes + begin + count, nodes + target);
+            std::rotate(denseToSlot + begin, denseToSlot + begin + count, denseToSlot + target);
+        }
+        for (wIndex position = rangeBegin; position < rangeEnd; ++position)
+        {
+            slotToDense[denseToSlot[position] - 1] = position + 1;
+        }
+
+        nodes[newBegin].parent = parent.componentIndex;
+        AddToAncestors(nodes, slotToDense, parent.componentIndex, count);
+        UpdateParentOffsets(nodes, slotToDense, rangeBegin, rangeEnd);
+        ComponentSetup::StampBlocks(headerHot, rangeBegin, rangeEnd, createCtx.changeVersion);
+    }
+
+    ComponentHandle<Transform> TransformHierarchy::GetParent(ComponentSystem& componentSystem, ComponentHandle<Transform> child) noexcept
+    {
+        W_ASSERT(componentSystem.ComponentExists(child), "Transform: {} does not exist", child.componentIndex);
+        const ComponentSetup::CreateCtx& createCtx = componentSystem.m_createCtx;
+        const ComponentSetup::ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(child.sceneHandle.sceneIndex, ComponentSetup::StaticComponentID<Transform>::GetListIndex());
+        const ComponentIndex parent = static_cast<const Transform*>(headerHot.dense)[headerHot.slotToDense[child.componentIndex - 1] - 1].parent;
+        if (parent == InvalidComponent)
+        {
+            return ComponentHandle<Transform>();
+        }
+        return ComponentHandle<Transform>(child.sceneHandle, parent, headerHot.generations[parent - 1]);
+    }
+
+    void TransformHierarchy::Destroy(ComponentSystem& componentSystem, ComponentHandle<Transform> transform)
+    {
+        const ComponentSystem::WriteScope writeScope(componentSystem);
+        // Detaching moves the subtree to the end of the list, where removing from the back never swaps
+        SetParent(componentSystem, transform, ComponentHandle<Transform>());
+
+        const ComponentSetup::CreateCtx& createCtx = componentSystem.m_createCtx;
+        const wIndex listIndex = ComponentSetup::StaticComponentID<Transform>::GetListIndex();
+        const ComponentSetup::ComponentListHeaderHot& headerHot = createCtx.GetComponentListHot(transform.sceneHandle.sceneIndex, listIndex);
+        const wIndex denseCount = createCtx.GetComponentListCold(transform.sceneHandle.sceneIndex, listIndex).denseCount;
+        const wIndex count = denseCount - (headerHot.slotToDense[transform.componentIndex - 1] - 1);
+
+        std::vector<ComponentIndex> slots(count);
+        for (wIndex i = 0; i < count; ++i)
+        {
+            slots[i] = headerHot.denseToSlot[denseCount - 1 - i];
+        }
+        componentSystem.DestroyComponents(componentSystem.GetComponentSetup().GetComponentTypeIndex<Transform>(), transform.sceneHandle, slots.data(), count);
+    }
+
+    void TransformHierarchy::Propagate(ComponentSystem& componentSystem, SceneHandle sceneHandle, JobSystem& jobSystem)
+    {
+        W_PROFILE_ZONE("TransformHierarchy::Propagate");
+        const std::span<Transform> nodes = componentSystem.GetDenseSpan<Transform>(sceneHandle);
+
+        // Cut the list into batches of whole root subtrees, so every parent is written before its children in the same job
+        std::vector<wIndex> batchEnds;
+        wIndex batchBegin = 0;
+        for (wIndex root = 0; root < nodes.size(); root += nodes[root].subtreeSize)
+        {
+            const wIndex rootEnd = root + nodes[root].subtreeSize;
+            if (rootEnd - batchBegin >= PropagateBatchSize || rootEnd == nodes.size())
+            {
+                batchEnds.push_back(rootEnd);
+                batchBegin = rootEnd;
+            }
+        }
+
+        jobSystem.ParallelFor(0, batchEnds.size(), 1, [nodes, &batchEnds](wIndex begin, wIndex end)
+        {
+            for (wIndex batch = begin; batch < end; ++batch)
+            {
+                PropagateRange(nodes.data(), batch ? batchEnds[batch - 1] : 0, batchEnds[batch]);
+            }
+        });
+    }
+
+    void TransformHierarchy::Propagate(ComponentSystem& componentSystem, SceneHandle sceneHandle)
+    {
+        const std::span<Transform> nodes = componentSystem.GetDenseSpan<Transform>(sceneHandle);
+        PropagateRange(nodes.data(), 0, nodes.size());
+    }
+
+    void TransformHierarchy::PropagateRange(Transform* nodes, wIndex begin, wIndex end) noexcept
+    {
+        for (wIndex position = begin; position < end; ++position)
+        {
+            Transform& node = nodes[position];
+            W_ASSERT(node.parentOffset <= position - begin, "Transform order is broken, destroy Transforms through TransformHierarchy::Destroy");
+            node.world = node.parentOffset ? nodes[position - node.parentOffset].world * node.local : node.local;
+        }
+    }
+
+    void TransformHierarchy::UpdateParentOffsets(Transform* nodes, const ComponentIndex* slotToDense, wIndex begin, wIndex end) noexcept
+    {
+        for (wIndex position = begin; position < end; ++position)
+        {
+            Transform& node = nodes[position];
+            node.parentOffset = node.parent == InvalidComponent ? 0 : position - (slotToDense[node.parent - 1] - 1);
+        }
+        // Only the ancestors on the boundary reach past end, their children there did not move but they did
+        for (wIndex position = begin; position < end; ++position)
+        {
+            const wIndex subtreeEnd = position + nodes[position].subtreeSize;
+            if (subtreeEnd <= end)
+            {
+                continue;
+            }
+            for (wIndex childPosition = position + 1; childPosition < subtreeEnd; childPosition += nodes[childPosition].subtreeSize)
+            {
+                if (childPosition >= end)
+                {
+                    nodes[childPosition].parentOffset = childPosition - position;
+                }
+            }
+        }
+    }
+
+    void TransformHierarchy::AddToAncestors(Transform* nodes, const ComponentIndex* slotToDense, ComponentIndex parent, std::ptrdiff_t delta) noexcept
+    {
+        while (parent != InvalidComponent)
+        {
+            Transform& ancestor = nodes[slotToDense[parent - 1] - 1];
+            ancestor.subtreeSize += delta;
+            parent = ancestor.parent;
+        }
+    }
+}
\ No newline at end of file
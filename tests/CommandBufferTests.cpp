@@ -0,0 +1,136 @@
+#include <atomic>
+#include <vector>
+#include "TungstenCore/Application.hpp"
+#include "TestSupport.hpp"
+
+using namespace wCore;
+
+namespace
+{
+    struct Position
+    {
+        float x = 0.0f;
+    };
+
+    void TestPlaybackOrder(Application& app)
+    {
+        ComponentSystem& componentSystem = app.GetComponentSystem();
+        const SceneHandle scene = componentSystem.CreateScene();
+        CommandBuffer commandBuffer(componentSystem.GetComponentSetup());
+
+        const DeferredComponentIndex first = commandBuffer.CreateComponent<Position>(scene);
+        const DeferredSceneIndex deferredScene = commandBuffer.CreateScene("Deferred");
+        const DeferredComponentIndex inDeferredScene = commandBuffer.CreateComponent<Position>(deferredScene);
+        const DeferredComponentIndex second = commandBuffer.CreateComponent<Position>(scene);
+        W_TEST_CHECK(commandBuffer.GetCommandCount() == 4);
+        W_TEST_CHECK(componentSystem.GetComponentCount<Position>(scene.sceneIndex) == 0);
+
+        commandBuffer.Playback(componentSystem);
+        const SceneHandle createdScene = commandBuffer.GetCreatedScene(deferredScene);
+        W_TEST_CHECK(componentSystem.SceneExists(createdScene));
+        W_TEST_CHECK(componentSystem.ComponentExists(commandBuffer.GetCreatedComponent<Position>(first)));
+        W_TEST_CHECK(componentSystem.ComponentExists(commandBuffer.GetCreatedComponent<Position>(second)));
+        W_TEST_CHECK(commandBuffer.GetCreatedComponent<Position>(inDeferredScene).sceneHandle.sceneIndex == createdScene.sceneIndex);
+        W_TEST_CHECK(componentSystem.GetComponentCount<Position>(scene.sceneIndex) == 2);
+        W_TEST_CHECK(componentSystem.GetComponentCount<Position>(createdScene.sceneIndex) == 1);
+        // Commands run in recording order, so the first create got the first slot
+        W_TEST_CHECK(commandBuffer.GetCreatedComponent(first).componentIndex < commandBuffer.GetCreatedComponent(second).componentIndex);
+
+        componentSystem.DestroyScene(createdScene);
+        componentSystem.DestroyScene(scene);
+    }
+
+    void TestStaleDestroys(Application& app)
+    {
+        ComponentSystem& componentSystem = app.GetComponentSystem();
+        const SceneHandle scene = componentSystem.CreateScene();
+        const SceneHandle doomedScene = componentSystem.CreateScene();
+        const ComponentHandle<Position> destroyedTwice = componentSystem.CreateComponent<Position>(scene);
+        const ComponentHandle<Position> reused = componentSystem.CreateComponent<Position>(scene);
+
+        // The slot is reused before playback, the old handle must not destroy the new component
+        componentSystem.DestroyComponent(reused);
+        const ComponentHandle<Position> replacement = componentSystem.CreateComponent<Position>(scene);
+        W_TEST_CHECK(replacement.componentIndex == reused.componentIndex);
+
+        CommandBuffer first(componentSystem.GetComponentSetup());
+        CommandBuffer second(componentSystem.GetComponentSetup());
+        first.DestroyComponent(destroyedTwice);
+        second.DestroyComponent(destroyedTwice);
+        first.DestroyComponent(reused);
+        first.DestroyScene(doomedScene);
+        second.DestroyScene(doomedScene);
+        first.Playback(componentSystem);
+        second.Playback(componentSystem);
+
+        W_TEST_CHECK(!componentSystem.ComponentExists(destroyedTwice));
+        W_TEST_CHECK(componentSystem.ComponentExists(replacement));
+        W_TEST_CHECK(!componentSystem.SceneExists(doomedScene));
+        W_TEST_CHECK(componentSystem.GetComponentCount<Position>(scene.sceneIndex) == 1);
+
+        componentSystem.DestroyScene(scene);
+    }
+
+    void TestCreateInDestroyedScene(Application& app)
+    {
+        ComponentSystem& componentSystem = app.GetComponentSystem();
+        const SceneHandle destroyedScene = componentSystem.CreateScene();
+        const SceneHandle scene = componentSystem.CreateScene();
+        CommandBuffer commandBuffer(componentSystem.GetComponentSetup());
+
+        commandBuffer.DestroyScene(destroyedScene);
+        const DeferredComponentIndex skipped = commandBuffer.CreateComponent<Position>(destroyedScene);
+        const DeferredComponentIndex created = commandBuffer.CreateComponent<Position>(scene);
+        commandBuffer.Playback(componentSystem);
+
+        W_TEST_CHECK(commandBuffer.GetCreatedComponent(skipped).componentIndex == InvalidComponent);
+        W_TEST_CHECK(componentSystem.ComponentExists(commandBuffer.GetCreatedComponent<Position>(created)));
+
+        componentSystem.DestroyScene(scene);
+    }
+
+    void TestRecordingFromJobs(Application& app)
+    {
+        constexpr int JobCount = 16;
+        constexpr int CreatesPerJob = 64;
+        ComponentSystem& componentSystem = app.GetComponentSystem();
+        const SceneHandle scene = componentSystem.CreateScene();
+
+        JobCounter counter;
+        for (int job = 0; job < JobCount; ++job)
+        {
+            app.GetJobSystem().Spawn(counter, [&app, scene]
+            {
+                CommandBuffer& commandBuffer = app.GetCommandBuffer();
+                for (int i = 0; i < CreatesPerJob; ++i)
+                {
+                    commandBuffer.CreateComponent<Position>(scene);
+                }
+            });
+        }
+        app.GetJobSystem().Wait(counter);
+        app.GetCommandBuffers().Playback(componentSystem);
+
+        W_TEST_CHECK(componentSystem.GetComponentCount<Position>(scene.sceneIndex) == JobCount * CreatesPerJob);
+        for (wIndex bufferIndex = 0; bufferIndex < app.GetCommandBuffers().GetBufferCount(); ++bufferIndex)
+        {
+            W_TEST_CHECK(app.GetCommandBuffers().GetBuffer(bufferIndex).Empty());
+        }
+
+        componentSystem.DestroyScene(scene);
+    }
+}
+
+int main()
+{
+    Application::Config config;
+    config.jobSystem.workerCount = 2;
+    Application app(config);
+    app.GetComponentSystem().GetComponentSetup().Add<Position>("Position");
+
+    TestPlaybackOrder(app);
+    TestStaleDestroys(app);
+    TestCreateInDestroyedScene(app);
+    TestRecordingFromJobs(app);
+    return Test::Finish("CommandBufferTests");
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include <vector>
+#include "TungstenCore/Application.hpp"
+#include "TestSupport.hpp"
+
+using namespace wCore;
+
+namespace
+{
+    struct Health
+    {
+        int value = 0;
+    };
+
+    struct Velocity
+    {
+        float x = 0.0f;
+    };
+
+    struct Tag
+    {
+        int id = 0;
+    };
+
+    [[nodiscard]] bool IsSameEntity(EntityHandle a, EntityHandle b) noexcept
+    {
+        return a.sceneHandle.sceneIndex == b.sceneHandle.sceneIndex && a.entityIndex == b.entityIndex && a.generation == b.generation;
+    }
+
+    void TestLinkAndUnlink(Application& app)
+    {
+        ComponentSystem& componentSystem = app.GetComponentSystem();
+        const SceneHandle scene = componentSystem.CreateScene();
+        const EntityHandle entity = componentSystem.CreateEntity(scene);
+        W_TEST_CHECK(componentSystem.EntityExists(entity));
+        W_TEST_CHECK(!componentSystem.HasComponent<Health>(entity));
+        W_TEST_CHECK(componentSystem.GetComponent<Health>(entity) == nullptr);
+        W_TEST_CHECK(componentSystem.GetComponentHandle<Health>(entity).componentIndex == InvalidComponent);
+
+        const ComponentHandle<Health> health = componentSystem.AddComponent<Health>(entity);
+        const ComponentHandle<Tag> tag = componentSystem.AddComponent<Tag>(entity);
+        componentSystem.GetComponent(health)->value = 42;
+        componentSystem.GetComponent(tag)->id = 7;
+        W_TEST_CHECK(componentSystem.HasComponent<Health>(entity) && componentSystem.HasComponent<Tag>(entity));
+        W_TEST_CHECK(!componentSystem.HasComponent<Velocity>(entity));
+        W_TEST_CHECK(componentSystem.GetComponent<Health>(entity)->value == 42);
+        W_TEST_CHECK(componentSystem.GetComponent<Tag>(entity)->id == 7);
+        W_TEST_CHECK(componentSystem.GetComponentHandle<Health>(entity).componentIndex == health.componentIndex);
+        W_TEST_CHECK(componentSystem.GetComponentHandle<Tag>(entity).generation == tag.generation);
+        W_TEST_CHECK(IsSameEntity(componentSystem.GetEntity(health), entity));
+        W_TEST_CHECK(IsSameEntity(componentSystem.GetEntity(tag), entity));
+
+        // Removing through the entity unlinks and destroys the component
+        componentSystem.RemoveComponent<Health>(entity);
+        W_TEST_CHECK(!componentSystem.HasComponent<Health>(entity));
+        W_TEST_CHECK(!componentSystem.ComponentExists(health));
+        W_TEST_CHECK(componentSystem.HasComponent<Tag>(entity));
+
+        // Destroying a linked component directly unlinks it as well
+        componentSystem.DestroyComponent(tag);
+        W_TEST_CHECK(!componentSystem.HasComponent<Tag>(entity));
+        W_TEST_CHECK(componentSystem.GetComponent<Tag>(entity) == nullptr);
+        W_TEST_CHECK(componentSystem.EntityExists(entity));
+
+        // A component created without an entity belongs to none
+        const ComponentHandle<Health> loose = componentSystem.CreateComponent<Health>(scene);
+        W_TEST_CHECK(componentSystem.GetEntity(loose).entityIndex == InvalidEntity);
+
+        // Relinking after an unlink gets a fresh component
+        const ComponentHandle<Health> relinked = componentSystem.AddComponent<Health>(entity);
+        W_TEST_CHECK(componentSystem.GetComponent<Health>(entity)->value == 0);
+        W_TEST_CHECK(IsSameEntity(componentSystem.GetEntity(relinked), entity));
+        W_TEST_CHECK(componentSystem.GetComponentCount<Health>(scene.sceneIndex) == 2);
+
+        componentSystem.DestroyScene(scene);
+    }
+
+    void TestDestroyEntity(Application& app)
+    {
+        ComponentSystem& componentSystem = app.GetComponentSystem();
+        const SceneHandle scene = componentSystem.CreateScene();
+        const EntityHandle entity = componentSystem.CreateEntity(scene);
+        const EntityHandle survivor = componentSystem.CreateEntity(scene);
+        const ComponentHandle<Health> health = componentSystem.AddComponent<Health>(entity);
+        const ComponentHandle<Tag> tag = componentSystem.AddComponent<Tag>(entity);
+        const ComponentHandle<Health> survivorHealth = componentSystem.AddComponent<Health>(survivor);
+
+        componentSystem.DestroyEntity(entity);
+        W_TEST_CHECK(!componentSystem.EntityExists(entity));
+        W_TEST_CHECK(!componentSystem.ComponentExists(health) && !componentSystem.ComponentExists(tag));
+        W_TEST_CHECK(componentSystem.ComponentExists(survivorHealth));
+        W_TEST_CHECK(IsSameEntity(componentSystem.GetEntity(survivorHealth), survivor));
+
+        // The freed slot is reused with a new generation, the old handle stays stale
+        const EntityHandle reused = componentSystem.CreateEntity(scene);
+        W_TEST_CHECK(reused.entityIndex == entity.entityIndex);
+        W_TEST_CHECK(componentSystem.EntityExists(reused) && !componentSystem.EntityExists(entity));
+        W_TEST_CHECK(!componentSystem.HasComponent<Health>(reused) && !componentSystem.HasComponent<Tag>(reused));
+
+        componentSystem.DestroyScene(scene);
+    }
+
+    void TestEachEntity(Application& app)
+    {
+        ComponentSystem& componentSystem = app.GetComponentSystem();
+        const SceneHandle scene = componentSystem.CreateScene();
+        std::vector<EntityHandle> moving;
+        for (int i = 0; i < 32; ++i)
+        {
+            const EntityHandle entity = componentSystem.CreateEntity(scene);
+            componentSystem.AddComponent<Health>(entity);
+            if (i % 3 == 0)
+            {
+                componentSystem.GetComponent(componentSystem.AddComponent<Velocity>(entity))->x = static_cast<float>(i);
+                componentSystem.GetComponent(componentSystem.AddComponent<Tag>(entity))->id = i;
+                moving.push_back(entity);
+            }
+        }
+        // Unowned components of the driving type are skipped
+        componentSystem.GetComponent(componentSystem.CreateComponent<Velocity>(scene))->x = -1.0f;
+
+        wIndex visited = 0;
+        componentSystem.EachEntity<Velocity, Health, const Tag>(scene, [&](EntityHandle entity, Velocity& velocity, Health& health, const Tag& tag)
+        {
+            W_TEST_CHECK(componentSystem.HasComponent<Velocity>(entity));
+            W_TEST_CHECK(velocity.x == static_cast<float>(tag.id));
+            health.value = tag.id;
+            ++visited;
+        });
+        W_TEST_CHECK(visited == moving.size());
+        for (const EntityHandle& entity : moving)
+        {
+            W_TEST_CHECK(componentSystem.GetComponent<Health>(entity)->value == componentSystem.GetComponent<Tag>(entity)->id);
+        }
+
+        componentSystem.DestroyScene(scene);
+    }
+}
+
+int main()
+{
+    Application::Config config;
+    config.jobSystem.workerCount = 2;
+    Application app(config);
+    ComponentSetup& componentSetup = app.GetComponentSystem().GetComponentSetup();
+    componentSetup.Add<Health>("Health");
+    componentSetup.Add<Velocity>("Velocity");
+    componentSetup.Add<Tag, 16>("Tag");
+
+    TestLinkAndUnlink(app);
+    TestDestroyEntity(app);
+    TestEachEntity(app);
+    return Test::Finish("EntityTableTests");
+}
\ No newline at end of file
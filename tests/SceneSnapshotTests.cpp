@@ -0,0 +1,178 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "TungstenCore/Application.hpp"
+#include "TungstenCore/SceneSnapshot.hpp"
+#include "TestSupport.hpp"
+
+using namespace wCore;
+
+namespace
+{
+    struct Body
+    {
+        int id;
+        double mass;
+    };
+
+    struct Marker
+    {
+        int id;
+    };
+
+    struct Name
+    {
+        std::string text;
+    };
+
+    constexpr wIndex BodyCount = 300;
+    constexpr wIndex MarkerCount = 40;
+
+    [[nodiscard]] std::vector<std::byte> ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::vector<std::byte> data(bytes.size());
+        std::memcpy(data.data(), bytes.data(), bytes.size());
+        return data;
+    }
+
+    // The file starts with a uint32_t magic followed by a uint32_t version.
+    inline void WriteUint32(std::vector<std::byte>& data, std::size_t offset, uint32_t value)
+    {
+        std::memcpy(data.data() + offset, &value, sizeof(value));
+    }
+
+    void TestRoundTrip(ComponentSystem& componentSystem, const std::filesystem::path& path)
+    {
+        const SceneHandle scene = componentSystem.CreateScene();
+        std::vector<ComponentHandle<Body>> bodies(BodyCount);
+        std::vector<ComponentHandle<Marker>> markers(MarkerCount);
+        componentSystem.CreateComponents<Body>(scene, BodyCount, bodies.data());
+        componentSystem.CreateComponents<Marker>(scene, MarkerCount, markers.data());
+        for (wIndex i = 0; i < BodyCount; ++i)
+        {
+            *componentSystem.GetComponent(bodies[i]) = Body{ static_cast<int>(i), i * 0.5 };
+        }
+        for (wIndex i = 0; i < MarkerCount; ++i)
+        {
+            componentSystem.GetComponent(markers[i])->id = static_cast<int>(i);
+        }
+        for (wIndex i = 0; i < BodyCount; i += 3)
+        {
+            componentSystem.DestroyComponent(bodies[i]);
+        }
+        for (wIndex i = 0; i < MarkerCount; i += 4)
+        {
+            componentSystem.DestroyComponent(markers[i]);
+        }
+
+        W_TEST_CHECK(SceneSnapshot::Save(componentSystem, scene, path) == SnapshotResult::Success);
+        const auto [result, loaded] = SceneSnapshot::Load(componentSystem, path, "Loaded");
+        W_TEST_CHECK(result == SnapshotResult::Success);
+        W_TEST_CHECK(componentSystem.SceneExists(loaded));
+        W_TEST_CHECK(componentSystem.GetComponentCount<Body>(loaded.sceneIndex) == componentSystem.GetComponentCount<Body>(scene.sceneIndex));
+        W_TEST_CHECK(componentSystem.GetComponentCount<Marker>(loaded.sceneIndex) == componentSystem.GetComponentCount<Marker>(scene.sceneIndex));
+
+        // Slots and generations are kept, so the saved handles resolve in the loaded scene
+        for (wIndex i = 0; i < BodyCount; ++i)
+        {
+            const ComponentHandle<Body> handle(loaded, bodies[i].componentIndex, bodies[i].generation);
+            const bool alive = i % 3 != 0;
+            W_TEST_CHECK(componentSystem.ComponentExists(handle) == alive);
+            if (alive)
+            {
+                W_TEST_CHECK(componentSystem.GetComponent(handle)->id == static_cast<int>(i));
+                W_TEST_CHECK(componentSystem.GetComponent(handle)->mass == i * 0.5);
+            }
+        }
+        for (wIndex i = 0; i < MarkerCount; ++i)
+        {
+            const ComponentHandle<Marker> handle(loaded, markers[i].componentIndex, markers[i].generation);
+            const bool alive = i % 4 != 0;
+            W_TEST_CHECK(componentSystem.ComponentExists(handle) == alive);
+            if (alive)
+            {
+                W_TEST_CHECK(componentSystem.GetComponent(handle)->id == static_cast<int>(i));
+            }
+        }
+
+        // The rebuilt free lists hand out the free slots before appending
+        const ComponentHandle<Body> reused = componentSystem.CreateComponent<Body>(loaded);
+        W_TEST_CHECK(reused.componentIndex <= BodyCount);
+
+        componentSystem.DestroyScene(loaded);
+        componentSystem.DestroyScene(scene);
+    }
+
+    void TestRejectsCorruptInput(ComponentSystem& componentSystem, const std::filesystem::path& path)
+    {
+        const SceneHandle scene = componentSystem.CreateScene();
+        for (wIndex i = 0; i < 10; ++i)
+        {
+            componentSystem.GetComponent(componentSystem.CreateComponent<Body>(scene))->id = static_cast<int>(i);
+        }
+        W_TEST_CHECK(SceneSnapshot::Save(componentSystem, scene, path) == SnapshotResult::Success);
+        const std::vector<std::byte> data = ReadFile(path);
+        W_TEST_CHECK(SceneSnapshot::Validate(componentSystem, data) == SnapshotResult::Success);
+
+        const wIndex sceneCount = componentSystem.GetSceneCount();
+        const auto expectRejected = [&componentSystem, sceneCount](std::span<const std::byte> corrupt, SnapshotResult expected)
+        {
+            W_TEST_CHECK(SceneSnapshot::Validate(componentSystem, corrupt) == expected);
+            const auto [result, loaded] = SceneSnapshot::Load(componentSystem, corrupt);
+            W_TEST_CHECK(result == expected);
+            W_TEST_CHECK(loaded.sceneIndex == InvalidScene);
+            W_TEST_CHECK(componentSystem.GetSceneCount() == sceneCount);
+        };
+
+        expectRejected(std::span<const std::byte>(), SnapshotResult::InvalidFormat);
+        expectRejected(std::span<const std::byte>(data).first(data.size() - 1), SnapshotResult::InvalidFormat);
+        expectRejected(std::span<const std::byte>(data).first(data.size() / 2), SnapshotResult::InvalidFormat);
+
+        std::vector<std::byte> badMagic = data;
+        badMagic[0] ^= std::byte{ 0xFF };
+        expectRejected(badMagic, SnapshotResult::InvalidFormat);
+
+        std::vector<std::byte> badVersion = data;
+        WriteUint32(badVersion, sizeof(uint32_t), SceneSnapshot::Version + 1);
+        expectRejected(badVersion, SnapshotResult::VersionMismatch);
+
+        const auto [missingFile, missingScene] = SceneSnapshot::Load(componentSystem, path.string() + ".missing");
+        W_TEST_CHECK(missingFile == SnapshotResult::FileError);
+        W_TEST_CHECK(componentSystem.GetSceneCount() == sceneCount);
+
+        componentSystem.DestroyScene(scene);
+    }
+
+    void TestRejectsUnsupportedTypes(ComponentSystem& componentSystem, const std::filesystem::path& path)
+    {
+        const SceneHandle scene = componentSystem.CreateScene();
+        componentSystem.GetComponent(componentSystem.CreateComponent<Name>(scene))->text = "not trivially copyable";
+        W_TEST_CHECK(SceneSnapshot::Save(componentSystem, scene, path) == SnapshotResult::UnsupportedType);
+        componentSystem.DestroyScene(scene);
+    }
+}
+
+int main()
+{
+    Application::Config config;
+    config.jobSystem.workerCount = 0;
+    Application app(config);
+    ComponentSystem& componentSystem = app.GetComponentSystem();
+    ComponentSetup& componentSetup = componentSystem.GetComponentSetup();
+    componentSetup.Add<Body>("Body");
+    componentSetup.Add<Marker, 16>("Marker");
+    componentSetup.Add<Name>("Name");
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "TungstenCoreSceneSnapshotTests.snapshot";
+    TestRoundTrip(componentSystem, path);
+    TestRejectsCorruptInput(componentSystem, path);
+    TestRejectsUnsupportedTypes(componentSystem, path);
+    std::filesystem::remove(path);
+    return Test::Finish("SceneSnapshotTests");
+}
\ No newline at end of file
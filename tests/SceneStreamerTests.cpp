@@ -0,0 +1,138 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "TungstenCore/Application.hpp"
+#include "TestSupport.hpp"
+
+using namespace wCore;
+
+namespace
+{
+    struct Tile
+    {
+        int value = 0;
+    };
+
+    constexpr wIndex TilesPerScene = 100;
+
+    // Bounded so a regression fails the check instead of hanging the test
+    template<typename Fn>
+    [[nodiscard]] bool WaitUntil(Fn&& condition)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!condition())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    [[nodiscard]] SceneBuildFn BuildTiles(int firstValue, std::vector<ComponentHandle<Tile>>& handles, const std::atomic<bool>* release = nullptr)
+    {
+        return [firstValue, &handles, release](StagedScene& scene, SceneStream&)
+        {
+            if (release)
+            {
+                while (!release->load(std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                }
+            }
+            handles.resize(TilesPerScene);
+            scene.CreateComponents<Tile>(TilesPerScene, handles.data());
+            for (wIndex i = 0; i < TilesPerScene; ++i)
+            {
+                scene.GetComponent(handles[i])->value = firstValue + static_cast<int>(i);
+            }
+        };
+    }
+
+    void CheckTiles(ComponentSystem& componentSystem, const SceneStream& stream, const std::vector<ComponentHandle<Tile>>& handles, int firstValue)
+    {
+        W_TEST_CHECK(componentSystem.GetComponentCount<Tile>(stream.GetScene().sceneIndex) == TilesPerScene);
+        for (wIndex i = 0; i < handles.size(); ++i)
+        {
+            const Tile* tile = componentSystem.GetComponent(stream.Resolve(handles[i]));
+            W_TEST_CHECK(tile && tile->value == firstValue + static_cast<int>(i));
+        }
+    }
+
+    void TestCommitsInRequestOrder(Application& app)
+    {
+        ComponentSystem& componentSystem = app.GetComponentSystem();
+        SceneStreamer& streamer = app.GetSceneStreamer();
+        std::atomic<bool> releaseFirst = false;
+        std::vector<ComponentHandle<Tile>> firstHandles;
+        std::vector<ComponentHandle<Tile>> secondHandles;
+        std::vector<ComponentHandle<Tile>> thirdHandles;
+
+        const std::shared_ptr<SceneStream> first = streamer.Stream(BuildTiles(0, firstHandles, &releaseFirst));
+        const std::shared_ptr<SceneStream> second = streamer.Stream(BuildTiles(1000, secondHandles));
+        const std::shared_ptr<SceneStream> third = streamer.Stream(BuildTiles(2000, thirdHandles));
+
+        // Later builds finish first but wait behind the oldest one
+        W_TEST_CHECK(WaitUntil([&] { return second->GetState() == SceneStream::State::Ready && third->GetState() == SceneStream::State::Ready; }));
+        for (int update = 0; update < 10; ++update)
+        {
+            streamer.Update(std::chrono::microseconds(0));
+        }
+        W_TEST_CHECK(second->GetState() == SceneStream::State::Ready);
+        W_TEST_CHECK(third->GetState() == SceneStream::State::Ready);
+        W_TEST_CHECK(streamer.GetPendingCount() == 3);
+
+        releaseFirst.store(true, std::memory_order_release);
+        W_TEST_CHECK(WaitUntil([&] { streamer.Update(std::chrono::microseconds(0)); return !streamer.GetPendingCount(); }));
+        W_TEST_CHECK(first->GetState() == SceneStream::State::Committed);
+        W_TEST_CHECK(second->GetState() == SceneStream::State::Committed);
+        W_TEST_CHECK(third->GetState() == SceneStream::State::Committed);
+        if (third->GetState() != SceneStream::State::Committed)
+        {
+            return;
+        }
+
+        // No slot was free, so the commit order shows in the scene indices
+        W_TEST_CHECK(first->GetScene().sceneIndex < second->GetScene().sceneIndex);
+        W_TEST_CHECK(second->GetScene().sceneIndex < third->GetScene().sceneIndex);
+        CheckTiles(componentSystem, *first, firstHandles, 0);
+        CheckTiles(componentSystem, *second, secondHandles, 1000);
+        CheckTiles(componentSystem, *third, thirdHandles, 2000);
+
+        componentSystem.DestroyScene(first->GetScene());
+        componentSystem.DestroyScene(second->GetScene());
+        componentSystem.DestroyScene(third->GetScene());
+    }
+
+    void TestCancel(Application& app)
+    {
+        ComponentSystem& componentSystem = app.GetComponentSystem();
+        SceneStreamer& streamer = app.GetSceneStreamer();
+        const wIndex sceneCount = componentSystem.GetSceneCount();
+        std::atomic<bool> release = false;
+        std::vector<ComponentHandle<Tile>> handles;
+
+        const std::shared_ptr<SceneStream> stream = streamer.Stream(BuildTiles(0, handles, &release));
+        stream->Cancel();
+        release.store(true, std::memory_order_release);
+        W_TEST_CHECK(WaitUntil([&] { streamer.Update(std::chrono::microseconds(0)); return !streamer.GetPendingCount(); }));
+        W_TEST_CHECK(stream->GetState() == SceneStream::State::Cancelled);
+        W_TEST_CHECK(componentSystem.GetSceneCount() == sceneCount);
+    }
+}
+
+int main()
+{
+    Application::Config config;
+    config.jobSystem.workerCount = 2;
+    Application app(config);
+    app.GetComponentSystem().GetComponentSetup().Add<Tile>("Tile");
+
+    TestCommitsInRequestOrder(app);
+    TestCancel(app);
+    return Test::Finish("SceneStreamerTests");
+}
\ No newline at end of file
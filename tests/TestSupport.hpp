@@ -0,0 +1,35 @@
+#ifndef TUNGSTEN_CORE_TEST_SUPPORT_HPP
+#define TUNGSTEN_CORE_TEST_SUPPORT_HPP
+
+#include <cstdio>
+
+// Every test executable registers its component types once, because type ids are process wide, and runs its cases in
+// order. A failed check is printed and fails the executable, the remaining checks still run.
+namespace wCore::Test
+{
+    inline int s_failedCheckCount = 0;
+
+    inline void Check(bool condition, const char* expression, const char* file, int line) noexcept
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+            ++s_failedCheckCount;
+        }
+    }
+
+    [[nodiscard]] inline int Finish(const char* name) noexcept
+    {
+        if (s_failedCheckCount)
+        {
+            std::fprintf(stderr, "%s: %d checks failed\n", name, s_failedCheckCount);
+            return 1;
+        }
+        std::printf("%s: passed\n", name);
+        return 0;
+    }
+}
+
+#define W_TEST_CHECK(condition) ::wCore::Test::Check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+#endif
\ No newline at end of file
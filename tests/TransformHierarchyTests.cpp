@@ -0,0 +1,164 @@
+#include <random>
+#include <vector>
+#include "TungstenCore/Application.hpp"
+#include "TungstenCore/TransformHierarchy.hpp"
+#include "TestSupport.hpp"
+
+using namespace wCore;
+
+namespace
+{
+    [[nodiscard]] bool IsSameHandle(ComponentHandle<Transform> a, ComponentHandle<Transform> b) noexcept
+    {
+        return a.sceneHandle.sceneIndex == b.sceneHandle.sceneIndex && a.componentIndex == b.componentIndex && a.generation == b.generation;
+    }
+
+    [[nodiscard]] TransformMatrix ExpectedWorld(ComponentSystem& componentSystem, ComponentHandle<Transform> transform)
+    {
+        TransformMatrix world = componentSystem.GetComponent(transform)->local;
+        for (ComponentHandle<Transform> ancestor = TransformHierarchy::GetParent(componentSystem, transform); ancestor.componentIndex != InvalidComponent; ancestor = TransformHierarchy::GetParent(componentSystem, ancestor))
+        {
+            world = componentSystem.GetComponent(ancestor)->local * world;
+        }
+        return world;
+    }
+
+    // Every subtree is one dense range starting at its root, so a node's subtree size covers exactly its descendants.
+    void CheckDepthFirstOrder(ComponentSystem& componentSystem, SceneHandle scene, const std::vector<ComponentHandle<Transform>>& transforms)
+    {
+        for (const ComponentHandle<Transform>& transform : transforms)
+        {
+            wIndex descendantCount = 0;
+            for (const ComponentHandle<Transform>& other : transforms)
+            {
+                for (ComponentHandle<Transform> ancestor = TransformHierarchy::GetParent(componentSystem, other); ancestor.componentIndex != InvalidComponent; ancestor = TransformHierarchy::GetParent(componentSystem, ancestor))
+                {
+                    if (IsSameHandle(ancestor, transform))
+                    {
+                        ++descendantCount;
+                        break;
+                    }
+                }
+            }
+            W_TEST_CHECK(componentSystem.GetComponent(transform)->GetSubtreeSize() == descendantCount + 1);
+        }
+        W_TEST_CHECK(componentSystem.GetComponentCount<Transform>(scene.sceneIndex) == transforms.size());
+    }
+
+    void TestReparenting(Application& app)
+    {
+        ComponentSystem& componentSystem = app.GetComponentSystem();
+        const SceneHandle scene = componentSystem.CreateScene();
+        const ComponentHandle<Transform> root = TransformHierarchy::Create(componentSystem, scene);
+        const ComponentHandle<Transform> left = TransformHierarchy::Create(componentSystem, scene, root);
+        const ComponentHandle<Transform> right = TransformHierarchy::Create(componentSystem, scene, root);
+        const ComponentHandle<Transform> leaf = TransformHierarchy::Create(componentSystem, scene, left);
+        componentSystem.GetComponent(root)->local = TransformMatrix::Translation(1.0f, 0.0f, 0.0f);
+        componentSystem.GetComponent(left)->local = TransformMatrix::Translation(0.0f, 2.0f, 0.0f);
+        componentSystem.GetComponent(right)->local = TransformMatrix::Translation(0.0f, 0.0f, 3.0f);
+        componentSystem.GetComponent(leaf)->local = TransformMatrix::Translation(4.0f, 0.0f, 0.0f);
+
+        TransformHierarchy::Propagate(componentSystem, scene);
+        W_TEST_CHECK(componentSystem.GetComponent(leaf)->world == TransformMatrix::Translation(5.0f, 2.0f, 0.0f));
+        W_TEST_CHECK(componentSystem.GetComponent(root)->GetSubtreeSize() == 4);
+        CheckDepthFirstOrder(componentSystem, scene, { root, left, right, leaf });
+
+        // Moving the leaf under the right node keeps every handle valid
+        TransformHierarchy::SetParent(componentSystem, leaf, right);
+        W_TEST_CHECK(IsSameHandle(TransformHierarchy::GetParent(componentSystem, leaf), right));
+        W_TEST_CHECK(componentSystem.ComponentExists(root) && componentSystem.ComponentExists(left) && componentSystem.ComponentExists(right) && componentSystem.ComponentExists(leaf));
+        W_TEST_CHECK(componentSystem.GetComponent(left)->GetSubtreeSize() == 1);
+        W_TEST_CHECK(componentSystem.GetComponent(right)->GetSubtreeSize() == 2);
+        TransformHierarchy::Propagate(componentSystem, scene);
+        W_TEST_CHECK(componentSystem.GetComponent(leaf)->world == TransformMatrix::Translation(5.0f, 0.0f, 3.0f));
+        CheckDepthFirstOrder(componentSystem, scene, { root, left, right, leaf });
+
+        // Detaching makes a root, its world is its local
+        TransformHierarchy::SetParent(componentSystem, right, ComponentHandle<Transform>());
+        W_TEST_CHECK(componentSystem.GetComponent(right)->IsRoot());
+        W_TEST_CHECK(componentSystem.GetComponent(root)->GetSubtreeSize() == 2);
+        TransformHierarchy::Propagate(componentSystem, scene);
+        W_TEST_CHECK(componentSystem.GetComponent(right)->world == TransformMatrix::Translation(0.0f, 0.0f, 3.0f));
+        W_TEST_CHECK(componentSystem.GetComponent(leaf)->world == TransformMatrix::Translation(4.0f, 0.0f, 3.0f));
+        CheckDepthFirstOrder(componentSystem, scene, { root, left, right, leaf });
+
+        // Destroying a node takes its subtree with it
+        TransformHierarchy::Destroy(componentSystem, right);
+        W_TEST_CHECK(!componentSystem.ComponentExists(right) && !componentSystem.ComponentExists(leaf));
+        W_TEST_CHECK(componentSystem.ComponentExists(root) && componentSystem.ComponentExists(left));
+        CheckDepthFirstOrder(componentSystem, scene, { root, left });
+
+        componentSystem.DestroyScene(scene);
+    }
+
+    void TestRandomEdits(Application& app)
+    {
+        ComponentSystem& componentSystem = app.GetComponentSystem();
+        const SceneHandle scene = componentSystem.CreateScene();
+        std::mt19937 random(7);
+        std::vector<ComponentHandle<Transform>> transforms;
+
+        for (int step = 0; step < 2000; ++step)
+        {
+            const uint32_t operation = random() % 10;
+            if (operation < 5 || transforms.size() < 3)
+            {
+                ComponentHandle<Transform> parent;
+                if (!transforms.empty() && random() % 3)
+                {
+                    parent = transforms[random() % transforms.size()];
+                }
+                const ComponentHandle<Transform> transform = TransformHierarchy::Create(componentSystem, scene, parent);
+                componentSystem.GetComponent(transform)->local = TransformMatrix::Translation(static_cast<float>(random() % 10), 1.0f, static_cast<float>(step % 3));
+                transforms.push_back(transform);
+            }
+            else if (operation < 8)
+            {
+                const ComponentHandle<Transform> child = transforms[random() % transforms.size()];
+                ComponentHandle<Transform> parent;
+                if (random() % 4)
+                {
+                    parent = transforms[random() % transforms.size()];
+                }
+                // A node can not move below itself
+                bool createsCycle = false;
+                for (ComponentHandle<Transform> ancestor = parent; ancestor.componentIndex != InvalidComponent; ancestor = TransformHierarchy::GetParent(componentSystem, ancestor))
+                {
+                    createsCycle |= IsSameHandle(ancestor, child);
+                }
+                if (!createsCycle)
+                {
+                    TransformHierarchy::SetParent(componentSystem, child, parent);
+                }
+            }
+            else if (operation < 9)
+            {
+                TransformHierarchy::Destroy(componentSystem, transforms[random() % transforms.size()]);
+                std::erase_if(transforms, [&componentSystem](ComponentHandle<Transform> transform) { return !componentSystem.ComponentExists(transform); });
+            }
+            else
+            {
+                TransformHierarchy::Propagate(componentSystem, scene, app.GetJobSystem());
+                for (const ComponentHandle<Transform>& transform : transforms)
+                {
+                    W_TEST_CHECK(componentSystem.GetComponent(transform)->world == ExpectedWorld(componentSystem, transform));
+                }
+            }
+        }
+        CheckDepthFirstOrder(componentSystem, scene, transforms);
+
+        componentSystem.DestroyScene(scene);
+    }
+}
+
+int main()
+{
+    Application::Config config;
+    config.jobSystem.workerCount = 2;
+    Application app(config);
+    app.GetComponentSystem().GetComponentSetup().Add<Transform>("Transform");
+
+    TestReparenting(app);
+    TestRandomEdits(app);
+    return Test::Finish("TransformHierarchyTests");
+}
\ No newline at end of file